@@ -17,25 +17,39 @@ Status Account::fromJSON(const std::string& json) {
   PARSE_BOOL(account_blocked, "account_blocked")
   PARSE_STRING(account_number, "account_number")
   PARSE_STRING(buying_power, "buying_power")
+  PARSE_DECIMAL(buying_power_decimal, "buying_power")
   PARSE_STRING(cash, "cash")
+  PARSE_DECIMAL(cash_decimal, "cash")
   PARSE_STRING(created_at, "created_at")
   PARSE_STRING(currency, "currency")
   PARSE_INT(daytrade_count, "daytrade_count")
   PARSE_STRING(daytrading_buying_power, "daytrading_buying_power")
+  PARSE_DECIMAL(daytrading_buying_power_decimal, "daytrading_buying_power")
   PARSE_STRING(equity, "equity")
+  PARSE_DECIMAL(equity_decimal, "equity")
   PARSE_STRING(id, "id")
   PARSE_STRING(initial_margin, "initial_margin")
+  PARSE_DECIMAL(initial_margin_decimal, "initial_margin")
   PARSE_STRING(last_equity, "last_equity")
+  PARSE_DECIMAL(last_equity_decimal, "last_equity")
   PARSE_STRING(last_maintenance_margin, "last_maintenance_margin")
+  PARSE_DECIMAL(last_maintenance_margin_decimal, "last_maintenance_margin")
   PARSE_STRING(long_market_value, "long_market_value")
+  PARSE_DECIMAL(long_market_value_decimal, "long_market_value")
   PARSE_STRING(maintenance_margin, "maintenance_margin")
+  PARSE_DECIMAL(maintenance_margin_decimal, "maintenance_margin")
   PARSE_STRING(multiplier, "multiplier")
+  PARSE_DECIMAL(multiplier_decimal, "multiplier")
   PARSE_BOOL(pattern_day_trader, "pattern_day_trader")
   PARSE_STRING(portfolio_value, "portfolio_value")
+  PARSE_DECIMAL(portfolio_value_decimal, "portfolio_value")
   PARSE_STRING(regt_buying_power, "regt_buying_power")
+  PARSE_DECIMAL(regt_buying_power_decimal, "regt_buying_power")
   PARSE_STRING(short_market_value, "short_market_value")
+  PARSE_DECIMAL(short_market_value_decimal, "short_market_value")
   PARSE_BOOL(shorting_enabled, "shorting_enabled")
   PARSE_STRING(sma, "sma")
+  PARSE_DECIMAL(sma_decimal, "sma")
   PARSE_STRING(status, "status")
   PARSE_BOOL(trade_suspended_by_user, "trade_suspended_by_user")
   PARSE_BOOL(trading_blocked, "trading_blocked")
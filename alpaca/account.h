@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "alpaca/decimal.h"
 #include "alpaca/status.h"
 
 namespace alpaca {
@@ -47,6 +48,25 @@ class Account {
   bool trade_suspended_by_user;
   bool trading_blocked;
   bool transfers_blocked;
+
+  /**
+   * @brief The numeric fields above, parsed once by fromJSON(). Zero if absent
+   * or null.
+   */
+  Decimal buying_power_decimal;
+  Decimal cash_decimal;
+  Decimal daytrading_buying_power_decimal;
+  Decimal equity_decimal;
+  Decimal initial_margin_decimal;
+  Decimal last_equity_decimal;
+  Decimal last_maintenance_margin_decimal;
+  Decimal long_market_value_decimal;
+  Decimal maintenance_margin_decimal;
+  Decimal multiplier_decimal;
+  Decimal portfolio_value_decimal;
+  Decimal regt_buying_power_decimal;
+  Decimal short_market_value_decimal;
+  Decimal sma_decimal;
 };
 
 /**
@@ -74,6 +74,10 @@ TEST_F(AccountTest, testAccountConfigurationFromJSON) {
   alpaca::Account account;
   EXPECT_OK(account.fromJSON(kAccountsJSON));
   EXPECT_EQ(account.account_number, "010203ABCD");
+  EXPECT_EQ(account.cash, "-23140.2");
+  EXPECT_EQ(account.cash_decimal.units(), -23140200000000);
+  EXPECT_EQ(account.buying_power_decimal.toString(), "262113.632");
+  EXPECT_EQ(account.multiplier_decimal.toInt(), 4);
 }
 
 TEST_F(AccountTest, testAccountConfigurationsFromJSON) {
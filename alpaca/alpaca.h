@@ -6,8 +6,10 @@
 #include "alpaca/client.h"
 #include "alpaca/clock.h"
 #include "alpaca/config.h"
+#include "alpaca/decimal.h"
 #include "alpaca/order.h"
 #include "alpaca/portfolio.h"
 #include "alpaca/position.h"
 #include "alpaca/status.h"
+#include "alpaca/trade_update.h"
 #include "alpaca/watchlist.h"
@@ -2,6 +2,8 @@
 
 #include <utility>
 
+#include "alpaca/connection_pool.h"
+#include "alpaca/executor.h"
 #include "glog/logging.h"
 #include "cpp-httplib/httplib.h"
 #include "rapidjson/document.h"
@@ -13,6 +15,27 @@ namespace alpaca {
 
 const char* kJSONContentType = "application/json";
 
+/// The number of asynchronous calls that can be in flight at once.
+const int kExecutorThreads = 2;
+
+/// Runs `call` on `executor` and hands its result to `callback` and to the
+/// returned future.
+template <typename T>
+std::future<std::pair<Status, T>> runAsync(Executor& executor,
+                                           std::function<std::pair<Status, T>()> call,
+                                           const Client::Callback<T>& callback) {
+  auto promise = std::make_shared<std::promise<std::pair<Status, T>>>();
+  auto future = promise->get_future();
+  executor.post([promise, call = std::move(call), callback]() {
+    auto result = call();
+    if (callback) {
+      callback(result);
+    }
+    promise->set_value(std::move(result));
+  });
+  return future;
+}
+
 httplib::Headers headers(const Environment& environment) {
   return {
       {"APCA-API-KEY-ID", environment.getAPIKeyID()},
@@ -27,13 +50,28 @@ Client::Client(Environment& environment) {
     }
   }
   environment_ = environment;
+  api_ = std::make_shared<ConnectionPool>(environment_.getAPIBaseURL());
+  data_ = std::make_shared<ConnectionPool>(environment_.getAPIDataURL());
+  executor_ = std::make_shared<Executor>(kExecutorThreads);
+}
+
+Client Client::detached() const {
+  auto client = *this;
+  client.executor_.reset();
+  return client;
+}
+
+Status Client::warmUp(const int connections) const {
+  if (auto status = api_->warmUp(connections); !status.ok()) {
+    return status;
+  }
+  return data_->warmUp();
 }
 
 std::pair<Status, Account> Client::getAccount() const {
   Account account;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Get("/v2/account", headers(environment_));
+  auto resp = api_->Get("/v2/account", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/account returned an empty response"), account);
   }
@@ -48,11 +86,16 @@ std::pair<Status, Account> Client::getAccount() const {
   return std::make_pair(account.fromJSON(resp->body), account);
 }
 
+std::future<std::pair<Status, Account>> Client::getAccountAsync(const Callback<Account>& callback) const {
+  auto client = detached();
+  return runAsync<Account>(
+      *executor_, [client]() { return client.getAccount(); }, callback);
+}
+
 std::pair<Status, AccountConfigurations> Client::getAccountConfigurations() const {
   AccountConfigurations account_configurations;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Get("/v2/account/configurations", headers(environment_));
+  auto resp = api_->Get("/v2/account/configurations", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/account/configurations returned an empty response"),
                           account_configurations);
@@ -94,8 +137,7 @@ std::pair<Status, AccountConfigurations> Client::updateAccountConfigurations(con
   writer.EndObject();
   auto body = s.GetString();
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Patch("/v2/account/configurations", headers(environment_), body, kJSONContentType);
+  auto resp = api_->Patch("/v2/account/configurations", headers(environment_), body, kJSONContentType);
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/account/configurations returned an empty response"),
                           account_configurations);
@@ -126,9 +168,8 @@ std::pair<Status, std::vector<std::variant<TradeActivity, NonTradeActivity>>> Cl
     url += "?activity_types=" + query_string;
   }
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -186,9 +227,8 @@ std::pair<Status, Order> Client::getOrder(const std::string& id, const bool nest
     url += "?nested=true";
   }
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -210,9 +250,8 @@ std::pair<Status, Order> Client::getOrderByClientOrderID(const std::string& clie
 
   auto url = "/v2/orders:by_client_order_id?client_order_id=" + client_order_id;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -229,6 +268,13 @@ std::pair<Status, Order> Client::getOrderByClientOrderID(const std::string& clie
   return std::make_pair(order.fromJSON(resp->body), order);
 }
 
+std::future<std::pair<Status, Order>> Client::getOrderByClientOrderIDAsync(const std::string& client_order_id,
+                                                                           const Callback<Order>& callback) const {
+  auto client = detached();
+  return runAsync<Order>(
+      *executor_, [client, client_order_id]() { return client.getOrderByClientOrderID(client_order_id); }, callback);
+}
+
 std::pair<Status, std::vector<Order>> Client::getOrders(const ActionStatus status,
                                                         const int limit,
                                                         const std::string& after,
@@ -252,10 +298,9 @@ std::pair<Status, std::vector<Order>> Client::getOrders(const ActionStatus statu
     params.insert({"nested", "true"});
   }
   auto query_string = httplib::detail::params_to_query_str(params);
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   auto url = "/v2/orders?" + query_string;
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -377,8 +422,7 @@ std::pair<Status, Order> Client::submitOrder(const std::string& symbol,
 
   DLOG(INFO) << "Sending request body to /v2/orders: " << body;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Post("/v2/orders", headers(environment_), body, kJSONContentType);
+  auto resp = api_->Post("/v2/orders", headers(environment_), body, kJSONContentType);
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/orders returned an empty response"), order);
   }
@@ -394,6 +438,32 @@ std::pair<Status, Order> Client::submitOrder(const std::string& symbol,
   return std::make_pair(order.fromJSON(resp->body), order);
 }
 
+std::future<std::pair<Status, Order>> Client::submitOrderAsync(const Callback<Order>& callback,
+                                                               const std::string& symbol,
+                                                               const int quantity,
+                                                               const OrderSide side,
+                                                               const OrderType type,
+                                                               const OrderTimeInForce tif,
+                                                               const std::string& limit_price,
+                                                               const std::string& stop_price,
+                                                               const bool extended_hours,
+                                                               const std::string& client_order_id,
+                                                               const OrderClass order_class,
+                                                               TakeProfitParams* take_profit_params,
+                                                               StopLossParams* stop_loss_params) const {
+  // The caller's parameters may be gone by the time the order is submitted.
+  auto take_profit = take_profit_params ? std::make_shared<TakeProfitParams>(*take_profit_params) : nullptr;
+  auto stop_loss = stop_loss_params ? std::make_shared<StopLossParams>(*stop_loss_params) : nullptr;
+  auto client = detached();
+  return runAsync<Order>(
+      *executor_,
+      [=]() {
+        return client.submitOrder(symbol, quantity, side, type, tif, limit_price, stop_price, extended_hours,
+                                  client_order_id, order_class, take_profit.get(), stop_loss.get());
+      },
+      callback);
+}
+
 std::pair<Status, Order> Client::replaceOrder(const std::string& id,
                                               const int quantity,
                                               const OrderTimeInForce tif,
@@ -434,8 +504,7 @@ std::pair<Status, Order> Client::replaceOrder(const std::string& id,
   auto url = "/v2/orders/" + id;
   DLOG(INFO) << "Sending request body to " << url << ": " << body;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Patch(url.c_str(), headers(environment_), body, kJSONContentType);
+  auto resp = api_->Patch(url, headers(environment_), body, kJSONContentType);
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -456,9 +525,8 @@ std::pair<Status, Order> Client::replaceOrder(const std::string& id,
 std::pair<Status, std::vector<Order>> Client::cancelOrders() const {
   std::vector<Order> orders;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: /v2/orders";
-  auto resp = client.Delete("/v2/orders", headers(environment_));
+  auto resp = api_->Delete("/v2/orders", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/orders returned an empty response"), orders);
   }
@@ -493,10 +561,9 @@ std::pair<Status, std::vector<Order>> Client::cancelOrders() const {
 std::pair<Status, Order> Client::cancelOrder(const std::string& id) const {
   Order order;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   auto url = "/v2/orders/" + id;
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Delete(url.c_str(), headers(environment_));
+  auto resp = api_->Delete(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -518,12 +585,18 @@ std::pair<Status, Order> Client::cancelOrder(const std::string& id) const {
   return std::make_pair(order.fromJSON(resp->body), order);
 }
 
+std::future<std::pair<Status, Order>> Client::cancelOrderAsync(const std::string& id,
+                                                               const Callback<Order>& callback) const {
+  auto client = detached();
+  return runAsync<Order>(
+      *executor_, [client, id]() { return client.cancelOrder(id); }, callback);
+}
+
 std::pair<Status, std::vector<Position>> Client::getPositions() const {
   std::vector<Position> positions;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: /v2/positions";
-  auto resp = client.Get("/v2/positions", headers(environment_));
+  auto resp = api_->Get("/v2/positions", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/positions returned an empty response"), positions);
   }
@@ -560,9 +633,8 @@ std::pair<Status, Position> Client::getPosition(const std::string& symbol) const
 
   auto url = "/v2/positions/" + symbol;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -582,9 +654,8 @@ std::pair<Status, Position> Client::getPosition(const std::string& symbol) const
 std::pair<Status, std::vector<Position>> Client::closePositions() const {
   std::vector<Position> positions;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: /v2/positions";
-  auto resp = client.Delete("/v2/orders", headers(environment_));
+  auto resp = api_->Delete("/v2/orders", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/positions returned an empty response"), positions);
   }
@@ -619,10 +690,9 @@ std::pair<Status, std::vector<Position>> Client::closePositions() const {
 std::pair<Status, Position> Client::closePosition(const std::string& symbol) const {
   Position position;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   auto url = "/v2/positions/" + symbol;
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Delete(url.c_str(), headers(environment_));
+  auto resp = api_->Delete(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -655,9 +725,8 @@ std::pair<Status, std::vector<Asset>> Client::getAssets(const ActionStatus asset
   auto query_string = httplib::detail::params_to_query_str(params);
   auto url = "/v2/assets?" + query_string;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -696,9 +765,8 @@ std::pair<Status, Asset> Client::getAsset(const std::string& symbol) const {
 
   auto url = "/v2/assets/" + symbol;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -718,8 +786,7 @@ std::pair<Status, Asset> Client::getAsset(const std::string& symbol) const {
 std::pair<Status, Clock> Client::getClock() const {
   Clock clock;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Get("/v2/clock", headers(environment_));
+  auto resp = api_->Get("/v2/clock", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/clock returned an empty response"), clock);
   }
@@ -738,9 +805,8 @@ std::pair<Status, std::vector<Date>> Client::getCalendar(const std::string& star
   std::vector<Date> dates;
 
   auto url = "/v2/calendar?start=" + start + "&end=" + end;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -777,9 +843,8 @@ std::pair<Status, std::vector<Date>> Client::getCalendar(const std::string& star
 std::pair<Status, std::vector<Watchlist>> Client::getWatchlists() const {
   std::vector<Watchlist> watchlists;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: /v2/watchlists";
-  auto resp = client.Get("/v2/watchlists", headers(environment_));
+  auto resp = api_->Get("/v2/watchlists", headers(environment_));
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/watchlists returned an empty response"), watchlists);
   }
@@ -815,9 +880,8 @@ std::pair<Status, Watchlist> Client::getWatchlist(const std::string& id) const {
   Watchlist watchlist;
 
   auto url = "/v2/watchlists/" + id;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -858,8 +922,7 @@ std::pair<Status, Watchlist> Client::createWatchlist(const std::string& name,
 
   DLOG(INFO) << "Sending request body to /v2/watchlists: " << body;
 
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Post("/v2/watchlists", headers(environment_), body, kJSONContentType);
+  auto resp = api_->Post("/v2/watchlists", headers(environment_), body, kJSONContentType);
   if (!resp) {
     return std::make_pair(Status(1, "Call to /v2/watchlists returned an empty response"), watchlist);
   }
@@ -899,9 +962,8 @@ std::pair<Status, Watchlist> Client::updateWatchlist(const std::string& id,
   auto body = s.GetString();
 
   auto url = "/v2/watchlists/" + id;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Sending request to " << url << ": " << body;
-  auto resp = client.Put(url.c_str(), headers(environment_), body, kJSONContentType);
+  auto resp = api_->Put(url, headers(environment_), body, kJSONContentType);
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -920,9 +982,8 @@ std::pair<Status, Watchlist> Client::updateWatchlist(const std::string& id,
 
 Status Client::deleteWatchlist(const std::string& id) const {
   auto url = "/v2/watchlists/" + id;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Delete(url.c_str(), headers(environment_));
+  auto resp = api_->Delete(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -951,9 +1012,8 @@ std::pair<Status, Watchlist> Client::addSymbolToWatchlist(const std::string& id,
   auto body = s.GetString();
 
   auto url = "/v2/watchlists/" + id;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Post(url.c_str(), headers(environment_), body, kJSONContentType);
+  auto resp = api_->Post(url, headers(environment_), body, kJSONContentType);
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -975,9 +1035,8 @@ std::pair<Status, Watchlist> Client::removeSymbolFromWatchlist(const std::string
   Watchlist watchlist;
 
   auto url = "/v2/watchlists/" + id + "/" + symbol;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Delete(url.c_str(), headers(environment_));
+  auto resp = api_->Delete(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -1034,8 +1093,7 @@ std::pair<Status, PortfolioHistory> Client::getPortfolioHistory(const std::strin
 
   auto url = "/v2/account/portfolio/history" + query_string;
   DLOG(INFO) << "Making request to: " << url;
-  httplib::SSLClient client(environment_.getAPIBaseURL());
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = api_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
@@ -1090,9 +1148,8 @@ std::pair<Status, Bars> Client::getBars(const std::vector<std::string>& symbols,
 
   auto url = "/v1/bars/" + timeframe + "?" + query_string;
 
-  httplib::SSLClient client(environment_.getAPIDataURL());
   DLOG(INFO) << "Making request to: " << url;
-  auto resp = client.Get(url.c_str(), headers(environment_));
+  auto resp = data_->Get(url, headers(environment_));
   if (!resp) {
     std::ostringstream ss;
     ss << "Call to " << url << " returned an empty response";
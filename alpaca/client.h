@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
@@ -19,6 +22,9 @@
 
 namespace alpaca {
 
+class ConnectionPool;
+class Executor;
+
 /**
  * @brief The API client object for interacting with the Alpaca Trading API.
  *
@@ -34,6 +40,15 @@ namespace alpaca {
  */
 class Client {
  public:
+  /**
+   * @brief A function receiving the result of an asynchronous call.
+   *
+   * It runs on a thread of the client's executor, so it must not block for
+   * long and must synchronize with the rest of the program.
+   */
+  template <typename T>
+  using Callback = std::function<void(const std::pair<Status, T>&)>;
+
   /**
    * @brief The primary constructor.
    */
@@ -44,6 +59,27 @@ class Client {
    */
   explicit Client() = delete;
 
+  /**
+   * @brief Open connections to the trading and data APIs ahead of the first
+   * request.
+   *
+   * Requests reuse keep-alive connections, so only the first request to each
+   * API pays for connecting. Call this at startup to take that cost off the
+   * first order. Copies of a client share the same connections.
+   *
+   * @code{.cpp}
+   *   if (auto status = client.warmUp(); !status.ok()) {
+   *     LOG(WARNING) << "Error connecting to Alpaca: " << status.getMessage();
+   *   }
+   * @endcode
+   *
+   * @param connections The number of connections to open to the trading API,
+   * i.e. the number of concurrent requests that do not have to connect.
+   *
+   * @return a Status indicating the success or faliure of the operation.
+   */
+  Status warmUp(const int connections = 1) const;
+
   /**
    * @brief Fetch Alpaca account information.
    *
@@ -64,6 +100,25 @@ class Client {
    */
   std::pair<Status, Account> getAccount() const;
 
+  /**
+   * @brief Fetch Alpaca account information without blocking.
+   *
+   * The request runs on the client's executor, shared by the copies of the
+   * client. `callback`, if not null, receives the result before the returned
+   * future becomes ready.
+   *
+   * @code{.cpp}
+   *   client.getAccountAsync([](const std::pair<alpaca::Status, alpaca::Account>& resp) {
+   *     if (auto status = resp.first; status.ok()) {
+   *       LOG(INFO) << "Cash: " << resp.second.cash;
+   *     }
+   *   });
+   * @endcode
+   *
+   * @return a std::future of the result of getAccount().
+   */
+  std::future<std::pair<Status, Account>> getAccountAsync(const Callback<Account>& callback = nullptr) const;
+
   /**
    * @brief Fetch Alpaca account configuration information.
    *
@@ -198,6 +253,17 @@ class Client {
    */
   std::pair<Status, Order> getOrderByClientOrderID(const std::string& client_order_id) const;
 
+  /**
+   * @brief Fetch a specific Alpaca order by client order ID without blocking.
+   *
+   * The request runs on the client's executor and `callback`, if not null,
+   * receives the result before the returned future becomes ready.
+   *
+   * @return a std::future of the result of getOrderByClientOrderID().
+   */
+  std::future<std::pair<Status, Order>> getOrderByClientOrderIDAsync(const std::string& client_order_id,
+                                                                     const Callback<Order>& callback = nullptr) const;
+
   /**
    * @brief Submit an Alpaca order.
    *
@@ -235,6 +301,44 @@ class Client {
                                        TakeProfitParams* take_profit_params = nullptr,
                                        StopLossParams* stop_loss_params = nullptr) const;
 
+  /**
+   * @brief Submit an Alpaca order without blocking.
+   *
+   * Takes the arguments of submitOrder() after the callback. The request runs
+   * on the client's executor and `callback`, if not null, receives the result
+   * before the returned future becomes ready.
+   *
+   * @code{.cpp}
+   *   client.submitOrderAsync(
+   *     [](const std::pair<alpaca::Status, alpaca::Order>& resp) {
+   *       if (auto status = resp.first; !status.ok()) {
+   *         LOG(ERROR) << "Error submitting order: " << status.getMessage();
+   *       }
+   *     },
+   *     "NFLX",
+   *     10,
+   *     alpaca::OrderSide::Buy,
+   *     alpaca::OrderType::Market,
+   *     alpaca::OrderTimeInForce::Day
+   *   );
+   * @endcode
+   *
+   * @return a std::future of the result of submitOrder().
+   */
+  std::future<std::pair<Status, Order>> submitOrderAsync(const Callback<Order>& callback,
+                                                         const std::string& symbol,
+                                                         const int quantity,
+                                                         const OrderSide side,
+                                                         const OrderType type,
+                                                         const OrderTimeInForce tif,
+                                                         const std::string& limit_price = "",
+                                                         const std::string& stop_price = "",
+                                                         const bool extended_hours = false,
+                                                         const std::string& client_order_id = "",
+                                                         const OrderClass order_class = OrderClass::Simple,
+                                                         TakeProfitParams* take_profit_params = nullptr,
+                                                         StopLossParams* stop_loss_params = nullptr) const;
+
   /**
    * @brief Replace an Alpaca order.
    *
@@ -304,6 +408,17 @@ class Client {
    */
   std::pair<Status, Order> cancelOrder(const std::string& id) const;
 
+  /**
+   * @brief Cancel a specific Alpaca order without blocking.
+   *
+   * The request runs on the client's executor and `callback`, if not null,
+   * receives the result before the returned future becomes ready.
+   *
+   * @return a std::future of the result of cancelOrder().
+   */
+  std::future<std::pair<Status, Order>> cancelOrderAsync(const std::string& id,
+                                                         const Callback<Order>& callback = nullptr) const;
+
   /**
    * @brief Fetch all open Alpaca positions.
    *
@@ -661,6 +776,16 @@ class Client {
                                   const uint limit = 100);
 
  private:
+  /**
+   * @brief A copy of the client for asynchronous calls to run with. It shares
+   * the connections but does not keep the executor alive, so that the last
+   * copy of the client, rather than a task, destroys the executor.
+   */
+  Client detached() const;
+
   Environment environment_;
+  std::shared_ptr<ConnectionPool> api_;
+  std::shared_ptr<ConnectionPool> data_;
+  std::shared_ptr<Executor> executor_;
 };
 } // namespace alpaca
@@ -15,6 +15,18 @@ TEST_F(ClientTest, testGetAccount) {
   EXPECT_EQ(account.status, "ACTIVE");
 }
 
+TEST_F(ClientTest, testWarmUp) {
+  auto client = alpaca::testClient();
+  EXPECT_OK(client.warmUp(2));
+
+  // requests, including those of copies of the client, reuse the connections
+  auto copy = client;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_OK(client.getClock().first);
+    EXPECT_OK(copy.getAccount().first);
+  }
+}
+
 TEST_F(ClientTest, testGetAccountConfigurations) {
   auto client = alpaca::testClient();
   auto get_account_configurations_resp = client.getAccountConfigurations();
@@ -0,0 +1,129 @@
+#include "alpaca/connection_pool.h"
+
+#include <sstream>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace alpaca {
+
+/// Connections idle for longer are replaced rather than reused, as servers
+/// and load balancers close idle connections after about a minute.
+constexpr std::chrono::seconds kMaxIdleTime(30);
+
+ConnectionPool::ConnectionPool(const std::string& host) : host_(host) {}
+
+Status ConnectionPool::warmUp(int connections) {
+  std::vector<std::unique_ptr<Connection>> opened;
+  for (auto i = idleConnections(); i < connections; ++i) {
+    auto connection = newConnection();
+    // Any response means that the connection is established.
+    auto resp = connection->client->Head("/");
+    if (!resp) {
+      std::ostringstream ss;
+      ss << "Connecting to " << host_ << " failed with httplib error " << static_cast<int>(resp.error());
+      return Status(1, ss.str());
+    }
+    connection->used = true;
+    connection->last_used = std::chrono::steady_clock::now();
+    opened.push_back(std::move(connection));
+  }
+  for (auto& connection : opened) {
+    release(std::move(connection));
+  }
+  DLOG(INFO) << "Connection pool for " << host_ << " has " << idleConnections() << " idle connections";
+  return Status();
+}
+
+int ConnectionPool::idleConnections() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+httplib::Result ConnectionPool::Get(const std::string& path, const httplib::Headers& headers) {
+  return send([&](httplib::SSLClient& client) { return client.Get(path.c_str(), headers); }, true);
+}
+
+httplib::Result ConnectionPool::Delete(const std::string& path, const httplib::Headers& headers) {
+  return send([&](httplib::SSLClient& client) { return client.Delete(path.c_str(), headers); }, true);
+}
+
+httplib::Result ConnectionPool::Post(const std::string& path,
+                                     const httplib::Headers& headers,
+                                     const std::string& body,
+                                     const char* content_type) {
+  return send([&](httplib::SSLClient& client) { return client.Post(path.c_str(), headers, body, content_type); },
+              false);
+}
+
+httplib::Result ConnectionPool::Put(const std::string& path,
+                                    const httplib::Headers& headers,
+                                    const std::string& body,
+                                    const char* content_type) {
+  return send([&](httplib::SSLClient& client) { return client.Put(path.c_str(), headers, body, content_type); },
+              true);
+}
+
+httplib::Result ConnectionPool::Patch(const std::string& path,
+                                      const httplib::Headers& headers,
+                                      const std::string& body,
+                                      const char* content_type) {
+  return send([&](httplib::SSLClient& client) { return client.Patch(path.c_str(), headers, body, content_type); },
+              false);
+}
+
+httplib::Result ConnectionPool::send(const Request& request, bool idempotent) {
+  auto connection = acquire();
+  const bool reused = connection->used;
+  auto resp = request(*connection->client);
+  if (!resp && reused) {
+    // The server may have closed the connection while it was idle. Unless the
+    // request may have reached the server, send it again on a new connection.
+    const auto error = resp.error();
+    const bool not_sent =
+        error == httplib::Error::Connection || error == httplib::Error::SSLConnection || error == httplib::Error::Write;
+    if (not_sent || idempotent) {
+      DLOG(INFO) << "Reconnecting to " << host_ << " after httplib error " << static_cast<int>(error);
+      connection = newConnection();
+      resp = request(*connection->client);
+    }
+  }
+  if (resp) {
+    connection->used = true;
+    connection->last_used = std::chrono::steady_clock::now();
+    release(std::move(connection));
+  }
+  return resp;
+}
+
+std::unique_ptr<ConnectionPool::Connection> ConnectionPool::newConnection() const {
+  auto connection = std::make_unique<Connection>();
+  connection->client = std::make_unique<httplib::SSLClient>(host_);
+  connection->client->set_keep_alive(true);
+  connection->client->set_tcp_nodelay(true);
+  return connection;
+}
+
+std::unique_ptr<ConnectionPool::Connection> ConnectionPool::acquire() {
+  const auto now = std::chrono::steady_clock::now();
+  std::unique_ptr<Connection> connection;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The most recently used connection is the most likely to still be open.
+    while (!idle_.empty() && !connection) {
+      connection = std::move(idle_.back());
+      idle_.pop_back();
+      if (now - connection->last_used > kMaxIdleTime) {
+        connection.reset();
+      }
+    }
+  }
+  return connection ? std::move(connection) : newConnection();
+}
+
+void ConnectionPool::release(std::unique_ptr<Connection> connection) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  idle_.push_back(std::move(connection));
+}
+
+} // namespace alpaca
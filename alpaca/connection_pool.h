@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "alpaca/status.h"
+#include "cpp-httplib/httplib.h"
+
+namespace alpaca {
+
+/**
+ * @brief A pool of keep-alive HTTPS connections to a single host.
+ *
+ * Requests run on an idle connection of the pool when there is one, so they
+ * skip DNS resolution, the TCP connect and the TLS handshake. A connection
+ * idle for longer than the server is likely to keep it open is replaced
+ * before use, and a request that fails on a reused connection is retried once
+ * on a new connection when that cannot apply it twice. The pool grows to the
+ * number of concurrent requests. Thread safe.
+ *
+ * @code{.cpp}
+ *   alpaca::ConnectionPool pool("paper-api.alpaca.markets");
+ *   pool.warmUp(2);
+ *   auto resp = pool.Get("/v2/clock", headers);
+ * @endcode
+ */
+class ConnectionPool {
+ public:
+  /**
+   * @brief The primary constructor.
+   */
+  explicit ConnectionPool(const std::string& host);
+
+  ConnectionPool(const ConnectionPool&) = delete;
+  ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+  /**
+   * @brief Opens connections ahead of the first request.
+   *
+   * @param connections The number of idle connections the pool should have.
+   *
+   * @return a Status indicating the success or faliure of the operation.
+   */
+  Status warmUp(int connections = 1);
+
+  /**
+   * @brief The number of idle connections.
+   */
+  int idleConnections();
+
+  httplib::Result Get(const std::string& path, const httplib::Headers& headers);
+  httplib::Result Delete(const std::string& path, const httplib::Headers& headers);
+  httplib::Result Post(const std::string& path,
+                       const httplib::Headers& headers,
+                       const std::string& body,
+                       const char* content_type);
+  httplib::Result Put(const std::string& path,
+                      const httplib::Headers& headers,
+                      const std::string& body,
+                      const char* content_type);
+  httplib::Result Patch(const std::string& path,
+                        const httplib::Headers& headers,
+                        const std::string& body,
+                        const char* content_type);
+
+ private:
+  struct Connection {
+    std::unique_ptr<httplib::SSLClient> client;
+    std::chrono::steady_clock::time_point last_used;
+    bool used = false;
+  };
+
+  using Request = std::function<httplib::Result(httplib::SSLClient&)>;
+
+  /**
+   * @brief Runs `request` on a pooled connection.
+   *
+   * @param idempotent Whether the request may be sent again after the server
+   * might have received it.
+   */
+  httplib::Result send(const Request& request, bool idempotent);
+
+  std::unique_ptr<Connection> newConnection() const;
+  std::unique_ptr<Connection> acquire();
+  void release(std::unique_ptr<Connection> connection);
+
+  const std::string host_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Connection>> idle_;
+};
+
+} // namespace alpaca
@@ -0,0 +1,87 @@
+#include "alpaca/decimal.h"
+
+#include <limits>
+
+namespace alpaca {
+
+bool Decimal::parse(std::string_view text, Decimal* decimal) {
+  size_t i = 0;
+  bool negative = false;
+  if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+    negative = text[i] == '-';
+    ++i;
+  }
+
+  constexpr int64_t kMaxWhole = std::numeric_limits<int64_t>::max() / kScale;
+  int64_t whole = 0;
+  bool digits = false;
+  for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+    whole = whole * 10 + (text[i] - '0');
+    if (whole > kMaxWhole) {
+      return false;
+    }
+    digits = true;
+  }
+
+  int64_t fraction = 0;
+  if (i < text.size() && text[i] == '.') {
+    ++i;
+    int places = 0;
+    bool round_up = false;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+      if (places < kDecimalPlaces) {
+        fraction = fraction * 10 + (text[i] - '0');
+      } else if (places == kDecimalPlaces) {
+        round_up = text[i] >= '5';
+      }
+      ++places;
+      digits = true;
+    }
+    for (; places < kDecimalPlaces; ++places) {
+      fraction *= 10;
+    }
+    if (round_up) {
+      ++fraction;
+    }
+  }
+  if (!digits || i != text.size()) {
+    return false;
+  }
+
+  // Cannot overflow, as whole <= kMaxWhole.
+  const int64_t units = whole * kScale;
+  if (units > std::numeric_limits<int64_t>::max() - fraction) {
+    return false;
+  }
+  *decimal = Decimal(negative ? -(units + fraction) : units + fraction);
+  return true;
+}
+
+double Decimal::toDouble() const {
+  return static_cast<double>(units_ / kScale) + static_cast<double>(units_ % kScale) / kScale;
+}
+
+std::string Decimal::toString() const {
+  std::string s = units_ < 0 ? "-" : "";
+  // Not negated, which could overflow.
+  const int64_t whole = units_ / kScale;
+  int64_t fraction = units_ % kScale;
+  s += std::to_string(whole < 0 ? -whole : whole);
+  if (fraction == 0) {
+    return s;
+  }
+  if (fraction < 0) {
+    fraction = -fraction;
+  }
+  std::string digits = std::to_string(fraction);
+  s += '.';
+  s.append(kDecimalPlaces - digits.size(), '0');
+  s += digits.substr(0, digits.find_last_not_of('0') + 1);
+  return s;
+}
+
+std::ostream& operator<<(std::ostream& os, const Decimal& decimal) {
+  return os << decimal.toString();
+}
+
+} // namespace alpaca
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace alpaca {
+
+/**
+ * @brief An exact fixed-point decimal number, for the prices, quantities and
+ * amounts that the Alpaca API sends as strings.
+ *
+ * Values are held as an integer count of 10^-9 units, which represents every
+ * price and (fractional) quantity of the API exactly and covers amounts up to
+ * about 9.2 billion. Comparison and addition are exact.
+ *
+ * @code{.cpp}
+ *   alpaca::Decimal cash;
+ *   if (alpaca::Decimal::parse("25000.50", &cash)) {
+ *     LOG(INFO) << cash << " is available as cash.";
+ *   }
+ * @endcode
+ */
+class Decimal {
+ public:
+  /**
+   * @brief The number of decimal places held.
+   */
+  static constexpr int kDecimalPlaces = 9;
+
+  /**
+   * @brief The number of units in 1.
+   */
+  static constexpr int64_t kScale = 1000000000;
+
+  constexpr Decimal() : units_(0) {}
+
+  /**
+   * @brief A decimal of `units` 10^-9 units.
+   */
+  static constexpr Decimal fromUnits(const int64_t units) {
+    return Decimal(units);
+  }
+
+  /**
+   * @brief Parses a decimal string such as "-12.5", rounding half away from
+   * zero beyond kDecimalPlaces.
+   *
+   * @return false, leaving `decimal` unchanged, if `text` is empty, is not a
+   * decimal number or is out of range.
+   */
+  static bool parse(std::string_view text, Decimal* decimal);
+
+  /**
+   * @brief The value in 10^-9 units.
+   */
+  constexpr int64_t units() const {
+    return units_;
+  }
+
+  /**
+   * @brief The value truncated toward zero.
+   */
+  constexpr int64_t toInt() const {
+    return units_ / kScale;
+  }
+
+  /**
+   * @brief The nearest double of the value.
+   */
+  double toDouble() const;
+
+  /**
+   * @brief The value without trailing zeros, e.g. "12.5" or "-3".
+   */
+  std::string toString() const;
+
+  constexpr Decimal operator+(const Decimal& rhs) const {
+    return Decimal(units_ + rhs.units_);
+  }
+  constexpr Decimal operator-(const Decimal& rhs) const {
+    return Decimal(units_ - rhs.units_);
+  }
+  constexpr Decimal operator-() const {
+    return Decimal(-units_);
+  }
+
+  constexpr bool operator==(const Decimal& rhs) const {
+    return units_ == rhs.units_;
+  }
+  constexpr bool operator!=(const Decimal& rhs) const {
+    return units_ != rhs.units_;
+  }
+  constexpr bool operator<(const Decimal& rhs) const {
+    return units_ < rhs.units_;
+  }
+  constexpr bool operator<=(const Decimal& rhs) const {
+    return units_ <= rhs.units_;
+  }
+  constexpr bool operator>(const Decimal& rhs) const {
+    return units_ > rhs.units_;
+  }
+  constexpr bool operator>=(const Decimal& rhs) const {
+    return units_ >= rhs.units_;
+  }
+
+ private:
+  constexpr explicit Decimal(const int64_t units) : units_(units) {}
+
+  int64_t units_;
+};
+
+std::ostream& operator<<(std::ostream& os, const Decimal& decimal);
+
+} // namespace alpaca
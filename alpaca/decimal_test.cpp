@@ -0,0 +1,79 @@
+#include "alpaca/decimal.h"
+
+#include <limits>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+class DecimalTest : public ::testing::Test {};
+
+TEST_F(DecimalTest, testParse) {
+  alpaca::Decimal decimal;
+  EXPECT_TRUE(alpaca::Decimal::parse("253.02", &decimal));
+  EXPECT_EQ(decimal.units(), 253020000000);
+  EXPECT_TRUE(alpaca::Decimal::parse("-0.5", &decimal));
+  EXPECT_EQ(decimal.units(), -500000000);
+  EXPECT_TRUE(alpaca::Decimal::parse("+7", &decimal));
+  EXPECT_EQ(decimal.units(), 7000000000);
+  EXPECT_TRUE(alpaca::Decimal::parse(".25", &decimal));
+  EXPECT_EQ(decimal.units(), 250000000);
+  EXPECT_TRUE(alpaca::Decimal::parse("0.000000001", &decimal));
+  EXPECT_EQ(decimal.units(), 1);
+}
+
+TEST_F(DecimalTest, testParseRounds) {
+  alpaca::Decimal decimal;
+  EXPECT_TRUE(alpaca::Decimal::parse("0.0247440754017341", &decimal));
+  EXPECT_EQ(decimal.units(), 24744075);
+  EXPECT_TRUE(alpaca::Decimal::parse("-0.0000000015", &decimal));
+  EXPECT_EQ(decimal.units(), -2);
+  EXPECT_TRUE(alpaca::Decimal::parse("0.9999999999", &decimal));
+  EXPECT_EQ(decimal.units(), alpaca::Decimal::kScale);
+}
+
+TEST_F(DecimalTest, testParseFailure) {
+  alpaca::Decimal decimal = alpaca::Decimal::fromUnits(42);
+  EXPECT_FALSE(alpaca::Decimal::parse("", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse("-", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse(".", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse("1.2.3", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse("12a", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse(" 12", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse("1e5", &decimal));
+  EXPECT_FALSE(alpaca::Decimal::parse("10000000000", &decimal));
+  EXPECT_EQ(decimal.units(), 42);
+
+  EXPECT_TRUE(alpaca::Decimal::parse("9223372036.854775807", &decimal));
+  EXPECT_EQ(decimal.units(), std::numeric_limits<int64_t>::max());
+  EXPECT_FALSE(alpaca::Decimal::parse("9223372036.854775808", &decimal));
+}
+
+TEST_F(DecimalTest, testConversions) {
+  alpaca::Decimal decimal;
+  EXPECT_TRUE(alpaca::Decimal::parse("-12.50", &decimal));
+  EXPECT_EQ(decimal.toInt(), -12);
+  EXPECT_DOUBLE_EQ(decimal.toDouble(), -12.5);
+  EXPECT_EQ(decimal.toString(), "-12.5");
+  EXPECT_EQ(alpaca::Decimal().toString(), "0");
+  EXPECT_EQ(alpaca::Decimal::fromUnits(-1).toString(), "-0.000000001");
+  EXPECT_EQ(alpaca::Decimal::fromUnits(3 * alpaca::Decimal::kScale).toString(), "3");
+
+  std::ostringstream ss;
+  ss << alpaca::Decimal::fromUnits(1500000000);
+  EXPECT_EQ(ss.str(), "1.5");
+}
+
+TEST_F(DecimalTest, testArithmetic) {
+  alpaca::Decimal a, b;
+  EXPECT_TRUE(alpaca::Decimal::parse("0.1", &a));
+  EXPECT_TRUE(alpaca::Decimal::parse("0.2", &b));
+  alpaca::Decimal c;
+  EXPECT_TRUE(alpaca::Decimal::parse("0.3", &c));
+  // Exact, unlike doubles.
+  EXPECT_EQ(a + b, c);
+  EXPECT_EQ(c - b, a);
+  EXPECT_LT(a, b);
+  EXPECT_GT(-a, -b);
+  EXPECT_LE(a, a);
+  EXPECT_NE(a, b);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace alpaca {
+
+/**
+ * @brief A fixed-size pool of threads that runs posted tasks in FIFO order.
+ *
+ * The threads start with the first posted task, so an executor that is never
+ * used costs nothing. Destroying the executor runs the tasks that are still
+ * queued, then joins the threads.
+ *
+ * @code{.cpp}
+ *   alpaca::Executor executor(2);
+ *   executor.post([]() { LOG(INFO) << "Running off the calling thread."; });
+ * @endcode
+ */
+class Executor {
+ public:
+  /**
+   * @brief The primary constructor.
+   *
+   * @param threads The number of tasks that can run concurrently.
+   */
+  explicit Executor(const int threads);
+
+  ~Executor();
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  /**
+   * @brief Queue a task. Returns immediately.
+   */
+  void post(std::function<void()> task);
+
+ private:
+  void run();
+
+  const int threads_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace alpaca
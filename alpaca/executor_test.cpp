@@ -0,0 +1,66 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "alpaca/executor.h"
+#include "gtest/gtest.h"
+
+class ExecutorTest : public ::testing::Test {};
+
+TEST_F(ExecutorTest, testRunsTasksOffTheCallingThread) {
+  std::promise<std::thread::id> id;
+  alpaca::Executor executor(1);
+  executor.post([&id]() { id.set_value(std::this_thread::get_id()); });
+  EXPECT_NE(id.get_future().get(), std::this_thread::get_id());
+}
+
+TEST_F(ExecutorTest, testRunsTasksInOrder) {
+  std::mutex mutex;
+  std::vector<int> order;
+  {
+    alpaca::Executor executor(1);
+    for (int i = 0; i < 100; i++) {
+      executor.post([&, i]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(i);
+      });
+    }
+  }
+  ASSERT_EQ(order.size(), 100);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(order[i], i);
+  }
+}
+
+TEST_F(ExecutorTest, testRunsTasksConcurrently) {
+  std::promise<void> first_started;
+  std::promise<void> second_done;
+  auto second_done_future = second_done.get_future().share();
+  // destroyed first, so that the tasks finish before the promises go away
+  alpaca::Executor executor(2);
+  executor.post([&]() {
+    first_started.set_value();
+    // blocks until the second task ran on the other thread
+    second_done_future.wait();
+  });
+  first_started.get_future().wait();
+  executor.post([&]() { second_done.set_value(); });
+  EXPECT_EQ(second_done_future.wait_for(std::chrono::seconds(10)), std::future_status::ready);
+}
+
+TEST_F(ExecutorTest, testDestructorRunsQueuedTasks) {
+  std::atomic<int> count(0);
+  {
+    alpaca::Executor executor(2);
+    for (int i = 0; i < 10; i++) {
+      executor.post([&count]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        count++;
+      });
+    }
+  }
+  EXPECT_EQ(count, 10);
+}
@@ -1,3 +1,4 @@
+#include "alpaca/decimal.h"
 #include "rapidjson/document.h"
 
 #define PARSE_STRING(var, name)                                                                                        \
@@ -30,6 +31,11 @@
     var = d[name].GetFloat();                                                                                          \
   }
 
+#define PARSE_DECIMAL(var, name)                                                                                       \
+  if (d.HasMember(name) && d[name].IsString()) {                                                                       \
+    Decimal::parse(std::string_view(d[name].GetString(), d[name].GetStringLength()), &var);                            \
+  }
+
 #define PARSE_VECTOR_DOUBLES(var, name)                                                                                \
   if (d.HasMember(name) && d[name].IsArray()) {                                                                        \
     std::vector<double> items;                                                                                         \
@@ -86,14 +86,19 @@ Status Order::fromJSON(const std::string& json) {
   PARSE_STRING(failed_at, "failed_at")
   PARSE_STRING(filled_at, "filled_at")
   PARSE_STRING(filled_avg_price, "filled_avg_price")
+  PARSE_DECIMAL(filled_avg_price_decimal, "filled_avg_price")
   PARSE_STRING(filled_qty, "filled_qty")
+  PARSE_DECIMAL(filled_qty_decimal, "filled_qty")
   PARSE_STRING(id, "id")
   PARSE_BOOL(legs, "legs")
   PARSE_STRING(limit_price, "limit_price")
+  PARSE_DECIMAL(limit_price_decimal, "limit_price")
   PARSE_STRING(qty, "qty")
+  PARSE_DECIMAL(qty_decimal, "qty")
   PARSE_STRING(side, "side")
   PARSE_STRING(status, "status")
   PARSE_STRING(stop_price, "stop_price")
+  PARSE_DECIMAL(stop_price_decimal, "stop_price")
   PARSE_STRING(submitted_at, "submitted_at")
   PARSE_STRING(symbol, "symbol")
   PARSE_STRING(time_in_force, "time_in_force")
@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "alpaca/decimal.h"
 #include "alpaca/status.h"
 
 namespace alpaca {
@@ -144,5 +145,15 @@ class Order {
   std::string time_in_force;
   std::string type;
   std::string updated_at;
+
+  /**
+   * @brief The numeric fields above, parsed once by fromJSON(). Zero if absent
+   * or null.
+   */
+  Decimal filled_avg_price_decimal;
+  Decimal filled_qty_decimal;
+  Decimal limit_price_decimal;
+  Decimal qty_decimal;
+  Decimal stop_price_decimal;
 };
 } // namespace alpaca
\ No newline at end of file
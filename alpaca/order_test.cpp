@@ -37,4 +37,15 @@ TEST_F(OrderTest, testOrderFromJSON) {
   alpaca::Order order;
   EXPECT_OK(order.fromJSON(kOrderJSON));
   EXPECT_EQ(order.symbol, "AAPL");
+  EXPECT_EQ(order.qty_decimal.toInt(), 15);
+  EXPECT_EQ(order.filled_qty_decimal, alpaca::Decimal());
+  EXPECT_EQ(order.limit_price_decimal.toString(), "107");
+}
+
+TEST_F(OrderTest, testOrderFromJSONWithNullFields) {
+  alpaca::Order order;
+  EXPECT_OK(order.fromJSON("{\"qty\": \"10\", \"filled_avg_price\": null, \"limit_price\": \"\"}"));
+  EXPECT_EQ(order.qty_decimal.toInt(), 10);
+  EXPECT_EQ(order.filled_avg_price_decimal, alpaca::Decimal());
+  EXPECT_EQ(order.limit_price_decimal, alpaca::Decimal());
 }
@@ -17,19 +17,30 @@ Status Position::fromJSON(const std::string& json) {
   PARSE_STRING(asset_class, "asset_class")
   PARSE_STRING(asset_id, "asset_id")
   PARSE_STRING(avg_entry_price, "avg_entry_price")
+  PARSE_DECIMAL(avg_entry_price_decimal, "avg_entry_price")
   PARSE_STRING(change_today, "change_today")
+  PARSE_DECIMAL(change_today_decimal, "change_today")
   PARSE_STRING(cost_basis, "cost_basis")
+  PARSE_DECIMAL(cost_basis_decimal, "cost_basis")
   PARSE_STRING(current_price, "current_price")
+  PARSE_DECIMAL(current_price_decimal, "current_price")
   PARSE_STRING(exchange, "exchange")
   PARSE_STRING(lastday_price, "lastday_price")
+  PARSE_DECIMAL(lastday_price_decimal, "lastday_price")
   PARSE_STRING(market_value, "market_value")
+  PARSE_DECIMAL(market_value_decimal, "market_value")
   PARSE_STRING(qty, "qty")
+  PARSE_DECIMAL(qty_decimal, "qty")
   PARSE_STRING(side, "side")
   PARSE_STRING(symbol, "symbol")
   PARSE_STRING(unrealized_intraday_pl, "unrealized_intraday_pl")
+  PARSE_DECIMAL(unrealized_intraday_pl_decimal, "unrealized_intraday_pl")
   PARSE_STRING(unrealized_intraday_plpc, "unrealized_intraday_plpc")
+  PARSE_DECIMAL(unrealized_intraday_plpc_decimal, "unrealized_intraday_plpc")
   PARSE_STRING(unrealized_pl, "unrealized_pl")
+  PARSE_DECIMAL(unrealized_pl_decimal, "unrealized_pl")
   PARSE_STRING(unrealized_plpc, "unrealized_plpc")
+  PARSE_DECIMAL(unrealized_plpc_decimal, "unrealized_plpc")
 
   return Status();
 }
@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "alpaca/decimal.h"
 #include "alpaca/status.h"
 
 namespace alpaca {
@@ -37,5 +38,21 @@ class Position {
   std::string unrealized_intraday_plpc;
   std::string unrealized_pl;
   std::string unrealized_plpc;
+
+  /**
+   * @brief The numeric fields above, parsed once by fromJSON(). Zero if absent
+   * or null.
+   */
+  Decimal avg_entry_price_decimal;
+  Decimal change_today_decimal;
+  Decimal cost_basis_decimal;
+  Decimal current_price_decimal;
+  Decimal lastday_price_decimal;
+  Decimal market_value_decimal;
+  Decimal qty_decimal;
+  Decimal unrealized_intraday_pl_decimal;
+  Decimal unrealized_intraday_plpc_decimal;
+  Decimal unrealized_pl_decimal;
+  Decimal unrealized_plpc_decimal;
 };
 } // namespace alpaca
\ No newline at end of file
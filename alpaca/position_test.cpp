@@ -30,4 +30,7 @@ TEST_F(PositionTest, testAccountConfigurationFromJSON) {
   alpaca::Position position;
   EXPECT_OK(position.fromJSON(kPositionJSON));
   EXPECT_EQ(position.exchange, "NASDAQ");
+  EXPECT_EQ(position.qty_decimal.toInt(), 5);
+  EXPECT_EQ(position.unrealized_intraday_plpc_decimal.toString(), "0.0084");
+  EXPECT_DOUBLE_EQ(position.avg_entry_price_decimal.toDouble(), 100.0);
 }
\ No newline at end of file
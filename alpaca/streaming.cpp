@@ -4,7 +4,6 @@
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
-#include "uWS.h"
 
 namespace alpaca::stream {
 
@@ -90,17 +89,17 @@ std::pair<Status, Reply> parseReply(const std::string& text) {
   }
 
   if (d.HasMember("stream") && d["stream"].IsString()) {
-    auto stream = d["stream"].GetString();
-    if (*stream == *kAuthorizationStream.c_str()) {
+    std::string stream = d["stream"].GetString();
+    if (stream == kAuthorizationStream) {
       r.reply_type = Authorization;
       return std::make_pair(Status(), r);
-    } else if (*stream == *kListeningStream.c_str()) {
+    } else if (stream == kListeningStream) {
       r.reply_type = Listening;
       return std::make_pair(Status(), r);
-    } else if (*stream == *kTradeUpdatesStream.c_str()) {
+    } else if (stream == kTradeUpdatesStream) {
       r.reply_type = Update;
       r.stream_type = TradeUpdates;
-    } else if (*stream == *kAccountUpdatesStream.c_str()) {
+    } else if (stream == kAccountUpdatesStream) {
       r.reply_type = Update;
       r.stream_type = AccountUpdates;
     } else {
@@ -123,10 +122,20 @@ std::pair<Status, Reply> parseReply(const std::string& text) {
   return std::make_pair(Status(), r);
 }
 
-Status Handler::run(Environment& env) {
-  uWS::Hub hub;
-  auto group = hub.createGroup<uWS::CLIENT>();
+Handler::Handler(std::function<void(DataType)> on_trade_update, std::function<void(DataType)> on_account_update)
+    : on_trade_update_(on_trade_update), on_account_update_(on_account_update), stopped_(false) {
+  client_.clear_access_channels(websocketpp::log::alevel::all);
+  client_.set_error_channels(websocketpp::log::elevel::all);
+  client_.init_asio();
+  client_.set_tls_init_handler([](websocketpp::connection_hdl) {
+    auto context = std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::sslv23);
+    context->set_options(boost::asio::ssl::context::default_workarounds | boost::asio::ssl::context::no_sslv2 |
+                         boost::asio::ssl::context::no_sslv3 | boost::asio::ssl::context::single_dh_use);
+    return context;
+  });
+}
 
+Status Handler::run(Environment& env) {
   if (!env.hasBeenParsed()) {
     if (auto status = env.parse(); !status.ok()) {
       return status;
@@ -134,64 +143,99 @@ Status Handler::run(Environment& env) {
   }
   auto message_generator_ = MessageGenerator();
   auto authentication = message_generator_.authentication(env.getAPIKeyID(), env.getAPISecretKey());
-  auto listen = message_generator_.listen({StreamType::TradeUpdates, StreamType::AccountUpdates});
+  listen_ = message_generator_.listen({StreamType::TradeUpdates, StreamType::AccountUpdates});
 
-  group->onConnection([authentication](uWS::WebSocket<uWS::CLIENT>* ws, uWS::HttpRequest req) {
+  client_.set_open_handler([this, authentication](websocketpp::connection_hdl hdl) {
     DLOG(INFO) << "Received connection event and sending authenticate message";
-    ws->send(authentication.data(), authentication.size(), uWS::OpCode::TEXT);
+    websocketpp::lib::error_code ec;
+    client_.send(hdl, authentication, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      LOG(ERROR) << "Error sending authenticate message: " << ec.message();
+    }
   });
 
-  group->onMessage([this, listen](uWS::WebSocket<uWS::CLIENT>* ws, char* message, size_t length, uWS::OpCode opCode) {
-    auto text = std::string(message, length);
+  client_.set_message_handler(
+      [this](websocketpp::connection_hdl hdl, WebSocketClient::message_ptr message) { onMessage(hdl, message); });
 
-    auto parsed_reply = parseReply(text);
-    if (auto status = parsed_reply.first; !status.ok()) {
-      LOG(ERROR) << "Error parsing stream reply: " << status.getMessage();
-      return;
-    }
-    auto reply = parsed_reply.second;
-
-    if (reply.reply_type == ReplyType::Authorization) {
-      DLOG(INFO) << "Sending listen message: " << listen;
-      ws->send(listen.data(), listen.size(), uWS::OpCode::TEXT);
-      return;
-    } else if (reply.reply_type == ReplyType::Listening) {
-      DLOG(INFO) << "Received listening confirmation";
-      return;
-    } else if (reply.reply_type == ReplyType::UnknownReplyType) {
-      LOG(WARNING) << "Received unknown stream reply type";
-      return;
-    } else if (reply.reply_type == ReplyType::Update) {
-      DLOG(INFO) << "Received update message";
-    } else {
-      LOG(ERROR) << "Unhandled stream reply type in router: " << reply.reply_type;
-    }
-
-    if (reply.stream_type == StreamType::UnknownStreamType) {
-      LOG(WARNING) << "Received unknown stream type";
-    } else if (reply.stream_type == StreamType::TradeUpdates) {
-      DLOG(INFO) << "Received trade update";
-      on_trade_update_(reply.data);
-    } else if (reply.stream_type == StreamType::AccountUpdates) {
-      DLOG(INFO) << "Received account update";
-      on_account_update_(reply.data);
-    } else {
-      LOG(ERROR) << "Unhandled stream type in router: " << reply.stream_type;
-    }
+  client_.set_close_handler([this](websocketpp::connection_hdl hdl) {
+    auto connection = client_.get_con_from_hdl(hdl);
+    DLOG(INFO) << "Received disconnection event: " << connection->get_remote_close_reason();
   });
 
-  group->onDisconnection([](uWS::WebSocket<uWS::CLIENT>* ws, int code, char* message, size_t length) {
-    DLOG(INFO) << "Received disconnection event: " << std::string(message, length);
+  client_.set_fail_handler([this](websocketpp::connection_hdl hdl) {
+    auto connection = client_.get_con_from_hdl(hdl);
+    LOG(ERROR) << "Received error in stream handler: " << connection->get_ec().message();
   });
 
-  group->onError([](void* e) { LOG(ERROR) << "Received error in stream handler."; });
+  // Clear a stop() of an earlier run. A stop() from now on makes run() below
+  // return immediately.
+  client_.reset();
+  if (stopped_) {
+    return Status();
+  }
 
   std::ostringstream ss;
   ss << "wss://" << env.getAPIBaseURL() << "/stream";
-  hub.connect(ss.str(), nullptr, {}, 5000, group);
-  hub.run();
+  websocketpp::lib::error_code ec;
+  auto connection = client_.get_connection(ss.str(), ec);
+  if (ec) {
+    return Status(1, "Could not create stream connection: " + ec.message());
+  }
+  client_.connect(connection);
+  client_.run();
 
-  return Status(1, "unreachable");
+  if (stopped_) {
+    return Status();
+  }
+  return Status(1, "Stream connection closed");
+}
+
+void Handler::stop() {
+  stopped_ = true;
+  client_.stop();
+}
+
+void Handler::onMessage(websocketpp::connection_hdl hdl, WebSocketClient::message_ptr message) {
+  const auto& text = message->get_payload();
+
+  auto parsed_reply = parseReply(text);
+  if (auto status = parsed_reply.first; !status.ok()) {
+    LOG(ERROR) << "Error parsing stream reply: " << status.getMessage();
+    return;
+  }
+  auto reply = parsed_reply.second;
+
+  if (reply.reply_type == ReplyType::Authorization) {
+    DLOG(INFO) << "Sending listen message: " << listen_;
+    websocketpp::lib::error_code ec;
+    client_.send(hdl, listen_, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+      LOG(ERROR) << "Error sending listen message: " << ec.message();
+    }
+    return;
+  } else if (reply.reply_type == ReplyType::Listening) {
+    DLOG(INFO) << "Received listening confirmation";
+    return;
+  } else if (reply.reply_type == ReplyType::UnknownReplyType) {
+    LOG(WARNING) << "Received unknown stream reply type";
+    return;
+  } else if (reply.reply_type == ReplyType::Update) {
+    DLOG(INFO) << "Received update message";
+  } else {
+    LOG(ERROR) << "Unhandled stream reply type in router: " << reply.reply_type;
+  }
+
+  if (reply.stream_type == StreamType::UnknownStreamType) {
+    LOG(WARNING) << "Received unknown stream type";
+  } else if (reply.stream_type == StreamType::TradeUpdates) {
+    DLOG(INFO) << "Received trade update";
+    on_trade_update_(reply.data);
+  } else if (reply.stream_type == StreamType::AccountUpdates) {
+    DLOG(INFO) << "Received account update";
+    on_account_update_(reply.data);
+  } else {
+    LOG(ERROR) << "Unhandled stream type in router: " << reply.stream_type;
+  }
 }
 
 } // namespace alpaca::stream
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <set>
 #include <string>
 #include <utility>
 #include <variant>
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_client.hpp>
 
 #include "alpaca/config.h"
 #include "alpaca/status.h"
@@ -51,22 +54,39 @@ class MessageGenerator {
 
 /**
  * @brief A class for handling stream messages
+ *
+ * The callbacks run on the thread that calls run().
  */
 class Handler {
  public:
   Handler() = delete;
-  Handler(std::function<void(DataType)> on_trade_update, std::function<void(DataType)> on_account_update)
-      : on_trade_update_(on_trade_update), on_account_update_(on_account_update) {}
+  Handler(std::function<void(DataType)> on_trade_update, std::function<void(DataType)> on_account_update);
 
  public:
   /**
-   * @brief Run the stream handler and block.
+   * @brief Run the stream handler and block until the connection closes or
+   * stop() is called.
+   *
+   * @return OK if stopped by stop(), an error otherwise.
    */
   Status run(Environment& env);
 
+  /**
+   * @brief Make run() return. Thread safe, and may be called before run().
+   */
+  void stop();
+
  private:
+  typedef websocketpp::client<websocketpp::config::asio_tls_client> WebSocketClient;
+
+  void onMessage(websocketpp::connection_hdl hdl, WebSocketClient::message_ptr message);
+
   std::function<void(DataType)> on_trade_update_;
   std::function<void(DataType)> on_account_update_;
+
+  WebSocketClient client_;
+  std::string listen_;
+  std::atomic<bool> stopped_;
 };
 
 class Reply {
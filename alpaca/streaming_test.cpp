@@ -1,6 +1,7 @@
 #include "alpaca/streaming.h"
 
 #include "alpaca/testing.h"
+#include "alpaca/trade_update.h"
 #include "gtest/gtest.h"
 
 const std::string kAuthorizationReply =
@@ -51,4 +52,32 @@ const std::string kTradeUpdatsReply =
 
 class StreamingTest : public ::testing::Test {};
 
-TEST_F(StreamingTest, testReplyParser) {}
\ No newline at end of file
+TEST_F(StreamingTest, testReplyParser) {
+  auto authorization = alpaca::stream::parseReply(kAuthorizationReply);
+  EXPECT_OK(authorization.first);
+  EXPECT_EQ(authorization.second.reply_type, alpaca::stream::Authorization);
+
+  auto listening = alpaca::stream::parseReply(kListeningReply);
+  EXPECT_OK(listening.first);
+  EXPECT_EQ(listening.second.reply_type, alpaca::stream::Listening);
+
+  auto trade_update = alpaca::stream::parseReply(kTradeUpdatsReply);
+  EXPECT_OK(trade_update.first);
+  EXPECT_EQ(trade_update.second.reply_type, alpaca::stream::Update);
+  EXPECT_EQ(trade_update.second.stream_type, alpaca::stream::TradeUpdates);
+
+  EXPECT_NOT_OK(alpaca::stream::parseReply("{\"stream\":\"authorizations\"}").first);
+}
+
+TEST_F(StreamingTest, testTradeUpdateFromJSON) {
+  auto reply = alpaca::stream::parseReply(kTradeUpdatsReply);
+  EXPECT_OK(reply.first);
+  alpaca::TradeUpdate update;
+  EXPECT_OK(update.fromJSON(reply.second.data));
+  EXPECT_EQ(update.event, "fill");
+  EXPECT_EQ(update.price, "253.02");
+  EXPECT_EQ(update.qty, "1");
+  EXPECT_EQ(update.order.client_order_id, "53b52c15-b7f7-4940-9292-d3e3857cfb97");
+  EXPECT_EQ(update.order.status, "filled");
+  EXPECT_EQ(update.order.filled_qty, "1");
+}
\ No newline at end of file
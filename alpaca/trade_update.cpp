@@ -0,0 +1,34 @@
+#include "alpaca/trade_update.h"
+
+#include "alpaca/json.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace alpaca {
+Status TradeUpdate::fromJSON(const std::string& json) {
+  rapidjson::Document d;
+  if (d.Parse(json.c_str()).HasParseError()) {
+    return Status(1, "Received parse error when deserializing trade update JSON");
+  }
+
+  if (!d.IsObject()) {
+    return Status(1, "Deserialized valid JSON but it wasn't a trade update object");
+  }
+
+  PARSE_STRING(event, "event")
+  PARSE_STRING(position_qty, "position_qty")
+  PARSE_STRING(price, "price")
+  PARSE_STRING(qty, "qty")
+  PARSE_STRING(timestamp, "timestamp")
+
+  if (!d.HasMember("order") || !d["order"].IsObject()) {
+    return Status(1, "Trade update did not contain an order object");
+  }
+  rapidjson::StringBuffer s;
+  s.Clear();
+  rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+  d["order"].Accept(writer);
+  return order.fromJSON(s.GetString());
+}
+} // namespace alpaca
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+
+namespace alpaca {
+
+/**
+ * @brief A type representing an update of an order from the trade_updates
+ * stream.
+ *
+ * `event` is one of new, fill, partial_fill, canceled, expired, done_for_day,
+ * replaced, rejected, pending_new, stopped, pending_cancel, pending_replace,
+ * calculated, suspended, order_replace_rejected and order_cancel_rejected.
+ * `price` and `qty` are those of the execution of fill and partial_fill
+ * events, and `order` is the state of the order after the event.
+ */
+class TradeUpdate {
+ public:
+  /**
+   * @brief A method for deserializing JSON into the current object state.
+   *
+   * @param json The JSON string of the data of a trade_updates message
+   *
+   * @return a Status indicating the success or faliure of the operation.
+   */
+  Status fromJSON(const std::string& json);
+
+ public:
+  std::string event;
+  Order order;
+  std::string position_qty;
+  std::string price;
+  std::string qty;
+  std::string timestamp;
+};
+} // namespace alpaca
@@ -0,0 +1,86 @@
+#include "bench/alloc_counter.h"
+#include "bench/bench_util.h"
+#include "benchmark/benchmark.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// Seconds of aggregates fed per store. Feeding them again would send time
+// backwards, so each pass gets a fresh store.
+constexpr int kNumSeconds = 30;
+
+const std::vector<AggregateData>& Aggregates(int num_symbols) {
+  static auto* aggs = new std::map<int, std::vector<AggregateData>>();
+  auto iter = aggs->find(num_symbols);
+  if (iter == aggs->end()) {
+    iter =
+        aggs->emplace(num_symbols, MakeAggregates(num_symbols, kNumSeconds))
+            .first;
+  }
+  return iter->second;
+}
+
+// Feeds the aggregates of `num_symbols` symbols to stores created by
+// `make_store`, after a first second of aggregates that allocates the
+// per-symbol state.
+template <typename Store, typename MakeStore>
+void AddDataLoop(benchmark::State& state, int num_symbols,
+                 MakeStore make_store) {
+  const std::vector<AggregateData>& aggs = Aggregates(num_symbols);
+  auto warm_store = [&]() {
+    std::unique_ptr<Store> store = make_store();
+    for (int i = 0; i < num_symbols; ++i) {
+      store->AddData(aggs[i]);
+    }
+    return store;
+  };
+
+  std::unique_ptr<Store> store = warm_store();
+  int i = num_symbols;
+  AllocationReporter allocs(&state);
+  for (auto _ : state) {
+    if (i == aggs.size()) {
+      state.PauseTiming();
+      allocs.Pause();
+      store = warm_store();
+      i = num_symbols;
+      allocs.Resume();
+      state.ResumeTiming();
+    }
+    benchmark::DoNotOptimize(store->AddData(aggs[i++]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Arg: number of symbols.
+void BM_AggDataStoreAddData(benchmark::State& state) {
+  AddDataLoop<AggDataStore>(state, state.range(0), []() {
+    return std::make_unique<AggDataStore>(10);
+  });
+}
+BENCHMARK(BM_AggDataStoreAddData)->ArgName("symbols")->Arg(1000)->Arg(10000);
+
+// All four standard timeframes in one pass, as DataHandler does.
+// Arg: number of symbols.
+void BM_CascadingAggregatorAddData(benchmark::State& state) {
+  AddDataLoop<CascadingAggregator>(state, state.range(0), []() {
+    return std::make_unique<CascadingAggregator>(
+        std::vector<int64_t>({1, 10, 60, 300}));
+  });
+}
+BENCHMARK(BM_CascadingAggregatorAddData)
+    ->ArgName("symbols")
+    ->Arg(1000)
+    ->Arg(10000);
+
+}  // namespace
+}  // namespace pasta
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include "bench/alloc_counter.h"
+
+#include "benchmark/benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<int64_t> allocation_count(0);
+
+void* CountedAlloc(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (size == 0) size = 1;
+  void* p = std::malloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void* CountedAlignedAlloc(size_t size, std::align_val_t alignment) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  size_t align = static_cast<size_t>(alignment);
+  // aligned_alloc requires the size to be a multiple of the alignment.
+  void* p = std::aligned_alloc(align, (size + align - 1) / align * align);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return CountedAlloc(size); }
+void* operator new[](size_t size) { return CountedAlloc(size); }
+void* operator new(size_t size, std::align_val_t alignment) {
+  return CountedAlignedAlloc(size, alignment);
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+
+namespace pasta {
+
+int64_t AllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+AllocationReporter::AllocationReporter(benchmark::State* state)
+    : state_(state), start_(AllocationCount()), count_(0), paused_(false) {}
+
+AllocationReporter::~AllocationReporter() {
+  Pause();
+  state_->counters["allocs/op"] =
+      benchmark::Counter(count_, benchmark::Counter::kAvgIterations);
+}
+
+void AllocationReporter::Pause() {
+  if (paused_) return;
+  count_ += AllocationCount() - start_;
+  paused_ = true;
+}
+
+void AllocationReporter::Resume() {
+  start_ = AllocationCount();
+  paused_ = false;
+}
+
+}  // namespace pasta
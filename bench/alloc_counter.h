@@ -0,0 +1,35 @@
+#ifndef PASTA_BENCH_ALLOC_COUNTER_H_
+#define PASTA_BENCH_ALLOC_COUNTER_H_
+
+#include "benchmark/benchmark.h"
+
+#include <cstdint>
+
+namespace pasta {
+
+// The number of heap allocations made by the process so far. Counted by
+// replacing the global operator new of binaries that link alloc_counter.
+int64_t AllocationCount();
+
+// Counts the allocations of the timed parts of a benchmark and reports them
+// per iteration as the "allocs/op" counter when destroyed. Create it right
+// before the benchmark loop.
+class AllocationReporter {
+ public:
+  explicit AllocationReporter(benchmark::State* state);
+  ~AllocationReporter();
+
+  // Call around code excluded with State::PauseTiming().
+  void Pause();
+  void Resume();
+
+ private:
+  benchmark::State* state_;
+  int64_t start_;
+  int64_t count_;
+  bool paused_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_BENCH_ALLOC_COUNTER_H_
@@ -0,0 +1,53 @@
+#include "bench/bench_util.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/agg_parser.h"
+#include "data_handler/data_handler_testutil.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+
+namespace pasta {
+
+std::string BenchTicker(int i) { return "B" + std::to_string(i); }
+
+std::vector<std::string> MakeFrames(int num_symbols, int aggs_per_frame,
+                                    int num_frames) {
+  std::vector<std::string> frames;
+  frames.reserve(num_frames);
+  int64_t n = 0;
+  for (int f = 0; f < num_frames; ++f) {
+    std::vector<std::string> aggs;
+    for (int a = 0; a < aggs_per_frame; ++a, ++n) {
+      const int sym = n % num_symbols;
+      const int64_t second = n / num_symbols;
+      const int64_t start = kBenchStartMillis + second * NUM_MILLIS_PER_SECOND;
+      // A slow zigzag around a per-symbol base price.
+      const double base = 2.5 + sym % 40;
+      const double open = base + 0.01 * ((second * 7 + sym) % 13);
+      const double close = base + 0.01 * ((second * 7 + sym + 7) % 13);
+      const double high = std::max(open, close) + 0.01;
+      const double low = std::min(open, close) - 0.01;
+      aggs.push_back(MakeAggProto("A", BenchTicker(sym), 100 + second % 900,
+                                  1000000 + second, base, base, open, close,
+                                  high, low, base, 50, start,
+                                  start + NUM_MILLIS_PER_SECOND));
+    }
+    frames.push_back(GetMessage(aggs));
+  }
+  return frames;
+}
+
+std::vector<AggregateData> MakeAggregates(int num_symbols, int num_seconds) {
+  const int kAggsPerFrame = 100;
+  std::vector<AggregateData> aggs;
+  for (const auto& frame :
+       MakeFrames(num_symbols, kAggsPerFrame,
+                  (int64_t{num_symbols} * num_seconds + kAggsPerFrame - 1) /
+                      kAggsPerFrame)) {
+    CHECK(ParseAggregatesWithProto(frame, &aggs).ok());
+  }
+  return aggs;
+}
+
+}  // namespace pasta
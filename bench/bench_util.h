@@ -0,0 +1,30 @@
+#ifndef PASTA_BENCH_BENCH_UTIL_H_
+#define PASTA_BENCH_BENCH_UTIL_H_
+
+#include "data_handler/agg_data.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+// 2021-01-08 10:00 in New York, within the strategy trading hours.
+constexpr int64_t kBenchStartMillis = 1610118000000;
+
+// Returns the ticker of symbol `i` of a benchmark universe.
+std::string BenchTicker(int i);
+
+// Returns `num_frames` data messages of `aggs_per_frame` one-second
+// aggregates each, built with the data_handler_testutil helpers. Aggregates
+// go round-robin over `num_symbols` tickers, so that every ticker gets one
+// aggregate per second, starting at kBenchStartMillis.
+std::vector<std::string> MakeFrames(int num_symbols, int aggs_per_frame,
+                                    int num_frames);
+
+// Returns `num_seconds` seconds worth of the aggregates of MakeFrames().
+std::vector<AggregateData> MakeAggregates(int num_symbols, int num_seconds);
+
+}  // namespace pasta
+
+#endif  // PASTA_BENCH_BENCH_UTIL_H_
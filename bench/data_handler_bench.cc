@@ -0,0 +1,68 @@
+#include "bench/alloc_counter.h"
+#include "bench/bench_util.h"
+#include "benchmark/benchmark.h"
+#include "data_handler/data_handler.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// The least number of frames replayed per data handler. Replaying them again
+// would send time backwards, so each pass gets a fresh data handler.
+constexpr int kMinFrames = 2000;
+
+// Returns a data handler that has seen the first `warmup` frames, so that
+// every symbol has its data stores.
+std::unique_ptr<DataHandler> WarmDataHandler(
+    const std::vector<std::string>& frames, int warmup) {
+  auto dh = std::make_unique<DataHandler>(nullptr);
+  for (int i = 0; i < warmup; ++i) {
+    dh->ProcessMessage(frames[i]);
+  }
+  return dh;
+}
+
+// Args: number of symbols, aggregates per frame.
+void BM_ProcessMessage(benchmark::State& state) {
+  const int num_symbols = state.range(0);
+  const int aggs_per_frame = state.range(1);
+  const int warmup = (num_symbols + aggs_per_frame - 1) / aggs_per_frame;
+  // Time at least three frames for every warm-up frame.
+  const std::vector<std::string> frames = MakeFrames(
+      num_symbols, aggs_per_frame, std::max(kMinFrames, 4 * warmup));
+  int64_t bytes = 0;
+
+  std::unique_ptr<DataHandler> dh = WarmDataHandler(frames, warmup);
+  int i = warmup;
+  AllocationReporter allocs(&state);
+  for (auto _ : state) {
+    if (i == frames.size()) {
+      state.PauseTiming();
+      allocs.Pause();
+      dh = WarmDataHandler(frames, warmup);
+      i = warmup;
+      allocs.Resume();
+      state.ResumeTiming();
+    }
+    bytes += frames[i].size();
+    dh->ProcessMessage(frames[i++]);
+  }
+  state.SetItemsProcessed(state.iterations() * aggs_per_frame);
+  state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_ProcessMessage)
+    ->ArgNames({"symbols", "aggs_per_frame"})
+    ->Args({1000, 1})
+    ->Args({1000, 20})
+    ->Args({1000, 100})
+    ->Args({10000, 100});
+
+}  // namespace
+}  // namespace pasta
+
+BENCHMARK_MAIN();
@@ -0,0 +1,46 @@
+#include "bench/alloc_counter.h"
+#include "bench/bench_util.h"
+#include "benchmark/benchmark.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/symbol_table.h"
+#include "strategy/chase_momentum_strategy.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// Arg: number of symbols.
+void BM_IsEntryPoint(benchmark::State& state) {
+  const int num_symbols = state.range(0);
+  const int kAggsPerFrame = 100;
+  // Six minutes of data, so that all timeframes have history.
+  const std::vector<std::string> frames =
+      MakeFrames(num_symbols, kAggsPerFrame, num_symbols * 360 / kAggsPerFrame);
+  DataHandler dh = DataHandler(nullptr);
+  for (const auto& frame : frames) {
+    dh.ProcessMessage(frame);
+  }
+  // Not initialized, so that it does not connect to the broker.
+  ChaseMomentumStrategy strategy(&dh);
+  std::vector<SymbolId> sym_ids;
+  for (int i = 0; i < num_symbols; ++i) {
+    sym_ids.push_back(SymbolTable::Get().Intern(BenchTicker(i)));
+  }
+
+  int i = 0;
+  AllocationReporter allocs(&state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(strategy.IsEntryPoint(sym_ids[i]));
+    if (++i == sym_ids.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsEntryPoint)->ArgName("symbols")->Arg(1000)->Arg(10000);
+
+}  // namespace
+}  // namespace pasta
+
+BENCHMARK_MAIN();
@@ -1,8 +1,9 @@
 #include "data_handler/agg_data.h"
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
 #include "glog/logging.h"
 #include "proto/data.pb.h"
 
@@ -15,7 +16,7 @@ namespace pasta {
 //=============== AggregateData ===============
 
 AggregateData::AggregateData()
-    : ticker_(""),
+    : sym_id_(kInvalidSymbolId),
       vol_(0),
       acc_vol_(0),
       day_open_(0.),
@@ -24,11 +25,15 @@ AggregateData::AggregateData()
       close_(0.),
       high_(0.),
       low_(0.),
+      open_ticks_(0),
+      close_ticks_(0),
+      high_ticks_(0),
+      low_ticks_(0),
       start_(0),
       end_(0) {}
 
 AggregateData::AggregateData(const AggregateDataProto& agg_data)
-    : ticker_(agg_data.sym()),
+    : sym_id_(SymbolTable::Get().Intern(agg_data.sym())),
       vol_(agg_data.v()),
       acc_vol_(agg_data.av()),
       day_open_(agg_data.op()),
@@ -37,65 +42,99 @@ AggregateData::AggregateData(const AggregateDataProto& agg_data)
       close_(agg_data.c()),
       high_(agg_data.h()),
       low_(agg_data.l()),
+      open_ticks_(PriceFromDouble(agg_data.o())),
+      close_ticks_(PriceFromDouble(agg_data.c())),
+      high_ticks_(PriceFromDouble(agg_data.h())),
+      low_ticks_(PriceFromDouble(agg_data.l())),
       start_(agg_data.s()),
       end_(agg_data.e()) {}
 
 bool AggregateData::operator==(const AggregateData& agg_data) const {
-  return ticker_ == agg_data.ticker_ && vol_ == agg_data.vol_ &&
+  return sym_id_ == agg_data.sym_id_ && vol_ == agg_data.vol_ &&
          acc_vol_ == agg_data.acc_vol_ && day_open_ == agg_data.day_open_ &&
          vwap_ == agg_data.vwap_ && open_ == agg_data.open_ &&
          close_ == agg_data.close_ && high_ == agg_data.high_ &&
-         low_ == agg_data.low_ && start_ == agg_data.start_ &&
+         low_ == agg_data.low_ && open_ticks_ == agg_data.open_ticks_ &&
+         close_ticks_ == agg_data.close_ticks_ &&
+         high_ticks_ == agg_data.high_ticks_ &&
+         low_ticks_ == agg_data.low_ticks_ && start_ == agg_data.start_ &&
          end_ == agg_data.end_;
 }
 
 void AggregateData::UpdateWith(const AggregateDataProto& agg_data) {
-  CHECK(ticker_ == agg_data.sym());
-  vol_ += agg_data.v();
-  acc_vol_ = agg_data.av();
-  vwap_ = agg_data.vw();
-  close_ = agg_data.c();
-  high_ = std::max(high_, agg_data.h());
-  low_ = std::min(low_, agg_data.l());
-  end_ = agg_data.e();
+  UpdateWith(AggregateData(agg_data));
+}
+
+void AggregateData::UpdateWith(const AggregateData& agg_data) {
+  CHECK(sym_id_ == agg_data.sym_id_);
+  vol_ += agg_data.vol_;
+  acc_vol_ = agg_data.acc_vol_;
+  vwap_ = agg_data.vwap_;
+  close_ = agg_data.close_;
+  high_ = std::max(high_, agg_data.high_);
+  low_ = std::min(low_, agg_data.low_);
+  close_ticks_ = agg_data.close_ticks_;
+  high_ticks_ = std::max(high_ticks_, agg_data.high_ticks_);
+  low_ticks_ = std::min(low_ticks_, agg_data.low_ticks_);
+  end_ = agg_data.end_;
+}
+
+const std::string& AggregateData::ticker() const {
+  return SymbolTable::Get().Name(sym_id_);
 }
 
 //=============== AggDataStore ===============
 
-AggDataStore::AggDataStore() : window_size_(1) {}
-AggDataStore::AggDataStore(int64_t window_size) : window_size_(window_size) {}
+AggDataStore::AggDataStore() : AggDataStore(1) {}
+
+AggDataStore::AggDataStore(int64_t window_size)
+    : window_size_(window_size),
+      capacity_(absl::GetFlag(FLAGS_agg_data_store_size)) {
+  data_.reserve(absl::GetFlag(FLAGS_symbol_table_capacity));
+}
+
+const AggDataStore::AggDataQueue& AggDataStore::GetData(SymbolId sym_id) {
+  Grow(sym_id);
+  return data_[sym_id];
+}
 
 const AggDataStore::AggDataQueue& AggDataStore::GetData(
     const std::string& ticker) {
-  return data_[ticker];
+  return GetData(SymbolTable::Get().Intern(ticker));
+}
+
+void AggDataStore::Grow(SymbolId sym_id) {
+  while (data_.size() <= sym_id) {
+    data_.emplace_back(capacity_);
+  }
 }
 
 bool AggDataStore::AddData(const AggregateDataProto& data_proto) {
   CHECK(data_proto.ev() == "A");
-  std::string ticker = data_proto.sym();
+  return AddData(AggregateData(data_proto));
+}
 
-  auto& data = data_[ticker];
-  if (data.empty() || IsNewAggregate(data_proto, data.front())) {
+bool AggDataStore::AddData(const AggregateData& agg) {
+  Grow(agg.sym_id_);
+  auto& data = data_[agg.sym_id_];
+  if (data.empty() || IsNewAggregate(agg, data.front())) {
     // Add a new aggregate window. Align timestamp.
     bool old_window_not_closed = !data.empty() && !IsClosed(data.front());
-    data.push_front(AggregateData(data_proto));
+    data.push_front(agg);
     data.front().start_ = AggWindowStart(data.front().start_);
-    if (data.size() > absl::GetFlag(FLAGS_agg_data_store_size)) {
-      data.pop_back();
-    }
     return IsClosed(data.front()) || old_window_not_closed;
   } else {
     // Update existing aggregate window with new data.
-    data.front().UpdateWith(data_proto);
+    data.front().UpdateWith(agg);
     return IsClosed(data.front());
   }
 }
 
 void AggDataStore::Clear() { data_.clear(); }
 
-bool AggDataStore::IsNewAggregate(const AggregateDataProto& data_proto,
+bool AggDataStore::IsNewAggregate(const AggregateData& data,
                                   const AggregateData& prev_agg) const {
-  return data_proto.s() - prev_agg.start_ >=
+  return data.start_ - prev_agg.start_ >=
          window_size_ * NUM_MILLIS_PER_SECOND;
 }
 
@@ -1,12 +1,14 @@
 #ifndef PASTA_DATA_HANDLER_AGG_DATA_H_
 #define PASTA_DATA_HANDLER_AGG_DATA_H_
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
+#include "data_handler/price.h"
+#include "data_handler/ring_buffer.h"
+#include "data_handler/symbol_table.h"
 #include "proto/data.pb.h"
 
-#include <deque>
 #include <string>
+#include <vector>
 
 #define NUM_MILLIS_PER_SECOND 1000
 
@@ -20,8 +22,12 @@ class AggregateData {
   bool operator==(const AggregateData& agg_data) const;
 
   void UpdateWith(const AggregateDataProto& agg_data);
+  void UpdateWith(const AggregateData& agg_data);
 
-  std::string ticker_;
+  // The ticker symbol that sym_id_ was interned from.
+  const std::string& ticker() const;
+
+  SymbolId sym_id_;
   int64_t vol_;
   int64_t acc_vol_;
   double day_open_;
@@ -30,6 +36,12 @@ class AggregateData {
   double close_;
   double high_;
   double low_;
+  // The window prices above in ticks, set along with them by both parsers.
+  // Trading decisions compare these, as they are exact.
+  Price open_ticks_;
+  Price close_ticks_;
+  Price high_ticks_;
+  Price low_ticks_;
   int64_t start_;
   int64_t end_;
 };
@@ -39,7 +51,10 @@ class AggDataStore {
   AggDataStore();
   AggDataStore(int64_t window_size);
 
-  typedef std::deque<AggregateData> AggDataQueue;
+  // Newest-first history of aggregate windows with a fixed per-ticker
+  // capacity of FLAGS_agg_data_store_size.
+  typedef RingBuffer<AggregateData> AggDataQueue;
+  const AggDataQueue& GetData(SymbolId sym_id);
   const AggDataQueue& GetData(const std::string& ticker);
 
   // Add new aggregate data to the data store.
@@ -49,12 +64,19 @@ class AggDataStore {
   // right upon creation, it does not make the return value true when the next
   // aggregate window is created.
   bool AddData(const AggregateDataProto& data_proto);
+  bool AddData(const AggregateData& data);
+
+  // The size of the aggregate window (seconds).
+  int64_t window_size() const { return window_size_; }
 
   void Clear();
 
  private:
+  // Adds empty queues up to `sym_id`.
+  void Grow(SymbolId sym_id);
+
   // Determine if the new data still belongs to the previous aggregate window.
-  bool IsNewAggregate(const AggregateDataProto& data_proto,
+  bool IsNewAggregate(const AggregateData& data,
                       const AggregateData& prev_agg) const;
 
   // Given the start ts of a piece of data, calculate the start ts of the
@@ -67,9 +89,12 @@ class AggDataStore {
   // The size of the aggregate window (seconds).
   int64_t window_size_;
 
-  // The queue storing aggregate data. New data will be added to head of queue.
-  // Old data will be popped from back of queue.
-  absl::flat_hash_map<std::string, AggDataQueue> data_;
+  // The amount of aggregate windows kept per ticker.
+  int64_t capacity_;
+
+  // The queues storing aggregate data, indexed by SymbolId. New data will be
+  // added to head of queue, overwriting the oldest data once it is full.
+  std::vector<AggDataQueue> data_;
 };
 
 }  // namespace pasta
@@ -39,6 +39,19 @@ TEST_F(AggregateDataTest, UpdateAgg) {
   EXPECT_EQ(agg, result);
 }
 
+TEST_F(AggregateDataTest, PricesInTicks) {
+  AggregateData agg(GetAggDataProtoFromString(kTestCases_1[0]));
+  EXPECT_EQ(agg.open_ticks_, 253900);
+  EXPECT_EQ(agg.close_ticks_, 254500);
+  EXPECT_EQ(agg.high_ticks_, 255700);
+  EXPECT_EQ(agg.low_ticks_, 253500);
+  agg.UpdateWith(GetAggDataProtoFromString(kTestCases_1[1]));
+  EXPECT_EQ(agg.open_ticks_, 253900);
+  EXPECT_EQ(agg.close_ticks_, 254700);
+  EXPECT_EQ(agg.high_ticks_, 255700);
+  EXPECT_EQ(agg.low_ticks_, 253000);
+}
+
 TEST_F(AggregateDataTest, UpdateWrongTicker) {
   AggregateData agg(GetAggDataProtoFromString(kTestCases_1[0]));
   ASSERT_DEATH(agg.UpdateWith(GetAggDataProtoFromString(kTestCase_2)), "");
@@ -57,12 +70,27 @@ TEST_F(AggregateDataTest, MultiSecCloseAndAlignment) {
   EXPECT_FALSE(ten_sec.AddData(GetAggDataProtoFromString(kTestCases_1[0])));
   EXPECT_TRUE(ten_sec.AddData(GetAggDataProtoFromString(kTestCases_1[1])));
   EXPECT_FALSE(ten_sec.AddData(GetAggDataProtoFromString(kTestCases_1[2])));
-  auto data = ten_sec.GetData("SPCE");
+  const auto& data = ten_sec.GetData("SPCE");
   EXPECT_EQ(data.size(), 2);
   EXPECT_EQ(data[0].start_, 1610144870000);
   EXPECT_EQ(data[1].start_, 1610144860000);
 }
 
+TEST_F(AggregateDataTest, StoreSizeIsBounded) {
+  AggregateData agg(GetAggDataProtoFromString(kTestCases_1[0]));
+  int64_t store_size = absl::GetFlag(FLAGS_agg_data_store_size);
+  for (int i = 0; i < store_size + 5; ++i) {
+    one_sec.AddData(agg);
+    agg.start_ += NUM_MILLIS_PER_SECOND;
+    agg.end_ += NUM_MILLIS_PER_SECOND;
+  }
+  const auto& data = one_sec.GetData("SPCE");
+  EXPECT_EQ(data.size(), store_size);
+  EXPECT_EQ(data.front().start_, agg.start_ - NUM_MILLIS_PER_SECOND);
+  EXPECT_EQ(data.back().start_,
+            agg.start_ - store_size * NUM_MILLIS_PER_SECOND);
+}
+
 }  // namespace
 
 }  // namespace pasta
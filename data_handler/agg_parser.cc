@@ -0,0 +1,290 @@
+#include "data_handler/agg_parser.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/charconv.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+#include "google/protobuf/util/json_util.h"
+#include "proto/data.pb.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace pasta {
+
+namespace {
+
+inline bool IsStructural(char c) {
+  switch (c) {
+    case '"':
+    case ':':
+    case ',':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case '\\':
+      return true;
+    default:
+      return false;
+  }
+}
+
+inline bool IsBlank(const char* begin, const char* end) {
+  for (; begin < end; ++begin) {
+    if (*begin != ' ' && *begin != '\n' && *begin != '\r' && *begin != '\t') {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline absl::string_view Trim(const char* begin, const char* end) {
+  while (begin < end && (*begin == ' ' || *begin == '\n' || *begin == '\r' ||
+                         *begin == '\t')) {
+    ++begin;
+  }
+  while (end > begin && (end[-1] == ' ' || end[-1] == '\n' ||
+                         end[-1] == '\r' || end[-1] == '\t')) {
+    --end;
+  }
+  return absl::string_view(begin, end - begin);
+}
+
+// Whether `str` starts like a JSON number: an optional '-', then a digit,
+// which may only be followed by another digit if it is not '0'.
+bool HasJsonNumberPrefix(absl::string_view str) {
+  if (!str.empty() && str[0] == '-') str.remove_prefix(1);
+  if (str.empty() || str[0] < '0' || str[0] > '9') return false;
+  return !(str[0] == '0' && str.size() > 1 && str[1] >= '0' && str[1] <= '9');
+}
+
+bool ParseInt(absl::string_view str, int64_t* out) {
+  if (!HasJsonNumberPrefix(str)) return false;
+  const char* p = str.data();
+  const char* end = p + str.size();
+  bool negative = *p == '-';
+  if (negative) ++p;
+  int64_t value = 0;
+  for (; p < end; ++p) {
+    if (*p < '0' || *p > '9') return false;
+    if (__builtin_mul_overflow(value, 10, &value) ||
+        __builtin_add_overflow(value, negative ? -(*p - '0') : (*p - '0'),
+                               &value)) {
+      return false;
+    }
+  }
+  *out = value;
+  return true;
+}
+
+bool ParseDouble(absl::string_view str, double* out) {
+  // absl::from_chars also accepts "inf", "nan" and leading zeros, which are
+  // not JSON.
+  if (!HasJsonNumberPrefix(str)) return false;
+  const char* end = str.data() + str.size();
+  auto result = absl::from_chars(str.data(), end, *out);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+// Parses a window price into both its double and tick fields. The ticks are
+// rounded from the double, exactly like the proto path does.
+bool ParsePrice(absl::string_view str, double* out, Price* ticks) {
+  if (!ParseDouble(str, out)) return false;
+  *ticks = PriceFromDouble(*out);
+  return true;
+}
+
+// Stores a number value into the field of `agg` named `key`. Fields that the
+// proto carries but AggregateData does not are validated and dropped.
+bool SetNumberField(absl::string_view key, absl::string_view value,
+                    AggregateData* agg) {
+  double unused_double;
+  int64_t unused_int;
+  if (key.size() == 1) {
+    switch (key[0]) {
+      case 'v':
+        return ParseInt(value, &agg->vol_);
+      case 'o':
+        return ParsePrice(value, &agg->open_, &agg->open_ticks_);
+      case 'c':
+        return ParsePrice(value, &agg->close_, &agg->close_ticks_);
+      case 'h':
+        return ParsePrice(value, &agg->high_, &agg->high_ticks_);
+      case 'l':
+        return ParsePrice(value, &agg->low_, &agg->low_ticks_);
+      case 'a':
+        return ParseDouble(value, &unused_double);
+      case 'z':
+        return ParseInt(value, &unused_int);
+      case 's':
+        return ParseInt(value, &agg->start_);
+      case 'e':
+        return ParseInt(value, &agg->end_);
+      default:
+        return false;
+    }
+  }
+  if (key == "av") return ParseInt(value, &agg->acc_vol_);
+  if (key == "op") return ParseDouble(value, &agg->day_open_);
+  if (key == "vw") return ParseDouble(value, &agg->vwap_);
+  return false;
+}
+
+}  // namespace
+
+bool AggParser::IndexStructurals(absl::string_view msg) {
+  structurals_.clear();
+  structurals_.reserve(msg.size());
+  const char* p = msg.data();
+  const uint32_t n = msg.size();
+  uint32_t i = 0;
+#if defined(__SSE2__)
+  // '[' and ']' only differ from '{' and '}' by bit 0x20, so OR-ing it in
+  // lets one compare cover both brackets.
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i comma = _mm_set1_epi8(',');
+  const __m128i open_brace = _mm_set1_epi8('{');
+  const __m128i close_brace = _mm_set1_epi8('}');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; i + 16 <= n; i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i folded = _mm_or_si128(chunk, case_bit);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash))) return false;
+    __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, colon)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, comma),
+                     _mm_or_si128(_mm_cmpeq_epi8(folded, open_brace),
+                                  _mm_cmpeq_epi8(folded, close_brace))));
+    uint32_t mask = _mm_movemask_epi8(hits);
+    while (mask) {
+      structurals_.push_back(i + __builtin_ctz(mask));
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    if (!IsStructural(p[i])) continue;
+    if (p[i] == '\\') return false;
+    structurals_.push_back(i);
+  }
+  return true;
+}
+
+absl::Status AggParser::Parse(absl::string_view msg,
+                              std::vector<AggregateData>* aggs) {
+  if (!IndexStructurals(msg)) {
+    return absl::UnimplementedError("Escaped strings are not supported.");
+  }
+
+  const char* p = msg.data();
+  const uint32_t* s = structurals_.data();
+  const size_t n = structurals_.size();
+  // Index of the next unconsumed structural character.
+  size_t i = 0;
+  // Offset of the first unconsumed byte.
+  uint32_t pos = 0;
+
+  // Consumes structural character `c` if it is next, with only whitespace
+  // in between.
+  auto consume = [&](char c) {
+    if (i >= n || p[s[i]] != c || !IsBlank(p + pos, p + s[i])) return false;
+    pos = s[i++] + 1;
+    return true;
+  };
+  // Consumes a string whose opening quote is next and returns its content.
+  // Structural characters inside the string are skipped.
+  auto consume_string = [&](absl::string_view* str) {
+    if (!consume('"')) return false;
+    while (i < n && p[s[i]] != '"') ++i;
+    if (i >= n) return false;
+    *str = absl::string_view(p + pos, s[i] - pos);
+    pos = s[i++] + 1;
+    return true;
+  };
+
+  if (!consume('[')) {
+    return absl::InvalidArgumentError("Message is not a JSON array.");
+  }
+  if (!consume(']')) {
+    do {
+      if (!consume('{')) {
+        return absl::InvalidArgumentError("Expected an aggregate object.");
+      }
+      AggregateData& agg = aggs->emplace_back();
+      bool is_agg_event = false;
+      bool has_sym = false;
+      do {
+        absl::string_view key;
+        if (!consume_string(&key) || !consume(':')) {
+          return absl::InvalidArgumentError("Expected a key.");
+        }
+        if (i < n && p[s[i]] == '"' && IsBlank(p + pos, p + s[i])) {
+          absl::string_view value;
+          if (!consume_string(&value)) {
+            return absl::InvalidArgumentError("Unterminated string.");
+          }
+          if (key == "ev") {
+            is_agg_event = value == "A";
+          } else if (key == "sym") {
+            agg.sym_id_ = SymbolTable::Get().Intern(value);
+            has_sym = true;
+          } else {
+            return absl::InvalidArgumentError(
+                absl::StrCat("Unexpected string value for key ", key, "."));
+          }
+        } else {
+          if (i >= n) return absl::InvalidArgumentError("Truncated message.");
+          if (!SetNumberField(key, Trim(p + pos, p + s[i]), &agg)) {
+            return absl::InvalidArgumentError(
+                absl::StrCat("Unexpected value for key ", key, "."));
+          }
+          pos = s[i];
+        }
+      } while (consume(','));
+      if (!consume('}')) {
+        return absl::InvalidArgumentError("Unterminated aggregate object.");
+      }
+      if (!is_agg_event) {
+        return absl::InvalidArgumentError("Not a per-second aggregate event.");
+      }
+      if (!has_sym) {
+        // The proto path interns the empty symbol instead.
+        return absl::InvalidArgumentError("Aggregate without a symbol.");
+      }
+    } while (consume(','));
+    if (!consume(']')) {
+      return absl::InvalidArgumentError("Unterminated JSON array.");
+    }
+  }
+  if (i != n || !IsBlank(p + pos, p + msg.size())) {
+    return absl::InvalidArgumentError("Trailing characters after JSON array.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParseAggregatesWithProto(absl::string_view msg,
+                                      std::vector<AggregateData>* aggs) {
+  AggregateDataResponseProto proto;
+  auto s = google::protobuf::util::JsonStringToMessage(
+      absl::StrCat("{aggs:", msg, "}"), &proto);
+  if (!s.ok()) {
+    return absl::InvalidArgumentError(s.ToString());
+  }
+  for (int i = 0; i < proto.aggs_size(); ++i) {
+    if (proto.aggs(i).ev() != "A") {
+      return absl::InvalidArgumentError("Not a per-second aggregate event.");
+    }
+    aggs->emplace_back(proto.aggs(i));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace pasta
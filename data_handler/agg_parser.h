@@ -0,0 +1,51 @@
+#ifndef PASTA_DATA_HANDLER_AGG_PARSER_H_
+#define PASTA_DATA_HANDLER_AGG_PARSER_H_
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "data_handler/agg_data.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace pasta {
+
+// Parses Polygon websocket frames, i.e. JSON arrays of per-second aggregate
+// events, straight into AggregateData without building an intermediate
+// AggregateDataResponseProto.
+//
+// Parsing happens in two stages. Stage one scans the frame 16 bytes at a time
+// with SIMD compares and records the offsets of all structural characters.
+// Stage two walks the recorded offsets and only touches the bytes of keys and
+// values. The offset index is kept between calls so that steady state parsing
+// does not allocate.
+//
+// The parser only accepts what it can parse exactly like the proto path does:
+// a flat array of "A" events with a symbol, known keys and unescaped strings.
+// Anything else is rejected, and callers are expected to fall back to
+// ParseAggregatesWithProto().
+class AggParser {
+ public:
+  AggParser() = default;
+
+  // Appends the aggregates in `msg` to `aggs`. On error, `aggs` may contain
+  // a partial result.
+  absl::Status Parse(absl::string_view msg, std::vector<AggregateData>* aggs);
+
+ private:
+  // Stage one: records the offset of every structural character in `msg`.
+  // Returns false if `msg` contains an escape character.
+  bool IndexStructurals(absl::string_view msg);
+
+  // Offsets of the structural characters of the last parsed frame.
+  std::vector<uint32_t> structurals_;
+};
+
+// The reference parser that goes through AggregateDataResponseProto. It is
+// slow but accepts everything protobuf's JSON parser accepts.
+absl::Status ParseAggregatesWithProto(absl::string_view msg,
+                                      std::vector<AggregateData>* aggs);
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_AGG_PARSER_H_
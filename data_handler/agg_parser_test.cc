@@ -0,0 +1,86 @@
+#include "data_handler/agg_parser.h"
+
+#include "absl/status/status.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/data_handler_testutil.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+class AggParserTest : public ::testing::Test {
+ protected:
+  // Parses `msg` with both parsers and expects identical results.
+  void ExpectSameAsProto(const std::string& msg) {
+    std::vector<AggregateData> expected;
+    ASSERT_TRUE(ParseAggregatesWithProto(msg, &expected).ok());
+    std::vector<AggregateData> aggs;
+    ASSERT_EQ(parser.Parse(msg, &aggs), absl::OkStatus());
+    ASSERT_EQ(aggs.size(), expected.size());
+    for (int i = 0; i < aggs.size(); ++i) {
+      EXPECT_EQ(aggs[i], expected[i]) << "Aggregate " << i << " of " << msg;
+    }
+  }
+
+  AggParser parser;
+};
+
+TEST_F(AggParserTest, SameAsProto) {
+  ExpectSameAsProto(GetMessage({kTestCases_1[0]}));
+  ExpectSameAsProto(GetMessage({kTestCases_1[1], kTestCase_2}));
+  ExpectSameAsProto(
+      GetMessage({kTestCases_1[0], kTestCases_1[1], kTestCases_1[2],
+                  kTestCase_2, kTestCase_3, kResult_1}));
+}
+
+TEST_F(AggParserTest, WhitespaceAndFieldOrder) {
+  ExpectSameAsProto(
+      " [ { \"sym\" : \"MSFT\" , \"e\" : 1610144870000 , \"ev\" : \"A\" ,\n"
+      "\t\"c\":-0.5e1, \"v\": 0, \"s\":1610144869000, \"o\": 1E2 } ]\n");
+}
+
+TEST_F(AggParserTest, ParserIsReusable) {
+  std::vector<AggregateData> aggs;
+  ASSERT_EQ(parser.Parse(GetMessage({kTestCases_1[0], kTestCase_2}), &aggs),
+            absl::OkStatus());
+  aggs.clear();
+  ASSERT_EQ(parser.Parse(GetMessage({kTestCase_3}), &aggs), absl::OkStatus());
+  ASSERT_EQ(aggs.size(), 1);
+  EXPECT_EQ(aggs[0].ticker(), "SPCE");
+  EXPECT_EQ(aggs[0].start_, 1610144880000);
+}
+
+TEST_F(AggParserTest, RejectsWhatItCannotParseExactly) {
+  std::vector<AggregateData> aggs;
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"status","status":"connected"}])", &aggs)
+                   .ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"B\"RK"}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","v":1.5}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":"1"}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","x":1}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":nan}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":-nan}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":-inf}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":007}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":-01.5}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","v":007}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X","o":-}])", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X"})", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"([{"ev":"A","sym":"X"}] x)", &aggs).ok());
+  EXPECT_FALSE(parser.Parse(R"({"ev":"A","sym":"X"})", &aggs).ok());
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      parser.Parse(R"([{"ev":"A","v":1,"s":1610144869000}])", &aggs)));
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,214 @@
+#include "data_handler/backfiller.h"
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+
+ABSL_FLAG(int, backfill_threads, 4,
+          "The number of threads fetching the bars of a gap in the data.");
+ABSL_FLAG(int, backfill_batch_size, 100,
+          "The number of tickers per request for the bars of a gap in the "
+          "data.");
+ABSL_FLAG(absl::Duration, backfill_timeout, absl::Seconds(10),
+          "How long after the data resumed the live data of gapped symbols "
+          "is held back at most for the bars of the gap.");
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kMinuteMs = 60 * NUM_MILLIS_PER_SECOND;
+
+}  // namespace
+
+Backfiller::Backfiller(
+    BarSource* source,
+    std::function<void(const AggregateData&, bool backfilled)> add)
+    : source_(source),
+      add_(std::move(add)),
+      num_gapped_(0),
+      gap_end_(0),
+      deadline_(0) {}
+
+Backfiller::~Backfiller() {
+  for (const auto& fetch : fetches_) {
+    fetch->cancelled = true;
+    absl::MutexLock lock(&fetch->mu);
+    fetch->mu.Await(absl::Condition(
+        +[](int* running) { return *running == 0; }, &fetch->running));
+  }
+}
+
+bool Backfiller::OnAggregate(const AggregateData& agg) {
+  const SymbolId sym_id = agg.sym_id_;
+  Grow(sym_id);
+  if (gap_start_[sym_id] != 0) {
+    held_[sym_id].push_back(agg);
+    return false;
+  }
+  last_end_[sym_id] = std::max(last_end_[sym_id], agg.end_);
+  return true;
+}
+
+void Backfiller::OnRestored(SymbolId sym_id, int64_t end_ms) {
+  Grow(sym_id);
+  last_end_[sym_id] = std::max(last_end_[sym_id], end_ms);
+}
+
+void Backfiller::OnGap(int64_t to_ms) {
+  if (num_gapped_ > 0) Poll(std::numeric_limits<int64_t>::max());
+  if (fetch_ != nullptr) {
+    // Its requests in flight end on their own.
+    fetch_->cancelled = true;
+    fetch_.reset();
+  }
+  // Forgets the fetches whose threads are done.
+  fetches_.erase(std::remove_if(fetches_.begin(), fetches_.end(),
+                                [](const std::shared_ptr<Fetch>& fetch) {
+                                  absl::MutexLock lock(&fetch->mu);
+                                  return fetch->running == 0;
+                                }),
+                 fetches_.end());
+
+  auto fetch = std::make_shared<Fetch>();
+  std::vector<Batch>& batches = fetch->batches;
+  const size_t batch_size =
+      std::max(absl::GetFlag(FLAGS_backfill_batch_size), 1);
+  for (SymbolId sym_id = 0; sym_id < last_end_.size(); ++sym_id) {
+    if (last_end_[sym_id] == 0 || last_end_[sym_id] >= to_ms) continue;
+    if (batches.empty() || batches.back().sym_ids.size() == batch_size) {
+      batches.emplace_back();
+      batches.back().start_ms = last_end_[sym_id];
+    }
+    Batch& batch = batches.back();
+    batch.sym_ids.push_back(sym_id);
+    batch.tickers.push_back(SymbolTable::Get().Name(sym_id));
+    batch.start_ms = std::min(batch.start_ms, last_end_[sym_id]);
+    gap_start_[sym_id] = last_end_[sym_id];
+    ++num_gapped_;
+  }
+  if (num_gapped_ == 0) return;
+  gap_end_ = to_ms;
+  deadline_ =
+      to_ms + absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_backfill_timeout));
+  LOG(INFO) << "Backfilling the gaps of " << num_gapped_ << " symbols in "
+            << batches.size() << " requests.";
+
+  fetch->end_ms = to_ms;
+  const int num_threads = std::max(
+      std::min<int>(absl::GetFlag(FLAGS_backfill_threads), batches.size()), 1);
+  {
+    absl::MutexLock lock(&fetch->mu);
+    fetch->running = num_threads;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    std::thread([source = source_, fetch]() {
+      FetchBatches(source, fetch.get());
+    }).detach();
+  }
+  fetch_ = fetch;
+  fetches_.push_back(std::move(fetch));
+}
+
+void Backfiller::Poll(int64_t now_ms) {
+  if (num_gapped_ == 0) return;
+  std::vector<size_t> fetched;
+  {
+    absl::MutexLock lock(&fetch_->mu);
+    fetched.swap(fetch_->fetched);
+  }
+  for (size_t i : fetched) {
+    Batch& batch = fetch_->batches[i];
+    if (!batch.status.ok()) {
+      LOG(WARNING) << "Could not backfill " << batch.tickers.size()
+                   << " symbols: " << batch.status;
+    }
+    std::sort(batch.bars.begin(), batch.bars.end(),
+              [](const AggregateData& a, const AggregateData& b) {
+                return a.sym_id_ != b.sym_id_ ? a.sym_id_ < b.sym_id_
+                                              : a.start_ < b.start_;
+              });
+    auto begin = batch.bars.begin();
+    for (SymbolId sym_id : batch.sym_ids) {
+      auto first = std::find_if(begin, batch.bars.end(),
+                                [sym_id](const AggregateData& bar) {
+                                  return bar.sym_id_ >= sym_id;
+                                });
+      auto last = std::find_if(first, batch.bars.end(),
+                               [sym_id](const AggregateData& bar) {
+                                 return bar.sym_id_ != sym_id;
+                               });
+      begin = last;
+      if (gap_start_[sym_id] == 0) continue;
+      Resume(sym_id, absl::MakeConstSpan(
+                         batch.bars.data() + (first - batch.bars.begin()),
+                         last - first));
+    }
+  }
+  if (num_gapped_ > 0 && now_ms >= deadline_) {
+    LOG(WARNING) << "Backfill timed out. " << num_gapped_
+                 << " symbols resume without it.";
+    fetch_->cancelled = true;
+    for (SymbolId sym_id = 0; sym_id < gap_start_.size(); ++sym_id) {
+      if (gap_start_[sym_id] != 0) Resume(sym_id, {});
+    }
+  }
+}
+
+void Backfiller::FetchBatches(BarSource* source, Fetch* fetch) {
+  while (!fetch->cancelled) {
+    const size_t i = fetch->next_batch.fetch_add(1);
+    if (i >= fetch->batches.size()) break;
+    Batch& batch = fetch->batches[i];
+    batch.status = source->GetMinuteBars(batch.tickers, batch.start_ms,
+                                         fetch->end_ms, &batch.bars);
+    absl::MutexLock lock(&fetch->mu);
+    fetch->fetched.push_back(i);
+  }
+  absl::MutexLock lock(&fetch->mu);
+  --fetch->running;
+}
+
+void Backfiller::Resume(SymbolId sym_id, absl::Span<const AggregateData> bars) {
+  std::vector<AggregateData>& held = held_[sym_id];
+  // Only whole minutes of the gap, up to the first live aggregate.
+  const int64_t end = held.empty() ? gap_end_ : held.front().start_;
+  for (const AggregateData& bar : bars) {
+    if (bar.start_ < gap_start_[sym_id] || bar.start_ + kMinuteMs > end) {
+      continue;
+    }
+    AggregateData agg = bar;
+    agg.end_ = bar.start_ + kMinuteMs;
+    agg.start_ = agg.end_ - NUM_MILLIS_PER_SECOND;
+    add_(agg, /*backfilled=*/true);
+    last_end_[sym_id] = agg.end_;
+  }
+  for (const AggregateData& agg : held) {
+    add_(agg, /*backfilled=*/false);
+    last_end_[sym_id] = std::max(last_end_[sym_id], agg.end_);
+  }
+  held.clear();
+  gap_start_[sym_id] = 0;
+  --num_gapped_;
+}
+
+void Backfiller::Grow(SymbolId sym_id) {
+  if (sym_id < last_end_.size()) return;
+  last_end_.resize(sym_id + 1, 0);
+  gap_start_.resize(sym_id + 1, 0);
+  held_.resize(sym_id + 1);
+}
+
+}  // namespace pasta
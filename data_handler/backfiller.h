@@ -0,0 +1,142 @@
+#ifndef PASTA_DATA_HANDLER_BACKFILLER_H_
+#define PASTA_DATA_HANDLER_BACKFILLER_H_
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/symbol_table.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+// Fills the gaps that a lost data connection leaves in the histories of the
+// symbols with 1m bars of a BarSource. After a gap, the live aggregates of
+// every symbol that had data before it are held back while the bars are
+// fetched on FLAGS_backfill_threads threads, in requests of
+// FLAGS_backfill_batch_size tickers. Once the bars of a symbol are in, the
+// bars within its gap and then its held aggregates are added in time order,
+// so the windows come out as if the data had never stopped. The symbols of
+// a request resume together, within FLAGS_backfill_timeout, with or without
+// bars; live data of the other symbols is not held at all.
+//
+// A bar is added as one aggregate over the last second of its minute, so
+// timeframes of a minute and longer get exact windows, and finer ones get
+// the minute at its end. The partial minutes at the edges of a gap are not
+// backfilled, as the live data has part of them.
+//
+// Requests are never waited for on the thread processing the messages: a
+// request that outlives its timeout is abandoned, and its bars dropped.
+//
+// All methods but the constructor must be called on the thread processing
+// the messages.
+class Backfiller {
+ public:
+  // `add` adds an aggregate to the data stores, with `backfilled` set for the
+  // bars of a gap, unset for the held live aggregates. `source` must outlive
+  // the backfiller.
+  Backfiller(BarSource* source,
+             std::function<void(const AggregateData&, bool backfilled)> add);
+  // Drops the requests not started yet and waits for those in flight, which
+  // use the source.
+  ~Backfiller();
+
+  Backfiller(const Backfiller&) = delete;
+  Backfiller& operator=(const Backfiller&) = delete;
+
+  // Returns whether a live aggregate can be added now, or else holds it until
+  // the backfill of its symbol.
+  bool OnAggregate(const AggregateData& agg);
+
+  // Notes that the data of `sym_id` was restored up to `end_ms` (Unix
+  // millis), e.g. from a snapshot, so that the next gap is backfilled from
+  // there.
+  void OnRestored(SymbolId sym_id, int64_t end_ms);
+
+  // Starts backfilling the gaps of the symbols that had data before the data
+  // resumed at `to_ms` (Unix millis). A backfill in progress ends first, with
+  // the bars that are in.
+  void OnGap(int64_t to_ms);
+
+  // Adds the bars and the held aggregates of the symbols whose bars are in,
+  // or all of them once FLAGS_backfill_timeout passed before `now_ms`.
+  void Poll(int64_t now_ms);
+
+  // Whether aggregates are held back.
+  bool active() const { return num_gapped_ > 0; }
+
+ private:
+  // A request for the bars of some gapped symbols.
+  struct Batch {
+    std::vector<SymbolId> sym_ids;
+    std::vector<std::string> tickers;
+    // The start of the earliest gap of the symbols.
+    int64_t start_ms;
+    std::vector<AggregateData> bars;
+    absl::Status status;
+  };
+
+  // The batches of a gap, shared with the threads fetching them, which are
+  // detached so that an abandoned fetch never blocks the messages.
+  struct Fetch {
+    std::vector<Batch> batches;
+    // When the data resumed (Unix millis).
+    int64_t end_ms;
+    // The next batch to fetch.
+    std::atomic<size_t> next_batch{0};
+    // Set once the batches are abandoned, so that no more are fetched.
+    std::atomic<bool> cancelled{false};
+
+    absl::Mutex mu;
+    // Indices of the fetched batches that are not resumed yet.
+    std::vector<size_t> fetched ABSL_GUARDED_BY(mu);
+    // The number of threads still fetching.
+    int running ABSL_GUARDED_BY(mu) = 0;
+  };
+
+  // Fetches batches of `fetch` from `source` until none is left.
+  static void FetchBatches(BarSource* source, Fetch* fetch);
+
+  // Adds the bars of `sym_id` within its gap, oldest first, and its held
+  // aggregates.
+  void Resume(SymbolId sym_id, absl::Span<const AggregateData> bars);
+
+  // Adds the per symbol state up to `sym_id`.
+  void Grow(SymbolId sym_id);
+
+  BarSource* source_;
+  std::function<void(const AggregateData&, bool)> add_;
+
+  // Indexed by SymbolId: the end of the last aggregate added, the end of
+  // the data before the gap of a gapped symbol or 0, and the aggregates
+  // held since.
+  std::vector<int64_t> last_end_;
+  std::vector<int64_t> gap_start_;
+  std::vector<std::vector<AggregateData>> held_;
+  int num_gapped_;
+
+  // When the data resumed, and until when aggregates are held (Unix millis).
+  int64_t gap_end_;
+  int64_t deadline_;
+
+  // The fetch of the last gap, and every fetch whose threads may still run.
+  std::shared_ptr<Fetch> fetch_;
+  std::vector<std::shared_ptr<Fetch>> fetches_;
+};
+
+}  // namespace pasta
+
+extern absl::Flag<int> FLAGS_backfill_threads;
+extern absl::Flag<int> FLAGS_backfill_batch_size;
+extern absl::Flag<absl::Duration> FLAGS_backfill_timeout;
+
+#endif  // PASTA_DATA_HANDLER_BACKFILLER_H_
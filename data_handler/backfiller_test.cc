@@ -0,0 +1,207 @@
+#include "data_handler/backfiller.h"
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kStart = 1610144820000;
+constexpr int64_t kMinuteMs = 60 * NUM_MILLIS_PER_SECOND;
+
+AggregateData MakeAgg(SymbolId sym_id, int64_t start, int64_t end,
+                      int64_t vol) {
+  AggregateData agg;
+  agg.sym_id_ = sym_id;
+  agg.vol_ = vol;
+  agg.start_ = start;
+  agg.end_ = end;
+  return agg;
+}
+
+// Serves a minute bar of volume 1000 for every minute of a request, once
+// released.
+class FakeBarSource : public BarSource {
+ public:
+  absl::Status GetMinuteBars(const std::vector<std::string>& tickers,
+                             int64_t start_ms, int64_t end_ms,
+                             std::vector<AggregateData>* bars) override {
+    release_.WaitForNotification();
+    {
+      absl::MutexLock lock(&mu_);
+      requests_.push_back(tickers);
+    }
+    for (const std::string& ticker : tickers) {
+      SymbolId sym_id = SymbolTable::Get().Intern(ticker);
+      for (int64_t t = start_ms - start_ms % kMinuteMs; t < end_ms;
+           t += kMinuteMs) {
+        bars->push_back(MakeAgg(sym_id, t, t + kMinuteMs, 1000));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  void Release() { release_.Notify(); }
+
+  std::vector<std::vector<std::string>> requests() {
+    absl::MutexLock lock(&mu_);
+    return requests_;
+  }
+
+ private:
+  absl::Notification release_;
+  absl::Mutex mu_;
+  std::vector<std::vector<std::string>> requests_;
+};
+
+class BackfillerTest : public ::testing::Test {
+ protected:
+  BackfillerTest()
+      : backfiller_(&source_, [this](const AggregateData& agg,
+                                     bool backfilled) {
+          added_.push_back(agg);
+          if (backfilled) ++num_backfilled_;
+        }) {}
+
+  // Offers a live aggregate of one second to the backfiller, and adds it if
+  // it is not held.
+  void Live(SymbolId sym_id, int64_t start) {
+    AggregateData agg =
+        MakeAgg(sym_id, start, start + NUM_MILLIS_PER_SECOND, 10);
+    if (backfiller_.OnAggregate(agg)) added_.push_back(agg);
+  }
+
+  FakeBarSource source_;
+  std::vector<AggregateData> added_;
+  int num_backfilled_ = 0;
+  Backfiller backfiller_;
+};
+
+TEST_F(BackfillerTest, FillsWholeMinutesOfTheGap) {
+  SymbolId gapped = SymbolTable::Get().Intern("BACKFILL_A");
+  SymbolId other = SymbolTable::Get().Intern("BACKFILL_B");
+  SymbolId fresh = SymbolTable::Get().Intern("BACKFILL_C");
+  Live(gapped, kStart + 30000);
+  Live(other, kStart + 40000);
+  // The connection was lost in the first minute and the data resumed in the
+  // fifth.
+  const int64_t resumed = kStart + 4 * kMinuteMs + 10000;
+  backfiller_.OnGap(resumed);
+  EXPECT_TRUE(backfiller_.active());
+  added_.clear();
+
+  Live(gapped, resumed);
+  Live(fresh, resumed);
+  Live(gapped, resumed + 1000);
+  // Only symbols without data before the gap are not held.
+  ASSERT_EQ(added_.size(), 1);
+  EXPECT_EQ(added_[0].sym_id_, fresh);
+  added_.clear();
+
+  backfiller_.Poll(resumed);
+  EXPECT_TRUE(added_.empty());
+  source_.Release();
+  while (backfiller_.active()) backfiller_.Poll(resumed);
+
+  // The minutes from the second to the fourth, each at its last second, then
+  // the held data.
+  std::vector<int64_t> gapped_starts;
+  for (const AggregateData& agg : added_) {
+    if (agg.sym_id_ == gapped) gapped_starts.push_back(agg.start_);
+  }
+  EXPECT_EQ(gapped_starts,
+            std::vector<int64_t>({kStart + 2 * kMinuteMs - 1000,
+                                  kStart + 3 * kMinuteMs - 1000,
+                                  kStart + 4 * kMinuteMs - 1000, resumed,
+                                  resumed + 1000}));
+  int other_bars = 0;
+  for (const AggregateData& agg : added_) {
+    if (agg.sym_id_ == other) {
+      ++other_bars;
+      EXPECT_EQ(agg.vol_, 1000);
+      EXPECT_EQ(agg.end_ - agg.start_, NUM_MILLIS_PER_SECOND);
+    }
+  }
+  EXPECT_EQ(other_bars, 3);
+  // Only the bars are marked.
+  EXPECT_EQ(num_backfilled_, 6);
+  EXPECT_EQ(source_.requests().size(), 1);
+
+  // No longer held.
+  added_.clear();
+  Live(gapped, resumed + 2000);
+  EXPECT_EQ(added_.size(), 1);
+}
+
+TEST_F(BackfillerTest, ResumesWithoutBarsAfterTimeout) {
+  SymbolId sym_id = SymbolTable::Get().Intern("BACKFILL_D");
+  Live(sym_id, kStart);
+  const int64_t resumed = kStart + 5 * kMinuteMs;
+  backfiller_.OnGap(resumed);
+  added_.clear();
+  Live(sym_id, resumed);
+  const int64_t timeout_ms =
+      absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_backfill_timeout));
+  backfiller_.Poll(resumed + timeout_ms - 1);
+  EXPECT_TRUE(added_.empty());
+  backfiller_.Poll(resumed + timeout_ms);
+  EXPECT_FALSE(backfiller_.active());
+  ASSERT_EQ(added_.size(), 1);
+  EXPECT_EQ(added_[0].start_, resumed);
+  // Lets the request finish, so that the backfiller can be destroyed.
+  source_.Release();
+}
+
+TEST_F(BackfillerTest, DoesNotWaitForTimedOutRequests) {
+  SymbolId sym_id = SymbolTable::Get().Intern("BACKFILL_F");
+  Live(sym_id, kStart);
+  const int64_t timeout_ms =
+      absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_backfill_timeout));
+  const int64_t resumed = kStart + 5 * kMinuteMs;
+  backfiller_.OnGap(resumed);
+  backfiller_.Poll(resumed + timeout_ms);
+  EXPECT_FALSE(backfiller_.active());
+
+  // The request of the first gap is still stuck, and the next gap goes on
+  // without it.
+  Live(sym_id, resumed);
+  const int64_t resumed_again = resumed + 5 * kMinuteMs;
+  backfiller_.OnGap(resumed_again);
+  EXPECT_TRUE(backfiller_.active());
+  backfiller_.Poll(resumed_again + timeout_ms);
+  EXPECT_FALSE(backfiller_.active());
+  EXPECT_EQ(num_backfilled_, 0);
+  source_.Release();
+}
+
+TEST_F(BackfillerTest, SplitsRequests) {
+  absl::SetFlag(&FLAGS_backfill_batch_size, 2);
+  for (int i = 0; i < 5; ++i) {
+    Live(SymbolTable::Get().Intern("BACKFILL_E" + std::to_string(i)), kStart);
+  }
+  source_.Release();
+  backfiller_.OnGap(kStart + 2 * kMinuteMs);
+  while (backfiller_.active()) backfiller_.Poll(kStart + 2 * kMinuteMs);
+  EXPECT_EQ(source_.requests().size(), 3);
+  absl::SetFlag(&FLAGS_backfill_batch_size, 100);
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
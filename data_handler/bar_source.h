@@ -0,0 +1,29 @@
+#ifndef PASTA_DATA_HANDLER_BAR_SOURCE_H_
+#define PASTA_DATA_HANDLER_BAR_SOURCE_H_
+
+#include "absl/status/status.h"
+#include "data_handler/agg_data.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+// A source of historical 1m bars, e.g. the REST API of a data supplier, for
+// backfilling gaps in the live data.
+class BarSource {
+ public:
+  virtual ~BarSource() = default;
+
+  // Appends the 1m bars of `tickers` that start within [start_ms, end_ms)
+  // (Unix millis) to `bars`, with the symbol and prices of AggregateData set.
+  // May be called from several threads concurrently.
+  virtual absl::Status GetMinuteBars(const std::vector<std::string>& tickers,
+                                     int64_t start_ms, int64_t end_ms,
+                                     std::vector<AggregateData>* bars) = 0;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_BAR_SOURCE_H_
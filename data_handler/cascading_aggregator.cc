@@ -0,0 +1,108 @@
+#include "data_handler/cascading_aggregator.h"
+
+#include "absl/flags/flag.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace pasta {
+
+CascadingAggregator::CascadingAggregator(
+    const std::vector<int64_t>& window_sizes, int num_partitions)
+    : window_sizes_(window_sizes),
+      num_partitions_(num_partitions),
+      cascade_order_(window_sizes.size()),
+      capacity_(absl::GetFlag(FLAGS_agg_data_store_size)) {
+  CHECK(!window_sizes.empty() && window_sizes.size() <= 32)
+      << "Between 1 and 32 timeframes are supported.";
+  CHECK(num_partitions > 0);
+  std::iota(cascade_order_.begin(), cascade_order_.end(), 0);
+  std::stable_sort(cascade_order_.begin(), cascade_order_.end(),
+                   [&window_sizes](int a, int b) {
+                     return window_sizes[a] < window_sizes[b];
+                   });
+  for (int i = 0; i < cascade_order_.size(); ++i) {
+    int64_t window_size = window_sizes[cascade_order_[i]];
+    CHECK(window_size > 0) << "Window size must be positive.";
+    window_ms_.push_back(window_size * NUM_MILLIS_PER_SECOND);
+    nested_.push_back(i > 0 && window_ms_[i] % window_ms_[i - 1] == 0);
+  }
+  data_.reserve(absl::GetFlag(FLAGS_symbol_table_capacity) / num_partitions +
+                1);
+}
+
+CascadingAggregator::SymbolData& CascadingAggregator::GetSymbolData(
+    SymbolId sym_id) {
+  size_t index = sym_id / num_partitions_;
+  while (data_.size() <= index) {
+    // Histories are not copyable, so every one is created in place.
+    SymbolData& data = data_.emplace_back();
+    for (int i = 0; i < window_sizes_.size(); ++i) {
+      data.emplace_back(capacity_);
+    }
+  }
+  return data_[index];
+}
+
+uint32_t CascadingAggregator::AddData(const AggregateData& agg) {
+  SymbolData& data = GetSymbolData(agg.sym_id_);
+  uint32_t closed = 0;
+  // Whether the aggregate opened a new window in the previous timeframe of
+  // the cascade.
+  bool new_window = true;
+  for (int i = 0; i < cascade_order_.size(); ++i) {
+    const int index = cascade_order_[i];
+    const int64_t window_ms = window_ms_[i];
+    auto& queue = data[index];
+    // A window of a nested timeframe cannot be new if the window of the finer
+    // timeframe it is a multiple of is not.
+    if ((new_window || !nested_[i]) &&
+        (queue.empty() || agg.start_ - queue.front().start_ >= window_ms)) {
+      // Add a new aggregate window. Align timestamp.
+      bool old_window_not_closed =
+          !queue.empty() &&
+          queue.front().end_ - queue.front().start_ != window_ms;
+      queue.push_front(agg);
+      AggregateData& front = queue.front();
+      front.start_ -= front.start_ % window_ms;
+      CHECK(front.end_ - front.start_ <= window_ms);
+      if (front.end_ - front.start_ == window_ms || old_window_not_closed) {
+        closed |= 1u << index;
+      }
+      new_window = true;
+    } else {
+      // Update existing aggregate window with new data.
+      AggregateData& front = queue.front();
+      front.UpdateWith(agg);
+      CHECK(front.end_ - front.start_ <= window_ms);
+      if (front.end_ - front.start_ == window_ms) {
+        closed |= 1u << index;
+      }
+      new_window = false;
+    }
+  }
+  return closed;
+}
+
+const AggDataStore::AggDataQueue& CascadingAggregator::GetData(
+    int index, SymbolId sym_id) {
+  return GetSymbolData(sym_id)[index];
+}
+
+CascadingAggregator::SymbolView CascadingAggregator::GetSymbolView(
+    SymbolId sym_id) {
+  const SymbolData& data = GetSymbolData(sym_id);
+  return SymbolView(data.data(), data.size());
+}
+
+void CascadingAggregator::Restore(int index, const AggregateData& window) {
+  DCHECK(index >= 0 && index < window_sizes_.size());
+  GetSymbolData(window.sym_id_)[index].push_front(window);
+}
+
+void CascadingAggregator::Clear() { data_.clear(); }
+
+}  // namespace pasta
@@ -0,0 +1,116 @@
+#ifndef PASTA_DATA_HANDLER_CASCADING_AGGREGATOR_H_
+#define PASTA_DATA_HANDLER_CASCADING_AGGREGATOR_H_
+
+#include "absl/container/inlined_vector.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace pasta {
+
+// Rolls aggregates into several timeframes in a single pass. It produces
+// exactly what one AggDataStore per timeframe would, but looks a symbol up
+// once for all timeframes and cascades from fine to coarse timeframes: when
+// an aggregate stays within the current window of a timeframe, it also stays
+// within the current window of every timeframe that is a multiple of it, so
+// those only get the cheap in-place update. In steady state an aggregate
+// costs about one timeframe's worth of window bookkeeping.
+//
+// Timeframes can be arbitrary. Those that are not a multiple of the next
+// finer timeframe simply do not benefit from the cascade.
+class CascadingAggregator {
+ public:
+  // A read-only view of the histories of all timeframes of a symbol. It is a
+  // pointer, so it is free to copy and reading through it costs what reading
+  // the histories does. Like the references GetData() returns, it is valid
+  // until the aggregator first sees a symbol it has no history of.
+  class SymbolView {
+   public:
+    // The history of timeframe `index`, newest window first.
+    const AggDataStore::AggDataQueue& operator[](int index) const {
+      DCHECK(index >= 0 && index < num_timeframes_);
+      return histories_[index];
+    }
+
+    int num_timeframes() const { return num_timeframes_; }
+
+   private:
+    friend class CascadingAggregator;
+
+    SymbolView(const AggDataStore::AggDataQueue* histories,
+               int num_timeframes)
+        : histories_(histories), num_timeframes_(num_timeframes) {}
+
+    const AggDataStore::AggDataQueue* histories_;
+    int num_timeframes_;
+  };
+
+  // `window_sizes` are in seconds. Timeframes are indexed in the given order.
+  // An aggregator that is one of `num_partitions` partitions of the symbol
+  // universe only gets symbols of one residue class modulo `num_partitions`,
+  // and only allocates storage for those.
+  explicit CascadingAggregator(const std::vector<int64_t>& window_sizes,
+                               int num_partitions = 1);
+
+  // Adds new aggregate data to all timeframes. Returns a bit mask whose bit i
+  // is set if AggDataStore::AddData would have returned true for timeframe i.
+  uint32_t AddData(const AggregateData& agg);
+
+  const AggDataStore::AggDataQueue& GetData(int index, SymbolId sym_id);
+
+  // Returns the histories of all timeframes of `sym_id` at once.
+  SymbolView GetSymbolView(SymbolId sym_id);
+
+  // Whether there are histories of `sym_id`, which may still be empty.
+  bool Contains(SymbolId sym_id) const {
+    return sym_id / num_partitions_ < data_.size();
+  }
+
+  // Adds `window` to timeframe `index` of its symbol as the newest window, as
+  // is. Restoring a saved history oldest first recreates it, e.g. from a
+  // snapshot.
+  void Restore(int index, const AggregateData& window);
+
+  int num_timeframes() const { return window_sizes_.size(); }
+
+  // The size of the aggregate window of timeframe `index` (seconds).
+  int64_t window_size(int index) const { return window_sizes_[index]; }
+
+  void Clear();
+
+ private:
+  static constexpr int kInlinedTimeframes = 4;
+
+  typedef absl::InlinedVector<AggDataStore::AggDataQueue, kInlinedTimeframes>
+      SymbolData;
+
+  SymbolData& GetSymbolData(SymbolId sym_id);
+
+  // Window sizes (seconds) in timeframe index order.
+  std::vector<int64_t> window_sizes_;
+
+  // Symbols are stored at index sym_id / num_partitions_.
+  int num_partitions_;
+
+  // Timeframe indices from the finest to the coarsest timeframe.
+  std::vector<int> cascade_order_;
+  // Window sizes (milliseconds) in cascade order.
+  std::vector<int64_t> window_ms_;
+  // Whether the timeframe at a cascade position is a multiple of the one
+  // before it.
+  std::vector<bool> nested_;
+
+  // The amount of aggregate windows kept per ticker and timeframe.
+  int64_t capacity_;
+
+  // The histories of all timeframes of a symbol, indexed by
+  // SymbolId / num_partitions_ and then by timeframe index.
+  std::vector<SymbolData> data_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_CASCADING_AGGREGATOR_H_
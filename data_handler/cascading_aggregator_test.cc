@@ -0,0 +1,98 @@
+#include "data_handler/cascading_aggregator.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// Feeds the same random stream into a CascadingAggregator and into one
+// AggDataStore per timeframe and expects identical results.
+void ExpectSameAsAggDataStores(const std::vector<int64_t>& window_sizes) {
+  CascadingAggregator aggregator(window_sizes);
+  std::vector<AggDataStore> stores;
+  for (int64_t window_size : window_sizes) {
+    stores.emplace_back(window_size);
+  }
+  std::vector<SymbolId> sym_ids = {SymbolTable::Get().Intern("SPCE"),
+                                   SymbolTable::Get().Intern("AAPL"),
+                                   SymbolTable::Get().Intern("GME")};
+  std::vector<int64_t> now(sym_ids.size(), 1610144868000);
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> sym_dist(0, sym_ids.size() - 1);
+  // Mostly consecutive seconds, sometimes a gap of up to 10 minutes, and
+  // sometimes data within the same second.
+  std::uniform_int_distribution<int> gap_dist(0, 99);
+  std::uniform_real_distribution<double> price_dist(10., 11.);
+  for (int n = 0; n < 20000; ++n) {
+    int s = sym_dist(rng);
+    int gap = gap_dist(rng);
+    if (gap < 5) {
+      now[s] += 100;
+    } else if (gap < 95) {
+      now[s] += NUM_MILLIS_PER_SECOND;
+    } else {
+      now[s] += (gap - 94) * 100 * NUM_MILLIS_PER_SECOND;
+    }
+    AggregateData agg;
+    agg.sym_id_ = sym_ids[s];
+    agg.vol_ = n;
+    agg.acc_vol_ = n * 10;
+    agg.open_ = price_dist(rng);
+    agg.close_ = price_dist(rng);
+    agg.high_ = std::max(agg.open_, agg.close_) + .01;
+    agg.low_ = std::min(agg.open_, agg.close_) - .01;
+    agg.vwap_ = price_dist(rng);
+    agg.start_ = now[s] - now[s] % 100;
+    agg.end_ = std::min(agg.start_ + NUM_MILLIS_PER_SECOND,
+                        agg.start_ - agg.start_ % NUM_MILLIS_PER_SECOND +
+                            NUM_MILLIS_PER_SECOND);
+
+    uint32_t closed = aggregator.AddData(agg);
+    for (int i = 0; i < stores.size(); ++i) {
+      ASSERT_EQ((closed >> i) & 1, stores[i].AddData(agg))
+          << "Timeframe " << window_sizes[i] << "s, aggregate " << n;
+    }
+  }
+
+  for (SymbolId sym_id : sym_ids) {
+    ASSERT_EQ(aggregator.GetSymbolView(sym_id).num_timeframes(),
+              window_sizes.size());
+  }
+  for (int i = 0; i < stores.size(); ++i) {
+    for (SymbolId sym_id : sym_ids) {
+      const auto& expected = stores[i].GetData(sym_id);
+      const auto& actual = aggregator.GetData(i, sym_id);
+      EXPECT_EQ(&aggregator.GetSymbolView(sym_id)[i], &actual);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(actual[j], expected[j]);
+      }
+    }
+  }
+}
+
+TEST(CascadingAggregatorTest, StandardTimeframes) {
+  ExpectSameAsAggDataStores({1, 10, 60, 300});
+}
+
+TEST(CascadingAggregatorTest, ExtraTimeframes) {
+  // Unordered, with 45s and 100s not nested in a finer timeframe.
+  ExpectSameAsAggDataStores({60, 1, 10, 300, 30, 45, 900, 100});
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include "data_handler/columnar_agg_data.h"
+
+#include "absl/flags/flag.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+
+namespace pasta {
+
+ColumnarAggDataStore::ColumnarAggDataStore(int64_t window_size,
+                                           int64_t num_slots,
+                                           int64_t max_symbols)
+    : window_ms_(window_size * NUM_MILLIS_PER_SECOND),
+      window_size_(window_size),
+      num_slots_(num_slots),
+      max_symbols_(max_symbols),
+      stride_((max_symbols * sizeof(double) + kColumnAlignment - 1) /
+              kColumnAlignment * kColumnAlignment / sizeof(double)),
+      num_symbols_(0),
+      open_(MakeColumn<double>()),
+      high_(MakeColumn<double>()),
+      low_(MakeColumn<double>()),
+      close_(MakeColumn<double>()),
+      open_ticks_(MakeColumn<Price>()),
+      close_ticks_(MakeColumn<Price>()),
+      vol_(MakeColumn<int64_t>()),
+      start_(MakeColumn<int64_t>()),
+      end_(MakeColumn<int64_t>()),
+      hits_(max_symbols) {
+  CHECK(num_slots > 0);
+  Clear();
+}
+
+ColumnarAggDataStore::ColumnarAggDataStore(int64_t window_size)
+    : ColumnarAggDataStore(window_size,
+                           absl::GetFlag(FLAGS_agg_data_store_size),
+                           absl::GetFlag(FLAGS_symbol_table_capacity)) {}
+
+template <typename T>
+ColumnarAggDataStore::Column<T> ColumnarAggDataStore::MakeColumn() const {
+  size_t size = num_slots_ * stride_;
+  T* column = static_cast<T*>(::operator new[](
+      size * sizeof(T), std::align_val_t(kColumnAlignment)));
+  std::fill(column, column + size, T());
+  return Column<T>(column);
+}
+
+size_t ColumnarAggDataStore::RowOffset(int64_t window_start) const {
+  return (window_start / window_ms_) % num_slots_ * stride_;
+}
+
+bool ColumnarAggDataStore::AddData(const AggregateData& agg) {
+  SymbolId sym = agg.sym_id_;
+  if (sym >= max_symbols_) {
+    LOG_EVERY_N(WARNING, 1000)
+        << "Symbol ID " << sym << " exceeds the " << max_symbols_
+        << " symbols the columnar store is sized for. Dropping data.";
+    return false;
+  }
+  num_symbols_ = std::max<size_t>(num_symbols_, sym + 1);
+
+  int64_t newest = newest_start_[sym];
+  if (newest < 0 || agg.start_ - newest >= window_ms_) {
+    // Add a new aggregate window. Align timestamp.
+    bool old_window_not_closed = false;
+    if (newest >= 0) {
+      size_t old = RowOffset(newest) + sym;
+      old_window_not_closed = end_[old] - start_[old] != window_ms_;
+    }
+    int64_t window_start = agg.start_ - agg.start_ % window_ms_;
+    size_t i = RowOffset(window_start) + sym;
+    open_[i] = agg.open_;
+    high_[i] = agg.high_;
+    low_[i] = agg.low_;
+    close_[i] = agg.close_;
+    open_ticks_[i] = agg.open_ticks_;
+    close_ticks_[i] = agg.close_ticks_;
+    vol_[i] = agg.vol_;
+    start_[i] = window_start;
+    end_[i] = agg.end_;
+    newest_start_[sym] = window_start;
+    return end_[i] - start_[i] == window_ms_ || old_window_not_closed;
+  } else {
+    // Update existing aggregate window with new data.
+    size_t i = RowOffset(newest) + sym;
+    vol_[i] += agg.vol_;
+    close_[i] = agg.close_;
+    close_ticks_[i] = agg.close_ticks_;
+    high_[i] = std::max(high_[i], agg.high_);
+    low_[i] = std::min(low_[i], agg.low_);
+    end_[i] = agg.end_;
+    CHECK(end_[i] - start_[i] <= window_ms_);
+    return end_[i] - start_[i] == window_ms_;
+  }
+}
+
+ColumnarAggDataStore::WindowView ColumnarAggDataStore::Window(
+    int64_t window_start) const {
+  size_t row = RowOffset(window_start);
+  return WindowView{window_start,
+                    num_symbols_,
+                    open_.get() + row,
+                    high_.get() + row,
+                    low_.get() + row,
+                    close_.get() + row,
+                    open_ticks_.get() + row,
+                    close_ticks_.get() + row,
+                    vol_.get() + row,
+                    start_.get() + row,
+                    end_.get() + row};
+}
+
+int64_t ColumnarAggDataStore::NewestWindowStart(SymbolId sym_id) const {
+  return sym_id < max_symbols_ ? newest_start_[sym_id] : -1;
+}
+
+void ColumnarAggDataStore::ScanCloseAboveOpen(
+    int64_t window_start, double ratio, std::vector<SymbolId>* sym_ids) const {
+  const int64_t prev_start = window_start - window_ms_;
+  const WindowView cur = Window(window_start);
+  const WindowView prev = Window(prev_start);
+  const size_t n = num_symbols_;
+  uint8_t* hits = hits_.data();
+  // Branch-free over contiguous columns so that the loop vectorizes.
+  for (size_t i = 0; i < n; ++i) {
+    hits[i] = (cur.start[i] == window_start) & (prev.start[i] == prev_start) &
+              (cur.close[i] > ratio * prev.open[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (hits[i]) sym_ids->push_back(i);
+  }
+}
+
+void ColumnarAggDataStore::Clear() {
+  std::fill(start_.get(), start_.get() + num_slots_ * stride_, -1);
+  newest_start_.assign(max_symbols_, -1);
+  num_symbols_ = 0;
+}
+
+}  // namespace pasta
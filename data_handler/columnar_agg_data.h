@@ -0,0 +1,127 @@
+#ifndef PASTA_DATA_HANDLER_COLUMNAR_AGG_DATA_H_
+#define PASTA_DATA_HANDLER_COLUMNAR_AGG_DATA_H_
+
+#include "data_handler/agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace pasta {
+
+// An AggDataStore backend that keeps bars in struct-of-arrays layout so that
+// whole-universe questions run as vectorized scans over contiguous memory.
+//
+// Every column is a (slot, symbol) matrix with one row per slot. Because
+// aggregate windows are aligned to the window size, the window starting at
+// `start` is stored in slot (start / window) % num_slots for every symbol,
+// so a row holds the same time window across the whole universe and a scan
+// of one window is a linear walk over a few rows. The start column tells
+// whether a symbol actually has data for the window a row currently holds.
+//
+// AddData() follows the window semantics and return value of
+// AggDataStore::AddData().
+class ColumnarAggDataStore {
+ public:
+  // Read-only view of one aggregate window across all symbols. Arrays are
+  // indexed by SymbolId and have `num_symbols` entries. Entries whose start
+  // differs from `window_start` hold stale or no data.
+  struct WindowView {
+    int64_t window_start;
+    size_t num_symbols;
+    const double* open;
+    const double* high;
+    const double* low;
+    const double* close;
+    const Price* open_ticks;
+    const Price* close_ticks;
+    const int64_t* vol;
+    const int64_t* start;
+    const int64_t* end;
+  };
+
+  // Keeps `num_slots` windows of `window_size` seconds for up to
+  // `max_symbols` symbols.
+  ColumnarAggDataStore(int64_t window_size, int64_t num_slots,
+                       int64_t max_symbols);
+  // Sized by FLAGS_agg_data_store_size and FLAGS_symbol_table_capacity.
+  explicit ColumnarAggDataStore(int64_t window_size);
+
+  ColumnarAggDataStore(const ColumnarAggDataStore&) = delete;
+  ColumnarAggDataStore& operator=(const ColumnarAggDataStore&) = delete;
+  ColumnarAggDataStore(ColumnarAggDataStore&&) = default;
+  ColumnarAggDataStore& operator=(ColumnarAggDataStore&&) = default;
+
+  // Add new aggregate data to the data store.
+  // Returns true if an aggregate window is closed. See AggDataStore::AddData.
+  bool AddData(const AggregateData& agg);
+
+  // Returns the window that starts at `window_start`.
+  WindowView Window(int64_t window_start) const;
+
+  // Returns the start of the newest window of `sym_id`, or -1 if there is
+  // none.
+  int64_t NewestWindowStart(SymbolId sym_id) const;
+
+  // Appends to `sym_ids` every symbol whose window starting at `window_start`
+  // has a close more than `ratio` times the open of its previous window.
+  void ScanCloseAboveOpen(int64_t window_start, double ratio,
+                          std::vector<SymbolId>* sym_ids) const;
+
+  int64_t window_size() const { return window_size_; }
+
+  void Clear();
+
+ private:
+  struct AlignedDeleter {
+    void operator()(void* p) const {
+      ::operator delete[](p, std::align_val_t(kColumnAlignment));
+    }
+  };
+  template <typename T>
+  using Column = std::unique_ptr<T[], AlignedDeleter>;
+
+  // Columns are cache line aligned and rows are padded to whole cache lines.
+  static constexpr size_t kColumnAlignment = 64;
+
+  template <typename T>
+  Column<T> MakeColumn() const;
+
+  // Returns the offset of the first entry of the row holding the window that
+  // starts at `window_start`.
+  size_t RowOffset(int64_t window_start) const;
+
+  // The size of the aggregate window (milliseconds).
+  int64_t window_ms_;
+  int64_t window_size_;
+  int64_t num_slots_;
+  size_t max_symbols_;
+  // The number of entries in a row, max_symbols_ rounded up to whole cache
+  // lines.
+  size_t stride_;
+  // One past the largest SymbolId added so far.
+  size_t num_symbols_;
+
+  Column<double> open_;
+  Column<double> high_;
+  Column<double> low_;
+  Column<double> close_;
+  Column<Price> open_ticks_;
+  Column<Price> close_ticks_;
+  Column<int64_t> vol_;
+  Column<int64_t> start_;
+  Column<int64_t> end_;
+
+  // Start of the newest window of each symbol, or -1.
+  std::vector<int64_t> newest_start_;
+
+  // Scratch space for ScanCloseAboveOpen().
+  mutable std::vector<uint8_t> hits_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_COLUMNAR_AGG_DATA_H_
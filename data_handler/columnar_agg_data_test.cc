@@ -0,0 +1,90 @@
+#include "data_handler/columnar_agg_data.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+AggregateData MakeAgg(const std::string& ticker, double open, double close,
+                      int64_t vol, int64_t start_sec) {
+  AggregateData agg;
+  agg.sym_id_ = SymbolTable::Get().Intern(ticker);
+  agg.open_ = open;
+  agg.close_ = close;
+  agg.open_ticks_ = PriceFromDouble(open);
+  agg.close_ticks_ = PriceFromDouble(close);
+  agg.high_ = std::max(open, close);
+  agg.low_ = std::min(open, close);
+  agg.vol_ = vol;
+  agg.start_ = start_sec * NUM_MILLIS_PER_SECOND;
+  agg.end_ = agg.start_ + NUM_MILLIS_PER_SECOND;
+  return agg;
+}
+
+class ColumnarAggDataStoreTest : public ::testing::Test {
+ protected:
+  ColumnarAggDataStore ten_sec = ColumnarAggDataStore(10, 4, 100);
+};
+
+TEST_F(ColumnarAggDataStoreTest, SameClosingAsAggDataStore) {
+  AggDataStore rows(10);
+  std::vector<AggregateData> aggs = {
+      MakeAgg("SPCE", 10, 11, 100, 1001), MakeAgg("SPCE", 11, 12, 100, 1009),
+      MakeAgg("SPCE", 12, 13, 100, 1010), MakeAgg("SPCE", 13, 14, 100, 1025),
+      MakeAgg("AAPL", 20, 21, 100, 1025), MakeAgg("SPCE", 14, 15, 100, 1026),
+      MakeAgg("SPCE", 15, 16, 100, 1029)};
+  for (const auto& agg : aggs) {
+    EXPECT_EQ(ten_sec.AddData(agg), rows.AddData(agg));
+  }
+
+  SymbolId spce = SymbolTable::Get().Find("SPCE");
+  const auto& expected = rows.GetData(spce).front();
+  ASSERT_EQ(ten_sec.NewestWindowStart(spce), expected.start_);
+  auto window = ten_sec.Window(expected.start_);
+  EXPECT_EQ(window.open[spce], expected.open_);
+  EXPECT_EQ(window.high[spce], expected.high_);
+  EXPECT_EQ(window.low[spce], expected.low_);
+  EXPECT_EQ(window.close[spce], expected.close_);
+  EXPECT_EQ(window.open_ticks[spce], expected.open_ticks_);
+  EXPECT_EQ(window.close_ticks[spce], expected.close_ticks_);
+  EXPECT_EQ(window.vol[spce], expected.vol_);
+  EXPECT_EQ(window.end[spce], expected.end_);
+}
+
+TEST_F(ColumnarAggDataStoreTest, ScanCloseAboveOpen) {
+  // Up 30% from the previous window's open.
+  ten_sec.AddData(MakeAgg("A", 10, 10.5, 100, 1000));
+  ten_sec.AddData(MakeAgg("A", 11, 13, 100, 1010));
+  // Up only 10%.
+  ten_sec.AddData(MakeAgg("B", 10, 10.5, 100, 1000));
+  ten_sec.AddData(MakeAgg("B", 10.5, 11, 100, 1010));
+  // Up 30% but the previous window is missing.
+  ten_sec.AddData(MakeAgg("C", 10, 10.5, 100, 990));
+  ten_sec.AddData(MakeAgg("C", 11, 13, 100, 1010));
+
+  std::vector<SymbolId> hits;
+  ten_sec.ScanCloseAboveOpen(1010 * NUM_MILLIS_PER_SECOND, 1.2, &hits);
+  EXPECT_EQ(hits, std::vector<SymbolId>({SymbolTable::Get().Find("A")}));
+
+  // Slots get reused once the window falls out of the history.
+  ten_sec.AddData(MakeAgg("A", 13, 14, 100, 1050));
+  hits.clear();
+  ten_sec.ScanCloseAboveOpen(1010 * NUM_MILLIS_PER_SECOND, 1.2, &hits);
+  EXPECT_TRUE(hits.empty());
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -2,18 +2,85 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "data_handler/latency_tracker.h"
+#include "data_handler/message_pipeline.h"
+#include "data_handler/recorder.h"
+#include "data_handler/subscription_set.h"
 #include "glog/logging.h"
 
+#include <algorithm>
 #include <fstream>
+#include <string>
+#include <vector>
 
+ABSL_FLAG(bool, data_client_pipeline, false,
+          "Hand data messages to a dedicated processing thread through a "
+          "lock-free ring instead of processing them on the network I/O "
+          "thread.");
+ABSL_FLAG(int64_t, data_client_ring_size, 4096,
+          "The number of messages the processing ring holds. Rounded up to a "
+          "power of two.");
+ABSL_FLAG(std::string, data_client_ring_overflow, "block",
+          "What to do with a data message when the processing ring is full. "
+          "\"block\" waits for the processing thread, pushing back on the "
+          "socket; \"drop\" drops the message.");
+ABSL_FLAG(std::string, data_client_record_dir, "",
+          "If set, every data message is recorded to a per-day record file in "
+          "this directory, for replay.");
+ABSL_FLAG(std::vector<std::string>, data_client_universe, {"*"},
+          "The tickers to subscribe to the aggregates of. \"*\" subscribes "
+          "to the whole market. The universe can be changed at runtime with "
+          "DataClient::Subscribe() and Unsubscribe().");
+ABSL_FLAG(absl::Duration, data_client_reconnect_backoff, absl::Seconds(1),
+          "How long the data client waits before reconnecting after the "
+          "connection is lost, doubling with every failed attempt. Zero "
+          "disables reconnecting, i.e. Run() returns when the connection is "
+          "lost.");
+ABSL_FLAG(absl::Duration, data_client_max_reconnect_backoff, absl::Minutes(1),
+          "The longest the data client waits between reconnection attempts.");
 ABSL_FLAG(bool, data_client_no_run, false,
           "The data client will stop running after subscribing to data "
           "supplier if this is set to true. Used for testing purpose only.");
 
 namespace pasta {
 
+namespace {
+
+// Whether a message from the data supplier is a status message, e.g. the
+// confirmation of a subscription change, rather than data.
+bool IsStatusMessage(const std::string& payload) {
+  return payload.compare(0, 15, "[{\"ev\":\"status\"") == 0;
+}
+
+}  // namespace
+
 const std::string DataClient::data_url = "wss://socket.polygon.io/stocks";
 
+DataClient::DataClient()
+    : own_loop_(std::make_unique<EventLoop>()),
+      loop_(own_loop_.get()),
+      ws_(loop_, "Data client"),
+      status_(absl::OkStatus()),
+      state_(INIT),
+      universe_(absl::GetFlag(FLAGS_data_client_universe)),
+      send_posted_(false),
+      disconnected_ms_(0),
+      gap_from_ms_(0),
+      gap_to_ms_(0) {}
+
+DataClient::DataClient(EventLoop* loop)
+    : loop_(loop),
+      ws_(loop_, "Data client"),
+      status_(absl::OkStatus()),
+      state_(INIT),
+      universe_(absl::GetFlag(FLAGS_data_client_universe)),
+      send_posted_(false),
+      disconnected_ms_(0),
+      gap_from_ms_(0),
+      gap_to_ms_(0) {}
+
 std::string DataClient::GetCredential() {
   std::string credential_str;
   credential_str = std::getenv("POLYGON_KEY");
@@ -32,6 +99,11 @@ absl::Status DataClient::RegisterFunc(
   return absl::OkStatus();
 }
 
+void DataClient::SetGapHandler(
+    std::function<void(int64_t from_ms, int64_t to_ms)> handler) {
+  gap_handler_ = std::move(handler);
+}
+
 absl::Status DataClient::UnregisterFunc(const std::string& name) {
   auto iter = reg_func_.find(name);
   if (iter == reg_func_.end()) {
@@ -42,21 +114,37 @@ absl::Status DataClient::UnregisterFunc(const std::string& name) {
   return absl::OkStatus();
 }
 
-// static
-context_ptr DataClient::OnTlsInit() {
-  // establishes a SSL connection
-  context_ptr ctx = std::make_shared<boost::asio::ssl::context>(
-      boost::asio::ssl::context::sslv23);
+void DataClient::Subscribe(const std::vector<std::string>& tickers) {
+  universe_.Add(tickers);
+  if (!send_posted_.exchange(true)) {
+    loop_->Post(std::bind(&DataClient::SendSubscriptions, this));
+  }
+}
+
+void DataClient::Unsubscribe(const std::vector<std::string>& tickers) {
+  universe_.Remove(tickers);
+  if (!send_posted_.exchange(true)) {
+    loop_->Post(std::bind(&DataClient::SendSubscriptions, this));
+  }
+}
+
+std::vector<std::string> DataClient::GetUniverse() const {
+  return universe_.Requested();
+}
 
-  try {
-    ctx->set_options(boost::asio::ssl::context::default_workarounds |
-                     boost::asio::ssl::context::no_sslv2 |
-                     boost::asio::ssl::context::no_sslv3 |
-                     boost::asio::ssl::context::single_dh_use);
-  } catch (std::exception& e) {
-    LOG(ERROR) << "Error in context pointer: " << e.what();
+void DataClient::SendSubscriptions() {
+  send_posted_ = false;
+  // Before, the universe is sent whole by the subscription of the
+  // connection.
+  if (state_ != SUBSCRIBED) return;
+  for (const std::string& msg : universe_.TakeMessages()) {
+    absl::Status s = ws_.Send(msg);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed sending data subscription message.";
+      Fail(absl::AbortedError("Failed changing the data subscription."));
+      return;
+    }
   }
-  return ctx;
 }
 
 absl::Status DataClient::Run() {
@@ -65,112 +153,217 @@ absl::Status DataClient::Run() {
     return absl::UnauthenticatedError(
         "Authentication information not provided.");
   }
-  try {
-    LOG(INFO) << "Initializing Data Client.";
-    // Set logging to be error-only
-    c_.clear_access_channels(websocketpp::log::alevel::all);
-    c_.set_error_channels(websocketpp::log::elevel::all);
-
-    // Initialize ASIO
-    c_.init_asio();
-    c_.set_tls_init_handler(bind(&DataClient::OnTlsInit));
-
-    // Register our message handler
-    c_.set_message_handler(bind(&DataClient::OnMessage, this, &c_, ::_1, ::_2));
-
-    websocketpp::lib::error_code ec;
-    client::connection_ptr con = c_.get_connection(data_url.c_str(), ec);
-    if (ec) {
-      LOG(ERROR) << "Could not create connection because: " << ec.message();
-      return absl::UnavailableError("Could not create connection because: " +
-                                    ec.message());
+  LOG(INFO) << "Initializing Data Client.";
+  status_ = absl::OkStatus();
+  state_ = INIT;
+  backoff_ = absl::GetFlag(FLAGS_data_client_reconnect_backoff);
+  disconnected_ms_ = 0;
+  ws_.SetMessageHandler(
+      std::bind(&DataClient::OnMessage, this, std::placeholders::_1));
+  ws_.SetCloseHandler(
+      std::bind(&DataClient::OnClose, this, std::placeholders::_1));
+
+  const std::string record_dir = absl::GetFlag(FLAGS_data_client_record_dir);
+  if (!record_dir.empty()) {
+    recorder_ = std::make_unique<Recorder>(record_dir);
+    absl::Status s = recorder_->Start();
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not start recording: " << s;
+      return s;
     }
+  }
 
-    // Note that connect here only requests a connection. No network messages
-    // are exchanged until the event loop starts running in the next line.
-    c_.connect(con);
+  if (absl::GetFlag(FLAGS_data_client_pipeline)) {
+    std::string overflow = absl::GetFlag(FLAGS_data_client_ring_overflow);
+    if (overflow != "block" && overflow != "drop") {
+      return absl::InvalidArgumentError("Unknown ring overflow policy: " +
+                                        overflow);
+    }
+    pipeline_ = std::make_unique<MessagePipeline>(
+        absl::GetFlag(FLAGS_data_client_ring_size),
+        overflow == "block" ? MessagePipeline::BLOCK : MessagePipeline::DROP,
+        std::bind(&DataClient::Dispatch, this, std::placeholders::_1,
+                  std::placeholders::_2));
+    pipeline_->Start();
+  }
 
-    LOG(INFO) << "Data client starts running.";
+  const absl::Duration dump_interval =
+      absl::GetFlag(FLAGS_latency_dump_interval);
+  if (dump_interval > absl::ZeroDuration()) {
+    LatencyTracker::Get().StartDumping(dump_interval);
+  }
 
-    // Start the ASIO io_service run loop
-    // this will cause a single connection to be made to the server. c.run()
-    // will exit when this connection is closed.
-    c_.run();
-  } catch (websocketpp::exception const& e) {
-    LOG(ERROR) << "Internal error: " << e.what();
-    return absl::InternalError(e.what());
+  status_ = ws_.Connect(data_url);
+  if (status_.ok()) {
+    LOG(INFO) << "Data client starts running.";
+    try {
+      // Runs until the connection is closed, along with the other connections
+      // on the loop.
+      loop_->Run();
+    } catch (websocketpp::exception const& e) {
+      LOG(ERROR) << "Internal error: " << e.what();
+      status_ = absl::InternalError(e.what());
+    }
   }
 
+  if (pipeline_ != nullptr) {
+    pipeline_->Stop();
+  }
+  if (recorder_ != nullptr) {
+    recorder_->Stop();
+  }
+  LatencyTracker::Get().StopDumping();
+  LOG(INFO) << LatencyTracker::Get().Summary();
   return status_;
 }
 
-void DataClient::OnMessage(client* c, websocketpp::connection_hdl hdl,
-                           client::message_ptr msg) {
-  websocketpp::lib::error_code ec;
+MessagePipeline::Stats DataClient::GetPipelineStats() const {
+  return pipeline_ == nullptr ? MessagePipeline::Stats{0, 0, 0, 0, 0}
+                              : pipeline_->GetStats();
+}
+
+void DataClient::Dispatch(const std::string& payload, int64_t receive_ns) {
+  if (payload.empty()) {
+    // The data resumed after a reconnect.
+    if (gap_handler_) gap_handler_(gap_from_ms_, gap_to_ms_);
+    return;
+  }
+  LatencyTracker::Get().Record(QUEUE, MonotonicNanos() - receive_ns);
+  SetCurrentMessageReceiveTime(receive_ns);
+  for (auto& name_func : reg_func_) {
+    name_func.second(payload);
+  }
+}
+
+void DataClient::Fail(const absl::Status& status) {
+  status_ = status;
+  ws_.Close();
+}
+
+void DataClient::OnClose(const absl::Status& status) {
+  // Lost, rather than closed by Close() or Fail().
+  if (status_.ok() && !status.ok() && backoff_ > absl::ZeroDuration()) {
+    LOG(WARNING) << "Data connection lost: " << status << ". Reconnecting in "
+                 << backoff_ << ".";
+    if (state_ == SUBSCRIBED && disconnected_ms_ == 0) {
+      disconnected_ms_ = absl::ToUnixMillis(absl::Now());
+    }
+    state_ = INIT;
+    loop_->RunAfter(backoff_, std::bind(&DataClient::Reconnect, this));
+    backoff_ = std::min(2 * backoff_,
+                        absl::GetFlag(FLAGS_data_client_max_reconnect_backoff));
+    return;
+  }
+  if (status_.ok()) status_ = status;
+  loop_->Stop();
+}
+
+void DataClient::Reconnect() {
+  absl::Status s = ws_.Connect(data_url);
+  if (!s.ok()) OnClose(s);
+}
+
+void DataClient::OnSubscribed() {
+  state_ = SUBSCRIBED;
+  backoff_ = absl::GetFlag(FLAGS_data_client_reconnect_backoff);
+  if (disconnected_ms_ != 0) {
+    gap_from_ms_ = disconnected_ms_;
+    gap_to_ms_ = absl::ToUnixMillis(absl::Now());
+    disconnected_ms_ = 0;
+    LOG(INFO) << "Data resumed after " << gap_to_ms_ - gap_from_ms_
+              << " ms without connection.";
+    // Marks the gap in order with the data messages.
+    std::string marker;
+    if (pipeline_ != nullptr) {
+      if (!pipeline_->Push(&marker, MonotonicNanos())) {
+        LOG(WARNING) << "Processing ring is full. Dropped the data gap.";
+      }
+    } else {
+      Dispatch(marker, MonotonicNanos());
+    }
+  }
+  // Changes of the universe made in the meantime.
+  SendSubscriptions();
+}
+
+void DataClient::OnMessage(std::string* payload) {
   DLOG(INFO) << "Data client in state: " << state_;
-  DLOG(INFO) << "Got message: " << msg->get_payload();
+  DLOG(INFO) << "Got message: " << *payload;
   switch (state_) {
     case INIT:
-      if (msg->get_payload().find("Connected Successfully") !=
-          std::string::npos) {
+      if (payload->find("Connected Successfully") != std::string::npos) {
         state_ = CONNECTED;
         LOG(INFO) << "Data client is successfully connected.";
-        c->send(
-            hdl,
-            std::string("{\"action\":\"auth\",\"params\":\"" + auth_ + "\"}"),
-            websocketpp::frame::opcode::text, ec);
-        if (ec) {
-          status_ =
-              absl::AbortedError("Failed sending authentication message.");
+        absl::Status s = ws_.Send(
+            std::string("{\"action\":\"auth\",\"params\":\"" + auth_ + "\"}"));
+        if (!s.ok()) {
           LOG(ERROR) << "Failed sending authentication message.";
-          c->stop();
+          Fail(absl::AbortedError("Failed sending authentication message."));
         }
       } else {
-        LOG(ERROR) << "Data client connection failed: " << msg->get_payload();
-        status_ =
-            absl::UnavailableError("Unexpected message: " + msg->get_payload());
-        c->stop();
+        LOG(ERROR) << "Data client connection failed: " << *payload;
+        Fail(absl::UnavailableError("Unexpected message: " + *payload));
       }
       break;
     case CONNECTED:
-      if (msg->get_payload().find("authenticated") != std::string::npos) {
+      if (payload->find("authenticated") != std::string::npos) {
         state_ = AUTHENTICATED;
         LOG(INFO) << "Data client authenticated.";
-        c->send(hdl,
-                std::string("{\"action\":\"subscribe\",\"params\":\"A.*\"}"),
-                websocketpp::frame::opcode::text, ec);
-        if (ec) {
-          LOG(ERROR) << "Failed sending data subscription message.";
-          status_ = absl::AbortedError("Failed subscribing to data supplier.");
-          c->stop();
+        // The connection starts without subscriptions.
+        universe_.Reset();
+        std::vector<std::string> msgs = universe_.TakeMessages();
+        for (const std::string& msg : msgs) {
+          absl::Status s = ws_.Send(msg);
+          if (!s.ok()) {
+            LOG(ERROR) << "Failed sending data subscription message.";
+            Fail(absl::AbortedError("Failed subscribing to data supplier."));
+            break;
+          }
+        }
+        if (msgs.empty()) {
+          LOG(INFO) << "Data client waits for a universe to subscribe to.";
+          OnSubscribed();
+          if (absl::GetFlag(FLAGS_data_client_no_run)) {
+            ws_.Close();
+          }
         }
       } else {
-        LOG(ERROR) << "Data client authentication failed: "
-                   << msg->get_payload();
-        status_ = absl::UnauthenticatedError("Unexpected message: " +
-                                             msg->get_payload());
-        c->stop();
+        LOG(ERROR) << "Data client authentication failed: " << *payload;
+        Fail(absl::UnauthenticatedError("Unexpected message: " + *payload));
       }
       break;
     case AUTHENTICATED:
-      if (msg->get_payload().find("subscribed to") != std::string::npos) {
-        state_ = SUBSCRIBED;
+      if (payload->find("subscribed to") != std::string::npos) {
         LOG(INFO) << "Data subscription succeeded.";
+        OnSubscribed();
       } else {
-        status_ =
-            absl::AbortedError("Unexpected message: " + msg->get_payload());
-        LOG(INFO) << "Data subscription failed: " << msg->get_payload();
-        c->stop();
+        LOG(INFO) << "Data subscription failed: " << *payload;
+        Fail(absl::AbortedError("Unexpected message: " + *payload));
       }
       if (absl::GetFlag(FLAGS_data_client_no_run)) {
-        c->stop();
+        ws_.Close();
       }
       break;
-    case SUBSCRIBED:
-      for (auto& name_func : reg_func_) {
-        name_func.second(msg->get_payload());
+    case SUBSCRIBED: {
+      if (IsStatusMessage(*payload)) {
+        // Confirmations of the later subscription messages.
+        LOG(INFO) << "Data supplier status: " << *payload;
+        break;
+      }
+      const int64_t receive_ns = MonotonicNanos();
+      if (recorder_ != nullptr) {
+        recorder_->Append(*payload, absl::GetCurrentTimeNanos());
+      }
+      if (pipeline_ != nullptr) {
+        if (!pipeline_->Push(payload, receive_ns)) {
+          LOG_EVERY_N(WARNING, 1000) << "Processing ring is full. Dropped "
+                                     << google::COUNTER << " messages.";
+        }
+      } else {
+        Dispatch(*payload, receive_ns);
       }
       break;
+    }
     default:
       // case NUM_CLIENT_STATE
       LOG(FATAL) << "Unknown data client state.";
@@ -4,32 +4,73 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
-
-#include <websocketpp/client.hpp>
-#include <websocketpp/config/asio_client.hpp>
-#include <websocketpp/frame.hpp>
-
-
-using websocketpp::lib::bind;
-using websocketpp::lib::placeholders::_1;
-using websocketpp::lib::placeholders::_2;
+#include "absl/time/time.h"
+#include "data_handler/event_loop.h"
+#include "data_handler/message_pipeline.h"
+#include "data_handler/recorder.h"
+#include "data_handler/subscription_set.h"
+#include "data_handler/websocket_connection.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace pasta {
 
-typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
-typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
-
 class DataClient {
  public:
-  DataClient() : status_(absl::OkStatus()), state_(INIT) {}
+  // Runs the data connection on an event loop of its own.
+  DataClient();
+  // Runs the data connection on `loop`, next to the other connections of the
+  // process, e.g. the trade update stream of the OrderTable.
+  explicit DataClient(EventLoop* loop);
 
   std::string GetCredential();
   void SetAuthentication(const std::string& auth);
   absl::Status RegisterFunc(const std::string& name,
                             std::function<void(const std::string&)> func);
   absl::Status UnregisterFunc(const std::string& name);
+
+  // Sets a function to call when data resumes after the connection was lost,
+  // with the times (Unix millis) the connection was lost and the data
+  // resumed. It is called where the registered functions are, after the
+  // messages before the gap and before those after it.
+  void SetGapHandler(
+      std::function<void(int64_t from_ms, int64_t to_ms)> handler);
+
+  // Adds tickers to or removes them from the universe of the data
+  // subscription, initially FLAGS_data_client_universe. Changes apply to the
+  // running connection without reconnecting: the changes made until the event
+  // loop gets to them are sent together, in as few messages as possible.
+  // Aggregates of removed tickers may still arrive until the data supplier
+  // processed the change. Thread-safe.
+  void Subscribe(const std::vector<std::string>& tickers);
+  void Unsubscribe(const std::vector<std::string>& tickers);
+
+  // Returns the tickers of the universe, in order.
+  std::vector<std::string> GetUniverse() const;
+
+  // Connects to the data supplier and runs the event loop until the
+  // connection is closed, then stops the loop. A lost connection is
+  // reconnected after FLAGS_data_client_reconnect_backoff, backing off
+  // exponentially, and subscribed again to the universe.
+  // If FLAGS_data_client_pipeline is set, registered functions run on a
+  // dedicated processing thread instead of the network I/O thread, so they
+  // must not be registered or unregistered while Run() is running.
+  // If FLAGS_data_client_record_dir is set, data messages are also recorded
+  // there, as they arrive. Latencies are logged every
+  // FLAGS_latency_dump_interval.
   absl::Status Run();
 
+  // Returns the counters of the processing pipeline. All zero unless
+  // FLAGS_data_client_pipeline is set.
+  MessagePipeline::Stats GetPipelineStats() const;
+
+  EventLoop* GetEventLoop() const { return loop_; }
+
  private:
   enum ClientState {
     INIT = 0,
@@ -39,15 +80,34 @@ class DataClient {
     NUM_CLIENT_STATE = 4,
   };
 
-  static context_ptr OnTlsInit();
-  void OnMessage(client* c, websocketpp::connection_hdl hdl,
-                 client::message_ptr msg);
+  void OnMessage(std::string* payload);
+  void OnClose(const absl::Status& status);
+  void Reconnect();
+
+  // Enters SUBSCRIBED, and reports a gap in the data if reconnected.
+  void OnSubscribed();
+
+  // Closes the connection with `status` as the result of Run().
+  void Fail(const absl::Status& status);
+
+  // Sends the pending changes of the universe once subscribed. Runs on the
+  // event loop.
+  void SendSubscriptions();
+
+  // Calls all registered functions with a data message received at
+  // `receive_ns` (MonotonicNanos()), or the gap handler with an empty
+  // message.
+  void Dispatch(const std::string& payload, int64_t receive_ns);
 
   // Data supplier url.
   static const std::string data_url;
 
-  // WebSocket client.
-  client c_;
+  // Set if the loop is owned.
+  std::unique_ptr<EventLoop> own_loop_;
+  EventLoop* loop_;
+
+  // WebSocket connection to the data supplier.
+  WebSocketConnection ws_;
 
   // Client status.
   absl::Status status_;
@@ -58,13 +118,43 @@ class DataClient {
   // Data client state.
   ClientState state_;
 
+  // The wait before the next reconnection attempt.
+  absl::Duration backoff_;
+  // When the subscribed connection was lost (Unix millis), or 0.
+  int64_t disconnected_ms_;
+  // The last gap in the data, read where the messages are processed.
+  std::atomic<int64_t> gap_from_ms_;
+  std::atomic<int64_t> gap_to_ms_;
+  std::function<void(int64_t, int64_t)> gap_handler_;
+
   // Functions to be called upon message.
   absl::flat_hash_map<std::string, std::function<void(const std::string&)>>
       reg_func_;
+
+  // The universe, requested and subscribed.
+  SubscriptionSet universe_;
+  // Whether SendSubscriptions() is posted to the event loop.
+  std::atomic<bool> send_posted_;
+
+  // Moves data messages off the network I/O thread. Only set while Run() is
+  // running in pipelined mode.
+  std::unique_ptr<MessagePipeline> pipeline_;
+
+  // Records data messages. Only set while Run() is running with
+  // FLAGS_data_client_record_dir.
+  std::unique_ptr<Recorder> recorder_;
 };
 
 }  // namespace pasta
 
+extern absl::Flag<bool> FLAGS_data_client_pipeline;
+extern absl::Flag<int64_t> FLAGS_data_client_ring_size;
+extern absl::Flag<std::string> FLAGS_data_client_ring_overflow;
+extern absl::Flag<std::string> FLAGS_data_client_record_dir;
+extern absl::Flag<std::vector<std::string>> FLAGS_data_client_universe;
+extern absl::Flag<absl::Duration> FLAGS_data_client_reconnect_backoff;
+extern absl::Flag<absl::Duration> FLAGS_data_client_max_reconnect_backoff;
+
 // For testing purpose only.
 extern absl::Flag<bool> FLAGS_data_client_no_run;
 
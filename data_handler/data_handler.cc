@@ -1,66 +1,582 @@
 #include "data_handler/data_handler.h"
 
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "data_handler/agg_data.h"
+#include "data_handler/agg_parser.h"
+#include "data_handler/backfiller.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/columnar_agg_data.h"
 #include "data_handler/data_client.h"
+#include "data_handler/event_bus.h"
+#include "data_handler/indicator_registry.h"
+#include "data_handler/indicators.h"
+#include "data_handler/latency_tracker.h"
+#include "data_handler/snapshot.h"
+#include "data_handler/spsc_queue.h"
+#include "data_handler/symbol_table.h"
+#include "data_handler/window_closer.h"
 #include "glog/logging.h"
-#include "google/protobuf/util/json_util.h"
-#include "proto/data.pb.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+ABSL_FLAG(bool, use_proto_parser, false,
+          "Parse aggregate messages through AggregateDataResponseProto "
+          "instead of the dedicated AggParser.");
+ABSL_FLAG(bool, columnar_agg_data_store, false,
+          "Also keep every data store in columnar layout for cross-ticker "
+          "scans.");
+ABSL_FLAG(std::vector<std::string>, extra_timeframes, {},
+          "Window sizes (seconds) of timeframes to aggregate in addition to "
+          "1s, 10s, 1m and 5m.");
+ABSL_FLAG(int, data_handler_shards, 0,
+          "The number of worker threads the symbol universe is sharded "
+          "across. 0 processes aggregates on the thread calling "
+          "ProcessMessage.");
+ABSL_FLAG(int, data_handler_shard_queue_size, 16384,
+          "The number of aggregates that can be queued for a shard before "
+          "ProcessMessage blocks.");
+ABSL_FLAG(absl::Duration, window_close_delay, absl::Seconds(1),
+          "How long after its end a window that no aggregate completed is "
+          "closed, allowing for the delivery of its last aggregate.");
+ABSL_FLAG(absl::Duration, window_close_interval, absl::Milliseconds(100),
+          "How often the event loop closes windows by the wall clock. 0 only "
+          "closes windows by data.");
+ABSL_FLAG(std::string, snapshot_path, "",
+          "The file to snapshot the histories of all timeframes to, and to "
+          "restore them from on start. Empty disables snapshots.");
+ABSL_FLAG(absl::Duration, snapshot_interval, absl::Minutes(1),
+          "How often the histories are snapshotted, in addition to on "
+          "shutdown.");
+ABSL_FLAG(absl::Duration, snapshot_max_age, absl::Hours(1),
+          "The age up to which a snapshot is restored on start. Older ones "
+          "leave too long a gap to backfill.");
 
 namespace pasta {
 
-DataHandler::DataHandler(DataClient* dc) : dc_(dc) {}
+namespace {
+
+std::vector<int64_t> Timeframes() {
+  std::vector<int64_t> window_sizes = {1, 10, 60, 300};
+  for (const auto& timeframe : absl::GetFlag(FLAGS_extra_timeframes)) {
+    int64_t window_size;
+    CHECK(absl::SimpleAtoi(timeframe, &window_size))
+        << "Invalid timeframe: " << timeframe;
+    window_sizes.push_back(window_size);
+  }
+  return window_sizes;
+}
+
+// Empty polls before a shard thread starts sleeping between polls.
+constexpr int kIdleSpins = 1000;
+
+template <typename Callback>
+absl::Status AddCallback(
+    const std::string& name, Callback cb,
+    std::vector<std::pair<std::string, Callback>>* callbacks) {
+  for (const auto& name_cb : *callbacks) {
+    if (name_cb.first == name) {
+      return absl::AlreadyExistsError("Callback name <" + name +
+                                      "> is already registered.");
+    }
+  }
+  callbacks->emplace_back(name, std::move(cb));
+  return absl::OkStatus();
+}
+
+template <typename Callback>
+absl::Status RemoveCallback(
+    const std::string& name,
+    std::vector<std::pair<std::string, Callback>>* callbacks) {
+  auto iter = std::find_if(
+      callbacks->begin(), callbacks->end(),
+      [&name](const auto& name_cb) { return name_cb.first == name; });
+  if (iter == callbacks->end()) {
+    return absl::NotFoundError("Callback name <" + name +
+                               "> is not registered.");
+  }
+  callbacks->erase(iter);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+DataHandler::Shard::Shard(int index, const std::vector<int64_t>& window_sizes,
+                          int num_shards, size_t queue_size,
+                          WindowCloser::CloseCallback on_close,
+                          WindowCloser::StaleCallback on_stale)
+    : index(index),
+      agg_data(window_sizes, num_shards),
+      indicators(&agg_data, num_shards),
+      closer(&agg_data, num_shards,
+             absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_window_close_delay)),
+             std::move(on_close), std::move(on_stale)),
+      queue(queue_size),
+      routed(0),
+      processed(0) {}
+
+DataHandler::DataHandler(DataClient* dc)
+    : dc_(dc),
+      stopping_(false),
+      last_tick_(-1),
+      next_snapshot_ms_(0),
+      started_(false),
+      clock_timer_(0),
+      clock_on_messages_(false) {
+  const std::vector<int64_t> window_sizes = Timeframes();
+  const int num_threads = absl::GetFlag(FLAGS_data_handler_shards);
+  const int num_shards = std::max(num_threads, 1);
+  for (int i = 0; i < num_shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(
+        i, window_sizes, num_shards,
+        num_threads > 0 ? absl::GetFlag(FLAGS_data_handler_shard_queue_size)
+                        : 1,
+        [this](SymbolId sym_id, int timeframe, int64_t window_start) {
+          events_.Publish(
+              Event{WINDOW_CLOSED, sym_id, timeframe, window_start});
+        },
+        [this](SymbolId sym_id) {
+          events_.Publish(Event{SYMBOL_STALE, sym_id, -1, -1});
+        }));
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    shards_[i]->thread =
+        std::thread(&DataHandler::RunShard, this, shards_[i].get());
+  }
+  if (absl::GetFlag(FLAGS_columnar_agg_data_store)) {
+    for (int64_t window_size : window_sizes) {
+      columnar_data_.emplace_back(window_size);
+    }
+  }
+  const std::string snapshot_path = absl::GetFlag(FLAGS_snapshot_path);
+  if (!snapshot_path.empty()) {
+    snapshot_ = std::make_unique<SnapshotWriter>(snapshot_path, window_sizes,
+                                                 num_shards);
+  }
+}
+
+DataHandler::~DataHandler() {
+  if (clock_timer_ != 0) {
+    {
+      // Waits for a clock tick in progress.
+      absl::MutexLock lock(&clock_target_->mu);
+      clock_target_->dh = nullptr;
+    }
+    // Cancel() is only safe on the loop thread.
+    EventLoop* loop = GetEventLoop();
+    const EventLoop::TimerId id = clock_timer_;
+    loop->Post([loop, id]() { loop->Cancel(id); });
+  }
+  // Joins the requests in flight, which add nothing anymore.
+  backfiller_.reset();
+  if (snapshot_ != nullptr && started_) {
+    // Waits for a periodic snapshot being written, so that the final one is
+    // not skipped.
+    snapshot_->Wait().IgnoreError();
+    TakeSnapshot(absl::ToUnixMillis(absl::Now()));
+    absl::Status s = snapshot_->Wait();
+    if (s.ok()) LOG(INFO) << "Wrote the final snapshot.";
+  }
+  stopping_.store(true, std::memory_order_release);
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) shard->thread.join();
+  }
+}
 
 void DataHandler::Init() {
   absl::Status s = dc_->RegisterFunc(
       "data_handler_process_message",
       std::bind(&DataHandler::ProcessMessage, this, std::placeholders::_1));
+  dc_->SetGapHandler(std::bind(&DataHandler::OnGap, this,
+                               std::placeholders::_1, std::placeholders::_2));
+
+  EventLoop* loop = GetEventLoop();
+  const absl::Duration interval = absl::GetFlag(FLAGS_window_close_interval);
+  if (loop == nullptr || interval <= absl::ZeroDuration()) return;
+  if (absl::GetFlag(FLAGS_data_client_pipeline)) {
+    // Messages are processed on the pipeline thread, not the loop thread.
+    clock_on_messages_ = true;
+  } else {
+    clock_target_ = std::make_shared<ClockTarget>();
+    {
+      absl::MutexLock lock(&clock_target_->mu);
+      clock_target_->dh = this;
+    }
+    clock_timer_ = loop->RunEvery(interval, [target = clock_target_]() {
+      absl::MutexLock lock(&target->mu);
+      if (target->dh != nullptr) {
+        target->dh->AdvanceTime(absl::ToUnixMillis(absl::Now()));
+      }
+    });
+  }
+}
+
+const AggDataStore::AggDataQueue& DataHandler::GetData(DataStoreIndex index,
+                                                       SymbolId sym_id) {
+  return ShardOf(sym_id).agg_data.GetData(index, sym_id);
 }
 
 const AggDataStore::AggDataQueue& DataHandler::GetData(
     DataStoreIndex index, const std::string& ticker) {
-  return agg_data_[index].GetData(ticker);
+  return GetData(index, SymbolTable::Get().Intern(ticker));
 }
 
-void DataHandler::ProcessMessage(const std::string& msg) {
-  AggregateDataResponseProto proto;
-  DLOG(INFO) << "Processing message " << msg;
-  auto s =
-      google::protobuf::util::JsonStringToMessage("{aggs:" + msg + "}", &proto);
-  CHECK(s.ok());
-  CHECK(proto.aggs_size() > 0);
-  for (int i = 0; i < proto.aggs_size(); ++i) {
-    AddData(proto.aggs(i));
+IndicatorId DataHandler::AddIndicator(DataStoreIndex index, IndicatorType type,
+                                      int period) {
+  // Every shard assigns the same ids, as it gets the same specs in order.
+  IndicatorId id = -1;
+  for (auto& shard : shards_) {
+    id = shard->indicators.Add(IndicatorSpec{type, index, period});
   }
+  return id;
+}
+
+double DataHandler::GetIndicator(IndicatorId id, SymbolId sym_id) const {
+  return ShardOf(sym_id).indicators.Value(id, sym_id);
+}
+
+CascadingAggregator::SymbolView DataHandler::GetSymbolView(SymbolId sym_id) {
+  return ShardOf(sym_id).agg_data.GetSymbolView(sym_id);
+}
+
+const ColumnarAggDataStore* DataHandler::GetColumnarData(
+    DataStoreIndex index) const {
+  return columnar_data_.empty() ? nullptr : &columnar_data_[index];
+}
+
+EventLoop* DataHandler::GetEventLoop() const {
+  return dc_ == nullptr ? nullptr : dc_->GetEventLoop();
+}
+
+void DataHandler::AddToUniverse(const std::vector<std::string>& tickers) {
+  if (dc_ != nullptr) dc_->Subscribe(tickers);
+}
+
+void DataHandler::RemoveFromUniverse(const std::vector<std::string>& tickers) {
+  if (dc_ != nullptr) dc_->Unsubscribe(tickers);
 }
 
-void DataHandler::AddData(const AggregateDataProto& proto) {
-  for (auto& data : agg_data_) {
-    data.AddData(proto);
+void DataHandler::SetBarSource(BarSource* source) {
+  if (source == nullptr) {
+    backfiller_.reset();
+    return;
   }
-  for (auto name_cb : strategy_cb_) {
-    name_cb.second(proto.sym());
+  backfiller_ = std::make_unique<Backfiller>(
+      source, [this](const AggregateData& agg, bool backfilled) {
+        Store(agg, CurrentMessageReceiveTime(), backfilled);
+      });
+}
+
+void DataHandler::OnGap(int64_t from_ms, int64_t to_ms) {
+  if (backfiller_ == nullptr) {
+    LOG(WARNING) << "No bar source to backfill the data from " << from_ms
+                 << " to " << to_ms << ".";
+    return;
   }
+  backfiller_->OnGap(to_ms);
 }
 
-absl::Status DataHandler::RegisterCallback(
-    const std::string& name, std::function<void(std::string)> cb) {
-  if (strategy_cb_.count(name) > 0) {
-    return absl::AlreadyExistsError("Callback name <" + name +
-                                    "> is already registered.");
+absl::Status DataHandler::LoadSnapshot(const std::string& path) {
+  started_ = true;
+  SnapshotReader reader;
+  absl::Status s = reader.Open(path);
+  if (!s.ok()) return s;
+  const CascadingAggregator& agg_data = shards_[0]->agg_data;
+  absl::Span<const int64_t> window_sizes = reader.window_sizes();
+  bool same_timeframes = window_sizes.size() == agg_data.num_timeframes();
+  for (int i = 0; same_timeframes && i < window_sizes.size(); ++i) {
+    same_timeframes = window_sizes[i] == agg_data.window_size(i);
+  }
+  if (!same_timeframes) {
+    return absl::FailedPreconditionError(path +
+                                         " is a snapshot of other timeframes.");
+  }
+  const int64_t now_ms = absl::ToUnixMillis(absl::Now());
+  const absl::Duration age =
+      absl::Milliseconds(now_ms - reader.header().taken_ms);
+  if (age > absl::GetFlag(FLAGS_snapshot_max_age)) {
+    return absl::FailedPreconditionError(
+        path + " is too old: " + absl::FormatDuration(age) + ".");
+  }
+
+  // The shards restore their symbols on their own threads, as they would
+  // race with their clock ticks otherwise.
+  SnapshotReader::Symbol symbol;
+  while (reader.Next(&symbol)) {
+    const SymbolId sym_id = SymbolTable::Get().Intern(symbol.ticker);
+    Shard& shard = ShardOf(sym_id);
+    int64_t end = 0;
+    for (int i = 0; i < symbol.windows.size(); ++i) {
+      for (const SnapshotWindow& window : symbol.windows[i]) {
+        const AggregateData agg = FromSnapshotWindow(sym_id, window);
+        shard.restored_windows.emplace_back(i, agg);
+        if (!columnar_data_.empty()) columnar_data_[i].AddData(agg);
+        end = std::max(end, window.end);
+      }
+    }
+    shard.restored_symbols.push_back(sym_id);
+    if (backfiller_ != nullptr) backfiller_->OnRestored(sym_id, end);
   }
-  strategy_cb_[name] = cb;
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      Route(shard.get(), AggregateData(), 0, kRestoreTick);
+    } else {
+      RestoreSymbols(shard.get());
+    }
+  }
+  // The histories are complete when LoadSnapshot() returns.
+  Flush();
+  LOG(INFO) << "Restored " << reader.header().num_symbols << " symbols from "
+            << path << ", taken " << absl::FormatDuration(age) << " ago.";
+  if (backfiller_ != nullptr) backfiller_->OnGap(now_ms);
   return absl::OkStatus();
 }
 
-absl::Status DataHandler::UnregisterCallback(const std::string& name) {
-  auto iter = strategy_cb_.find(name);
-  if (iter == strategy_cb_.end()) {
-    return absl::NotFoundError("Callback name <" + name +
-                               "> is not registered.");
+void DataHandler::WarmStart() {
+  started_ = true;
+  const std::string path = absl::GetFlag(FLAGS_snapshot_path);
+  if (path.empty()) return;
+  absl::Status s = LoadSnapshot(path);
+  if (!s.ok()) LOG(WARNING) << "Starting without history: " << s;
+}
+
+void DataHandler::ProcessMessage(absl::string_view msg) {
+  DLOG(INFO) << "Processing message " << msg;
+  if (!started_) WarmStart();
+  if (clock_on_messages_) AdvanceTime(absl::ToUnixMillis(absl::Now()));
+  if (backfiller_ != nullptr && backfiller_->active()) {
+    backfiller_->Poll(absl::ToUnixMillis(absl::Now()));
   }
-  strategy_cb_.erase(iter);
-  return absl::OkStatus();
+  const int64_t parse_start = MonotonicNanos();
+  aggs_.clear();
+  if (absl::GetFlag(FLAGS_use_proto_parser) ||
+      !parser_.Parse(msg, &aggs_).ok()) {
+    // Messages the dedicated parser does not handle go through the proto path.
+    aggs_.clear();
+    auto s = ParseAggregatesWithProto(msg, &aggs_);
+    CHECK(s.ok()) << s;
+  }
+  CHECK(!aggs_.empty());
+  LatencyTracker::Get().Record(PARSE, MonotonicNanos() - parse_start);
+  const int64_t receive_ns = CurrentMessageReceiveTime();
+  int64_t newest = -1;
+  for (const auto& agg : aggs_) {
+    AddData(agg, receive_ns);
+    newest = std::max(newest, agg.start_);
+  }
+  if (tick_cb_.empty()) return;
+  const int64_t second = newest - newest % NUM_MILLIS_PER_SECOND;
+  if (second > last_tick_) {
+    last_tick_ = second;
+    for (const auto& name_cb : tick_cb_) {
+      name_cb.second(second);
+    }
+  }
+}
+
+void DataHandler::Flush() {
+  for (const auto& shard : shards_) {
+    while (shard->processed.load(std::memory_order_acquire) <
+           shard->routed.load(std::memory_order_relaxed)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void DataHandler::AdvanceTime(int64_t now_ms) {
+  // Symbols resume after a backfill even without messages.
+  if (backfiller_ != nullptr && backfiller_->active()) {
+    backfiller_->Poll(now_ms);
+  }
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      Route(shard.get(), AggregateData(), 0, now_ms);
+    } else {
+      shard->closer.AdvanceTime(now_ms);
+    }
+  }
+  if (snapshot_ != nullptr && started_ && now_ms >= next_snapshot_ms_) {
+    // The first time only schedules the first snapshot.
+    if (next_snapshot_ms_ != 0) TakeSnapshot(now_ms);
+    next_snapshot_ms_ =
+        now_ms +
+        absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_snapshot_interval));
+  }
+}
+
+void DataHandler::TakeSnapshot(int64_t now_ms) {
+  if (!snapshot_->Begin(now_ms)) {
+    LOG(WARNING) << "Skipping a snapshot, as the previous one is still being "
+                    "written.";
+    return;
+  }
+  for (auto& shard : shards_) {
+    if (shard->thread.joinable()) {
+      Route(shard.get(), AggregateData(), 0, kSnapshotTick);
+    } else {
+      CopyToSnapshot(shard.get());
+    }
+  }
+}
+
+void DataHandler::CopyToSnapshot(Shard* shard) {
+  for (SymbolId sym_id = shard->index; shard->agg_data.Contains(sym_id);
+       sym_id += shards_.size()) {
+    snapshot_->AddSymbol(shard->index, sym_id,
+                         shard->agg_data.GetSymbolView(sym_id));
+  }
+  snapshot_->EndPart(shard->index);
+}
+
+void DataHandler::RestoreSymbols(Shard* shard) {
+  for (const auto& index_window : shard->restored_windows) {
+    shard->agg_data.Restore(index_window.first, index_window.second);
+  }
+  for (SymbolId sym_id : shard->restored_symbols) {
+    shard->indicators.Warm(sym_id);
+    shard->closer.OnRestored(sym_id);
+  }
+  shard->restored_windows.clear();
+  shard->restored_windows.shrink_to_fit();
+  shard->restored_symbols.clear();
+  shard->restored_symbols.shrink_to_fit();
+}
+
+void DataHandler::AddData(const AggregateData& agg, int64_t receive_ns) {
+  if (backfiller_ != nullptr && !backfiller_->OnAggregate(agg)) return;
+  Store(agg, receive_ns);
+}
+
+void DataHandler::Store(const AggregateData& agg, int64_t receive_ns,
+                        bool backfilled) {
+  for (auto& data : columnar_data_) {
+    data.AddData(agg);
+  }
+  Shard& shard = ShardOf(agg.sym_id_);
+  if (!shard.thread.joinable()) {
+    ProcessAggregate(&shard, agg, backfilled);
+    return;
+  }
+  Route(&shard, agg, receive_ns, 0, backfilled);
+}
+
+void DataHandler::Route(Shard* shard, const AggregateData& agg,
+                        int64_t receive_ns, int64_t tick_ms, bool backfilled) {
+  RoutedAggregate* slot = shard->queue.BeginPush();
+  while (slot == nullptr) {
+    // Back pressure: the shard is behind.
+    std::this_thread::yield();
+    slot = shard->queue.BeginPush();
+  }
+  slot->agg = agg;
+  slot->receive_ns = receive_ns;
+  slot->tick_ms = tick_ms;
+  slot->backfilled = backfilled;
+  shard->queue.CommitPush();
+  shard->routed.store(shard->routed.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+}
+
+void DataHandler::RunShard(Shard* shard) {
+  int idle = 0;
+  while (true) {
+    const RoutedAggregate* item = shard->queue.Front();
+    if (item == nullptr) {
+      // Check the queue once more after seeing the stop request, so that
+      // everything routed before destruction is processed.
+      if (stopping_.load(std::memory_order_acquire) &&
+          shard->queue.Front() == nullptr) {
+        return;
+      }
+      if (++idle > kIdleSpins) {
+        absl::SleepFor(absl::Microseconds(50));
+      }
+      continue;
+    }
+    idle = 0;
+    if (item->tick_ms == kSnapshotTick) {
+      CopyToSnapshot(shard);
+    } else if (item->tick_ms == kRestoreTick) {
+      RestoreSymbols(shard);
+    } else if (item->tick_ms != 0) {
+      shard->closer.AdvanceTime(item->tick_ms);
+    } else {
+      SetCurrentMessageReceiveTime(item->receive_ns);
+      ProcessAggregate(shard, item->agg, item->backfilled);
+    }
+    shard->queue.Pop();
+    shard->processed.fetch_add(1, std::memory_order_release);
+  }
+}
+
+void DataHandler::ProcessAggregate(Shard* shard, const AggregateData& agg,
+                                   bool backfilled) {
+  LatencyTracker& latency = LatencyTracker::Get();
+  const int64_t start = MonotonicNanos();
+  shard->agg_data.AddData(agg);
+  const int64_t stored = MonotonicNanos();
+  latency.Record(STORE, stored - start);
+  shard->indicators.OnAggregate(agg.sym_id_);
+  shard->closer.OnAggregate(agg.sym_id_);
+  // Backfilled bars are history, not news to trade on.
+  if (!backfilled) events_.Publish(Event{BAR_UPDATED, agg.sym_id_, -1, -1});
+  latency.Record(STRATEGY, MonotonicNanos() - stored);
+}
+
+absl::Status DataHandler::Subscribe(const std::string& name, EventType type,
+                                    SymbolId sym_id,
+                                    EventBus::Handler handler) {
+  return events_.Subscribe(name, type, sym_id, std::move(handler));
+}
+
+absl::Status DataHandler::Unsubscribe(const std::string& name) {
+  return events_.Unsubscribe(name);
+}
+
+absl::Status DataHandler::RegisterCallback(const std::string& name,
+                                           std::function<void(SymbolId)> cb) {
+  return events_.Subscribe(
+      name, BAR_UPDATED, kInvalidSymbolId,
+      [cb = std::move(cb)](const Event& event) { cb(event.sym_id); });
+}
+
+absl::Status DataHandler::UnregisterCallback(const std::string& name) {
+  return events_.Unsubscribe(name, BAR_UPDATED);
+}
+
+absl::Status DataHandler::RegisterWindowCloseCallback(const std::string& name,
+                                                      WindowCloseCallback cb) {
+  return events_.Subscribe(
+      name, WINDOW_CLOSED, kInvalidSymbolId,
+      [cb = std::move(cb)](const Event& event) {
+        cb(event.sym_id, static_cast<DataStoreIndex>(event.timeframe),
+           event.window_start);
+      });
+}
+
+absl::Status DataHandler::UnregisterWindowCloseCallback(
+    const std::string& name) {
+  return events_.Unsubscribe(name, WINDOW_CLOSED);
+}
+
+absl::Status DataHandler::RegisterTickCallback(
+    const std::string& name, std::function<void(int64_t)> cb) {
+  return AddCallback(name, std::move(cb), &tick_cb_);
+}
+
+absl::Status DataHandler::UnregisterTickCallback(const std::string& name) {
+  return RemoveCallback(name, &tick_cb_);
 }
 
 }  // namespace pasta
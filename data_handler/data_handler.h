@@ -1,15 +1,40 @@
 #ifndef PASTA_DATA_HANDLER_DATA_HANDLER_H_
 #define PASTA_DATA_HANDLER_DATA_HANDLER_H_
 
-#include "absl/container/flat_hash_map.h"
-#include "absl/container/inlined_vector.h"
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "data_handler/agg_data.h"
+#include "data_handler/agg_parser.h"
+#include "data_handler/backfiller.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/columnar_agg_data.h"
 #include "data_handler/data_client.h"
+#include "data_handler/event_bus.h"
+#include "data_handler/event_loop.h"
+#include "data_handler/indicator_registry.h"
+#include "data_handler/indicators.h"
+#include "data_handler/snapshot.h"
+#include "data_handler/spsc_queue.h"
+#include "data_handler/symbol_table.h"
+#include "data_handler/window_closer.h"
 #include "proto/data.pb.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace pasta {
 
+// Indices of the standard timeframes. Timeframes added with
+// FLAGS_extra_timeframes follow at NUM_DATA_STORE and up.
 enum DataStoreIndex {
   ONE_SEC = 0,
   TEN_SEC = 1,
@@ -18,34 +43,292 @@ enum DataStoreIndex {
   NUM_DATA_STORE = 4,
 };
 
+// With FLAGS_data_handler_shards set, the symbol universe is split into that
+// many shards, each with a worker thread that owns the timeframe state of its
+// symbols. ProcessMessage() parses on the calling thread and routes every
+// aggregate to the shard of its symbol, where the data stores are updated and
+// the events of the symbol are published. The aggregates of a symbol are thus
+// processed in order, by a single thread, without locking; handlers of
+// different symbols may run concurrently. GetData() of a symbol is only safe
+// from its shard, i.e. from within a handler for a symbol of the same shard,
+// or after Flush().
+//
+// WINDOW_CLOSED events tell once per window when it is closed, either by the
+// data of its symbol or, for symbols that stopped trading, by the wall clock
+// FLAGS_window_close_delay after its end, which also publishes SYMBOL_STALE.
+// The clock is driven by the event loop of the data client every
+// FLAGS_window_close_interval, or by the messages when the data client is
+// pipelined, and can be driven manually by AdvanceTime().
+//
+// With FLAGS_snapshot_path set, the histories of all timeframes are saved to
+// that file every FLAGS_snapshot_interval of the clock and on destruction,
+// see SnapshotWriter. The shards only copy their symbols into the snapshot,
+// between aggregates; checksumming and writing happen on a background
+// thread. The first message restores the histories from the snapshot, so a
+// restart resumes with the full history, and the gap since the snapshot is
+// backfilled given a bar source.
 class DataHandler {
  public:
   DataHandler(DataClient* dc);
+  // Writes a final snapshot, if enabled. Must be called on the thread calling
+  // ProcessMessage(), or once messages stopped. May be called while the event
+  // loop is running.
+  ~DataHandler();
 
   void Init();
 
-  void ProcessMessage(const std::string& msg);
+  void ProcessMessage(absl::string_view msg);
+
+  // Blocks until the shards have processed every aggregate routed to them.
+  void Flush();
+
+  // Closes the windows that ended FLAGS_window_close_delay before `now_ms`
+  // (Unix millis) without being closed by data, and resumes the symbols whose
+  // backfill is in. Must be called on the thread calling ProcessMessage(),
+  // with non-decreasing times.
+  void AdvanceTime(int64_t now_ms);
 
+  // The number of timeframes, including extra ones.
+  int NumTimeframes() const { return shards_[0]->agg_data.num_timeframes(); }
+
+  const AggDataStore::AggDataQueue& GetData(DataStoreIndex index,
+                                            SymbolId sym_id);
   const AggDataStore::AggDataQueue& GetData(DataStoreIndex index,
                                             const std::string& ticker);
 
+  // Returns the histories of all timeframes of `sym_id`, indexed by
+  // DataStoreIndex, without copying any. Safe where GetData() is.
+  CascadingAggregator::SymbolView GetSymbolView(SymbolId sym_id);
+
+  // Declares an indicator over the bars of timeframe `index` for every symbol,
+  // see IndicatorType, and returns its id. Declaring the same indicator again,
+  // e.g. from another strategy, returns the same id, and it is computed once.
+  // Indicators must be declared before messages are processed.
+  IndicatorId AddIndicator(DataStoreIndex index, IndicatorType type,
+                           int period);
+
+  // The current value of indicator `id` for `sym_id`, including the open bar,
+  // or NaN until there is enough data. Safe where GetData() of the symbol is.
+  double GetIndicator(IndicatorId id, SymbolId sym_id) const;
+
+  // Returns the columnar copy of a data store, or nullptr if
+  // FLAGS_columnar_agg_data_store is not set.
+  const ColumnarAggDataStore* GetColumnarData(DataStoreIndex index) const;
+
+  // Sets the source of the bars that fill the gaps a lost connection of the
+  // data client leaves, see Backfiller. `source` must outlive the handler or
+  // be removed by setting nullptr. Without one, the histories keep the gaps.
+  // Must be called while no messages are processed.
+  void SetBarSource(BarSource* source);
+
+  // Starts backfilling the gap in the data from `from_ms` to `to_ms` (Unix
+  // millis). Called by the data client, where ProcessMessage() is.
+  void OnGap(int64_t from_ms, int64_t to_ms);
+
+  // Restores the histories of all timeframes from the snapshot at `path`,
+  // unless it is older than FLAGS_snapshot_max_age or of other timeframes,
+  // and warms the indicators declared so far with them. The windows open in
+  // the snapshot close like live ones. Then backfills the gap since the
+  // snapshot, given a bar source, which publishes no BAR_UPDATED events.
+  // Must be called before messages are processed; the first message loads
+  // FLAGS_snapshot_path unless a snapshot was loaded before.
+  absl::Status LoadSnapshot(const std::string& path);
+
+  // Adds tickers to or removes them from the universe of the data client, see
+  // DataClient::Subscribe(). Does nothing without a data client.
+  void AddToUniverse(const std::vector<std::string>& tickers);
+  void RemoveFromUniverse(const std::vector<std::string>& tickers);
+
+  // Returns the event loop of the data client, for hosting other connections
+  // next to the market data, or nullptr without a data client.
+  EventLoop* GetEventLoop() const;
+
+  // Subscribes `handler` to the events of `type` of `sym_id`, or of every
+  // symbol if `sym_id` is kInvalidSymbolId. Only the handlers subscribed to
+  // an event run, so a strategy that follows a few symbols costs nothing for
+  // the others. The WINDOW_CLOSED events of an aggregate are published before
+  // its BAR_UPDATED event. Subscriptions must be made before messages are
+  // processed.
+  absl::Status Subscribe(const std::string& name, EventType type,
+                         SymbolId sym_id, EventBus::Handler handler);
+  absl::Status Unsubscribe(const std::string& name);
+
+  // Subscribes a method to call with the symbol of every live aggregate.
   absl::Status RegisterCallback(const std::string& name,
-                                std::function<void(std::string)> cb);
+                                std::function<void(SymbolId)> cb);
   absl::Status UnregisterCallback(const std::string& name);
 
+  // Subscribes a method to call with the symbol, timeframe and start of every
+  // closed window.
+  typedef std::function<void(SymbolId sym_id, DataStoreIndex index,
+                             int64_t window_start)>
+      WindowCloseCallback;
+  absl::Status RegisterWindowCloseCallback(const std::string& name,
+                                           WindowCloseCallback cb);
+  absl::Status UnregisterWindowCloseCallback(const std::string& name);
+
+  // Registers a method to call once per second of data, for scanning the
+  // whole universe instead of reacting to every aggregate. It is called with
+  // the start (Unix millis) of the second of the newest aggregate after every
+  // message that brings a newer second than before, on the thread calling
+  // ProcessMessage(), where GetColumnarData() is safe. The aggregates of a
+  // second usually come in one message, so the columnar data stores then
+  // hold the whole second. The data stores of sharded symbols may lag behind.
+  absl::Status RegisterTickCallback(const std::string& name,
+                                    std::function<void(int64_t)> cb);
+  absl::Status UnregisterTickCallback(const std::string& name);
+
  private:
-  void AddData(const AggregateDataProto& proto);
+  // The tick_ms of a RoutedAggregate telling the shard to copy its symbols
+  // into the snapshot.
+  static constexpr int64_t kSnapshotTick = -1;
+  // The tick_ms of a RoutedAggregate telling the shard to restore the windows
+  // of its symbols loaded from a snapshot.
+  static constexpr int64_t kRestoreTick = -2;
+
+  // An aggregate with the receive time of its message, or a clock tick.
+  struct RoutedAggregate {
+    AggregateData agg;
+    int64_t receive_ns;
+    // The time to advance the clock to, kSnapshotTick, kRestoreTick, or 0 for
+    // an aggregate.
+    int64_t tick_ms;
+    // Whether the aggregate is a backfilled bar.
+    bool backfilled;
+  };
+
+  // A partition of the symbol universe. Symbols with
+  // sym_id % shards_.size() == i belong to shards_[i].
+  struct Shard {
+    Shard(int index, const std::vector<int64_t>& window_sizes, int num_shards,
+          size_t queue_size, WindowCloser::CloseCallback on_close,
+          WindowCloser::StaleCallback on_stale);
+
+    const int index;
+
+    // All timeframes of the symbols of the shard, indexed by DataStoreIndex.
+    CascadingAggregator agg_data;
+    IndicatorRegistry indicators;
+    WindowCloser closer;
+
+    // Aggregates routed to the shard. Unused without a worker thread.
+    SpscQueue<RoutedAggregate> queue;
+    std::thread thread;
+
+    // The number of aggregates routed to and processed by the shard.
+    std::atomic<int64_t> routed;
+    std::atomic<int64_t> processed;
+
+    // The windows loaded from a snapshot with their timeframe index, and
+    // their symbols, until RestoreSymbols() restores them on the shard's own
+    // thread.
+    std::vector<std::pair<int, AggregateData>> restored_windows;
+    std::vector<SymbolId> restored_symbols;
+  };
+
+  // The shard owning the symbol. GetData() and GetSymbolView() take the
+  // mutable one, as the store of a shard creates the histories of a symbol on
+  // its first access.
+  Shard& ShardOf(SymbolId sym_id) {
+    return *shards_[sym_id % shards_.size()];
+  }
+  const Shard& ShardOf(SymbolId sym_id) const {
+    return *shards_[sym_id % shards_.size()];
+  }
+
+  // Adds a live aggregate, unless the backfill of its symbol holds it.
+  void AddData(const AggregateData& agg, int64_t receive_ns);
+
+  // Adds an aggregate to the columnar data stores and routes it to its shard.
+  // `backfilled` marks the bars of a gap, see ProcessAggregate().
+  void Store(const AggregateData& agg, int64_t receive_ns,
+             bool backfilled = false);
+
+  // Queues an aggregate, or a clock tick if `tick_ms` is set, for the worker
+  // thread of `shard`.
+  void Route(Shard* shard, const AggregateData& agg, int64_t receive_ns,
+             int64_t tick_ms, bool backfilled = false);
+
+  // Updates the data stores of `shard` and publishes the events. A
+  // backfilled bar publishes no BAR_UPDATED event.
+  void ProcessAggregate(Shard* shard, const AggregateData& agg,
+                        bool backfilled);
+
+  // Worker thread of a shard.
+  void RunShard(Shard* shard);
+
+  // Loads FLAGS_snapshot_path, if set, before the first message.
+  void WarmStart();
+
+  // Starts a snapshot taken at `now_ms` (Unix millis) and has every shard
+  // copy its symbols into it.
+  void TakeSnapshot(int64_t now_ms);
+  void CopyToSnapshot(Shard* shard);
+
+  // Restores the windows loaded from a snapshot into the data stores of
+  // `shard`, and warms its indicators and closer with them.
+  void RestoreSymbols(Shard* shard);
 
   DataClient* dc_;
 
-  absl::InlinedVector<AggDataStore, NUM_DATA_STORE> agg_data_ = {
-      AggDataStore(1), AggDataStore(10), AggDataStore(60), AggDataStore(300)};
+  AggParser parser_;
+
+  // Aggregates of the message being processed. Kept as a member so that its
+  // capacity is reused across messages.
+  std::vector<AggregateData> aggs_;
+
+  // A single shard without worker thread unless FLAGS_data_handler_shards is
+  // set.
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<bool> stopping_;
 
-  // Methods to call upon new data.
-  absl::flat_hash_map<std::string, std::function<void(const std::string&)>>
-      strategy_cb_;
+  // Columnar copies of the data stores for cross-ticker scans, updated on the
+  // thread calling ProcessMessage(). Empty unless
+  // FLAGS_columnar_agg_data_store is set.
+  std::vector<ColumnarAggDataStore> columnar_data_;
+
+  // Set by SetBarSource().
+  std::unique_ptr<Backfiller> backfiller_;
+
+  EventBus events_;
+  std::vector<std::pair<std::string, std::function<void(int64_t)>>> tick_cb_;
+  // The second of the last tick callbacks, or -1.
+  int64_t last_tick_;
+
+  // Writes the snapshots if FLAGS_snapshot_path is set.
+  std::unique_ptr<SnapshotWriter> snapshot_;
+  // When to take the next snapshot (Unix millis), or 0 until the clock runs.
+  int64_t next_snapshot_ms_;
+  // Whether a message was processed or a snapshot loaded. Snapshots are only
+  // taken after that, so that they never replace the one to load by an
+  // empty one.
+  bool started_;
+
+  // The handler that the clock timer advances, shared with the timer. The
+  // timer is cancelled on the loop thread, so it may outlive the handler,
+  // which then resets `dh`.
+  struct ClockTarget {
+    absl::Mutex mu;
+    DataHandler* dh ABSL_GUARDED_BY(mu);
+  };
+  std::shared_ptr<ClockTarget> clock_target_;
+  // The event loop timer driving the clock, or 0.
+  EventLoop::TimerId clock_timer_;
+  // Whether ProcessMessage() drives the clock.
+  bool clock_on_messages_;
 };
 
 }  // namespace pasta
 
+extern absl::Flag<bool> FLAGS_use_proto_parser;
+extern absl::Flag<bool> FLAGS_columnar_agg_data_store;
+extern absl::Flag<std::vector<std::string>> FLAGS_extra_timeframes;
+extern absl::Flag<int> FLAGS_data_handler_shards;
+extern absl::Flag<int> FLAGS_data_handler_shard_queue_size;
+extern absl::Flag<absl::Duration> FLAGS_window_close_delay;
+extern absl::Flag<absl::Duration> FLAGS_window_close_interval;
+extern absl::Flag<std::string> FLAGS_snapshot_path;
+extern absl::Flag<absl::Duration> FLAGS_snapshot_interval;
+extern absl::Flag<absl::Duration> FLAGS_snapshot_max_age;
+
 #endif  // PASTA_DATA_HANDLER_DATA_HANDLER_H_
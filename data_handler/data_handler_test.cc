@@ -1,10 +1,25 @@
 #include "data_handler/data_handler.h"
 
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/bar_source.h"
+#include "data_handler/data_client.h"
 #include "data_handler/data_handler_testutil.h"
+#include "data_handler/event_loop.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 namespace pasta {
 
 namespace {
@@ -18,7 +33,7 @@ TEST_F(DataHandlerTest, CallbackCount) {
   int cb_count = 0;
   EXPECT_EQ(
       dh.RegisterCallback("count_callback",
-                          [&cb_count](std::string ticker) { ++cb_count; }),
+                          [&cb_count](SymbolId sym_id) { ++cb_count; }),
       absl::OkStatus());
 
   dh.ProcessMessage(GetMessage({kTestCases_1[0]}));
@@ -28,6 +43,419 @@ TEST_F(DataHandlerTest, CallbackCount) {
   EXPECT_EQ(cb_count, 4);
 }
 
+// Messages with one aggregate per second for each of `num_tickers` tickers,
+// from `start` (Unix millis) on.
+std::vector<std::string> MakeMessages(int num_tickers, int num_seconds,
+                                      int64_t start = 1610144868000) {
+  std::vector<std::string> msgs;
+  for (int t = 0; t < num_seconds; ++t) {
+    std::vector<std::string> aggs;
+    for (int i = 0; i < num_tickers; ++i) {
+      double price = 10. + i + t * 0.01;
+      int64_t s = start + t * 1000;
+      aggs.push_back(MakeAggProto("A", "SHARD" + std::to_string(i), 100 + t,
+                                  1000, price, price, price, price + 0.01,
+                                  price + 0.02, price - 0.02, price, 50, s,
+                                  s + 1000));
+    }
+    msgs.push_back(GetMessage(aggs));
+  }
+  return msgs;
+}
+
+TEST(ShardedDataHandlerTest, SameDataAsInline) {
+  const int kNumTickers = 37;
+  const int kNumSeconds = 120;
+  std::vector<std::string> msgs = MakeMessages(kNumTickers, kNumSeconds);
+
+  DataHandler inline_dh = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_data_handler_shards, 4);
+  absl::SetFlag(&FLAGS_data_handler_shard_queue_size, 8);
+  DataHandler sharded_dh = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_data_handler_shards, 0);
+
+  std::mutex mu;
+  std::map<SymbolId, std::set<std::thread::id>> threads;
+  std::map<SymbolId, int64_t> last_end;
+  std::atomic<int> cb_count(0);
+  ASSERT_EQ(
+      sharded_dh.RegisterCallback(
+          "record_thread",
+          [&](SymbolId sym_id) {
+            ++cb_count;
+            // The data of the own symbol is safe to read from a callback.
+            int64_t end = sharded_dh.GetData(ONE_SEC, sym_id).front().end_;
+            std::lock_guard<std::mutex> lock(mu);
+            threads[sym_id].insert(std::this_thread::get_id());
+            // Aggregates of a symbol are processed in order.
+            EXPECT_GT(end, last_end[sym_id]);
+            last_end[sym_id] = end;
+          }),
+      absl::OkStatus());
+
+  for (const auto& msg : msgs) {
+    inline_dh.ProcessMessage(msg);
+    sharded_dh.ProcessMessage(msg);
+  }
+  sharded_dh.Flush();
+
+  EXPECT_EQ(cb_count, kNumTickers * kNumSeconds);
+  for (int i = 0; i < kNumTickers; ++i) {
+    std::string ticker = "SHARD" + std::to_string(i);
+    SymbolId sym_id = SymbolTable::Get().Intern(ticker);
+    // All aggregates of a symbol are processed by the same worker thread.
+    ASSERT_EQ(threads[sym_id].size(), 1);
+    EXPECT_NE(*threads[sym_id].begin(), std::this_thread::get_id());
+    for (int index = 0; index < NUM_DATA_STORE; ++index) {
+      const auto& expected =
+          inline_dh.GetData(static_cast<DataStoreIndex>(index), ticker);
+      const auto& actual =
+          sharded_dh.GetData(static_cast<DataStoreIndex>(index), ticker);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(actual[j].start_, expected[j].start_);
+        EXPECT_EQ(actual[j].end_, expected[j].end_);
+        EXPECT_EQ(actual[j].vol_, expected[j].vol_);
+        EXPECT_EQ(actual[j].open_, expected[j].open_);
+        EXPECT_EQ(actual[j].close_, expected[j].close_);
+        EXPECT_EQ(actual[j].high_, expected[j].high_);
+        EXPECT_EQ(actual[j].low_, expected[j].low_);
+      }
+    }
+  }
+}
+
+TEST(WindowCloseTest, ClosesWindowsOfSilentSymbolsByTime) {
+  const int kNumTickers = 37;
+  const int kNumSeconds = 15;
+  std::vector<std::string> msgs = MakeMessages(kNumTickers, kNumSeconds);
+  // The data ends within the 10s window at 1610144880000, the 1m window at
+  // 1610144880000 and the 5m window at 1610144700000.
+  const int64_t kFiveMinEnd = 1610145000000;
+  const int64_t delay_ms =
+      absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_window_close_delay));
+
+  absl::SetFlag(&FLAGS_data_handler_shards, 4);
+  DataHandler sharded_dh = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_data_handler_shards, 0);
+  DataHandler inline_dh = DataHandler(nullptr);
+
+  for (DataHandler* dh : {&inline_dh, &sharded_dh}) {
+    std::mutex mu;
+    // Window starts by symbol and timeframe.
+    std::map<SymbolId, std::map<int, std::vector<int64_t>>> closed;
+    ASSERT_EQ(dh->RegisterWindowCloseCallback(
+                  "record_close",
+                  [&](SymbolId sym_id, DataStoreIndex index,
+                      int64_t window_start) {
+                    std::lock_guard<std::mutex> lock(mu);
+                    closed[sym_id][index].push_back(window_start);
+                  }),
+              absl::OkStatus());
+
+    dh->AdvanceTime(1610144868000);
+    for (const auto& msg : msgs) {
+      dh->ProcessMessage(msg);
+    }
+    dh->Flush();
+    SymbolId sym_id = SymbolTable::Get().Intern("SHARD0");
+    // Closed by data.
+    EXPECT_EQ(closed[sym_id][ONE_SEC].size(), kNumSeconds);
+    EXPECT_EQ(closed[sym_id][TEN_SEC],
+              std::vector<int64_t>({1610144860000, 1610144870000}));
+    EXPECT_EQ(closed[sym_id][ONE_MIN],
+              std::vector<int64_t>({1610144820000}));
+    EXPECT_TRUE(closed[sym_id][FIVE_MIN].empty());
+
+    dh->AdvanceTime(kFiveMinEnd + delay_ms - 1);
+    dh->Flush();
+    EXPECT_EQ(closed[sym_id][TEN_SEC].back(), 1610144880000);
+    EXPECT_EQ(closed[sym_id][ONE_MIN].back(), 1610144880000);
+    EXPECT_TRUE(closed[sym_id][FIVE_MIN].empty());
+
+    dh->AdvanceTime(kFiveMinEnd + delay_ms);
+    dh->Flush();
+    for (int i = 0; i < kNumTickers; ++i) {
+      SymbolId sym_id = SymbolTable::Get().Intern("SHARD" + std::to_string(i));
+      EXPECT_EQ(closed[sym_id][TEN_SEC].size(), 3);
+      EXPECT_EQ(closed[sym_id][ONE_MIN].size(), 2);
+      EXPECT_EQ(closed[sym_id][FIVE_MIN],
+                std::vector<int64_t>({1610144700000}));
+    }
+    EXPECT_EQ(dh->UnregisterWindowCloseCallback("record_close"),
+              absl::OkStatus());
+  }
+}
+
+TEST(WindowCloseTest, ClockStopsWithTheHandler) {
+  EventLoop loop;
+  DataClient dc(&loop);
+  {
+    DataHandler dh = DataHandler(&dc);
+    dh.Init();
+    // The first timer of the loop.
+    EXPECT_EQ(loop.NumTimers(), 1);
+  }
+  loop.RunAfter(absl::Milliseconds(300), [&loop]() { loop.Stop(); });
+  loop.Run();
+  // Cancelled on the loop, without ticking the destroyed handler.
+  EXPECT_EQ(loop.NumTimers(), 0);
+}
+
+TEST(EventTest, SubscriptionsOfOneSymbol) {
+  const int kNumTickers = 5;
+  const int kNumSeconds = 15;
+  std::vector<std::string> msgs = MakeMessages(kNumTickers, kNumSeconds);
+  const int64_t delay_ms =
+      absl::ToInt64Milliseconds(absl::GetFlag(FLAGS_window_close_delay));
+  DataHandler dh = DataHandler(nullptr);
+  SymbolId sym_id = SymbolTable::Get().Intern("SHARD2");
+
+  int updates = 0;
+  std::vector<SymbolId> stale;
+  ASSERT_EQ(dh.Subscribe("one", BAR_UPDATED, sym_id,
+                         [&](const Event& event) {
+                           EXPECT_EQ(event.sym_id, sym_id);
+                           ++updates;
+                         }),
+            absl::OkStatus());
+  ASSERT_EQ(dh.Subscribe("all", SYMBOL_STALE, kInvalidSymbolId,
+                         [&](const Event& event) {
+                           stale.push_back(event.sym_id);
+                         }),
+            absl::OkStatus());
+  EXPECT_EQ(dh.Subscribe("all", SYMBOL_STALE, kInvalidSymbolId,
+                         [](const Event& event) {})
+                .code(),
+            absl::StatusCode::kAlreadyExists);
+
+  dh.AdvanceTime(1610144868000);
+  for (const auto& msg : msgs) {
+    dh.ProcessMessage(msg);
+  }
+  EXPECT_EQ(updates, kNumSeconds);
+  EXPECT_TRUE(stale.empty());
+
+  // The silence of every symbol is reported once.
+  dh.AdvanceTime(1610144890000 + delay_ms);
+  dh.AdvanceTime(1610145000000 + delay_ms);
+  EXPECT_EQ(stale.size(), kNumTickers);
+  EXPECT_EQ(std::count(stale.begin(), stale.end(), sym_id), 1);
+
+  EXPECT_EQ(dh.Unsubscribe("one"), absl::OkStatus());
+  EXPECT_EQ(dh.Unsubscribe("one").code(), absl::StatusCode::kNotFound);
+}
+
+// Serves a bar of volume 1000 for every minute from 1610144880000 to
+// 1610145000000.
+class FakeBarSource : public BarSource {
+ public:
+  absl::Status GetMinuteBars(const std::vector<std::string>& tickers,
+                             int64_t start_ms, int64_t end_ms,
+                             std::vector<AggregateData>* bars) override {
+    for (const std::string& ticker : tickers) {
+      for (int64_t t = 1610144880000; t < 1610145000000; t += 60000) {
+        AggregateData& bar = bars->emplace_back();
+        bar.sym_id_ = SymbolTable::Get().Intern(ticker);
+        bar.vol_ = 1000;
+        bar.start_ = t;
+        bar.end_ = t + 60000;
+      }
+    }
+    ++requests;
+    return absl::OkStatus();
+  }
+
+  std::atomic<int> requests{0};
+};
+
+TEST(BackfillTest, FillsTheGapOfAReconnect) {
+  FakeBarSource source;
+  DataHandler dh = DataHandler(nullptr);
+  dh.SetBarSource(&source);
+  SymbolId sym_id = SymbolTable::Get().Intern("SHARD1");
+  int updates = 0;
+  ASSERT_TRUE(dh.RegisterCallback("count", [&](SymbolId updated) {
+                  if (updated == sym_id) ++updates;
+                }).ok());
+  // The data before the gap ends at 1610144883000.
+  for (const auto& msg : MakeMessages(3, 15)) {
+    dh.ProcessMessage(msg);
+  }
+  dh.OnGap(1610144883000, absl::ToUnixMillis(absl::Now()));
+  std::vector<std::string> msgs = MakeMessages(3, 5, 1610145000000);
+  dh.ProcessMessage(msgs[0]);
+  // Held until the bars are in.
+  EXPECT_EQ(dh.GetData(ONE_SEC, sym_id).front().start_, 1610144882000);
+  while (dh.GetData(ONE_SEC, sym_id).front().start_ < 1610145000000) {
+    dh.AdvanceTime(1610145000000);
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(source.requests, 1);
+  for (int i = 1; i < msgs.size(); ++i) {
+    dh.ProcessMessage(msgs[i]);
+  }
+
+  // The minute at 1610144880000 is partly in the data, so only the minute at
+  // 1610144940000 is backfilled.
+  const auto& one_min = dh.GetData(ONE_MIN, sym_id);
+  ASSERT_GE(one_min.size(), 3);
+  EXPECT_EQ(one_min[0].start_, 1610145000000);
+  EXPECT_EQ(one_min[0].vol_, 5 * 100 + 10);
+  EXPECT_EQ(one_min[1].start_, 1610144940000);
+  EXPECT_EQ(one_min[1].vol_, 1000);
+  EXPECT_EQ(one_min[2].start_, 1610144880000);
+  EXPECT_EQ(dh.GetData(ONE_SEC, sym_id).front().start_, 1610145004000);
+  // Only the live aggregates are updates, not the backfilled bar.
+  EXPECT_EQ(updates, 15 + 5);
+  dh.SetBarSource(nullptr);
+}
+
+TEST(SnapshotTest, ResumesWithTheHistoryOfTheLastRun) {
+  const int kNumTickers = 7;
+  const int kNumSeconds = 90;
+  const std::string path = ::testing::TempDir() + "/data_handler.snapshot";
+  std::vector<std::string> msgs = MakeMessages(kNumTickers, kNumSeconds);
+  // Left by an earlier run.
+  std::remove(path.c_str());
+
+  // Runs until a second before the end, and writes a snapshot on shutdown.
+  absl::SetFlag(&FLAGS_snapshot_path, path);
+  {
+    absl::SetFlag(&FLAGS_data_handler_shards, 3);
+    DataHandler dh = DataHandler(nullptr);
+    absl::SetFlag(&FLAGS_data_handler_shards, 0);
+    for (int t = 0; t + 1 < kNumSeconds; ++t) {
+      dh.ProcessMessage(msgs[t]);
+    }
+  }
+  // Restarts with the snapshot, unsharded.
+  DataHandler restarted = DataHandler(nullptr);
+  IndicatorId restarted_ema = restarted.AddIndicator(TEN_SEC, EMA, 3);
+  const SymbolId shard0 = SymbolTable::Get().Intern("SHARD0");
+  std::vector<int64_t> closed;
+  ASSERT_TRUE(restarted
+                  .RegisterWindowCloseCallback(
+                      "closed",
+                      [&](SymbolId sym_id, DataStoreIndex index,
+                          int64_t window_start) {
+                        if (sym_id == shard0 && index == TEN_SEC) {
+                          closed.push_back(window_start);
+                        }
+                      })
+                  .ok());
+  restarted.ProcessMessage(msgs.back());
+  absl::SetFlag(&FLAGS_snapshot_path, "");
+
+  DataHandler expected_dh = DataHandler(nullptr);
+  IndicatorId ema = expected_dh.AddIndicator(TEN_SEC, EMA, 3);
+  for (const auto& msg : msgs) {
+    expected_dh.ProcessMessage(msg);
+  }
+  for (int i = 0; i < kNumTickers; ++i) {
+    SymbolId sym_id = SymbolTable::Get().Intern("SHARD" + std::to_string(i));
+    for (int index = 0; index < NUM_DATA_STORE; ++index) {
+      const auto& expected =
+          expected_dh.GetData(static_cast<DataStoreIndex>(index), sym_id);
+      const auto& actual =
+          restarted.GetData(static_cast<DataStoreIndex>(index), sym_id);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(actual[j].start_, expected[j].start_);
+        EXPECT_EQ(actual[j].end_, expected[j].end_);
+        EXPECT_EQ(actual[j].vol_, expected[j].vol_);
+        EXPECT_EQ(actual[j].close_ticks_, expected[j].close_ticks_);
+        EXPECT_DOUBLE_EQ(actual[j].close_, expected[j].close_);
+      }
+    }
+    EXPECT_DOUBLE_EQ(restarted.GetIndicator(restarted_ema, sym_id),
+                     expected_dh.GetIndicator(ema, sym_id));
+  }
+
+  // The 10s window open in the snapshot closes with the next data.
+  EXPECT_TRUE(closed.empty());
+  restarted.ProcessMessage(MakeMessages(kNumTickers, 1, 1610144960000)[0]);
+  EXPECT_EQ(closed, std::vector<int64_t>({1610144950000}));
+
+  // Snapshots of other timeframes are not restored.
+  absl::SetFlag(&FLAGS_extra_timeframes, {"30"});
+  DataHandler other_timeframes = DataHandler(nullptr);
+  EXPECT_TRUE(absl::IsFailedPrecondition(other_timeframes.LoadSnapshot(path)));
+  absl::SetFlag(&FLAGS_extra_timeframes, {});
+}
+
+TEST(SnapshotTest, RestoresShardsOnTheirThreadsWhileTheClockRuns) {
+  const int kNumTickers = 7;
+  const int kNumSeconds = 89;
+  const std::string path =
+      ::testing::TempDir() + "/data_handler_sharded.snapshot";
+  std::vector<std::string> msgs = MakeMessages(kNumTickers, kNumSeconds);
+  std::remove(path.c_str());
+
+  DataHandler expected_dh = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_snapshot_path, path);
+  {
+    DataHandler dh = DataHandler(nullptr);
+    for (const auto& msg : msgs) {
+      dh.ProcessMessage(msg);
+      expected_dh.ProcessMessage(msg);
+    }
+  }
+  absl::SetFlag(&FLAGS_snapshot_path, "");
+
+  absl::SetFlag(&FLAGS_data_handler_shards, 3);
+  DataHandler restarted = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_data_handler_shards, 0);
+  const SymbolId shard0 = SymbolTable::Get().Intern("SHARD0");
+  std::mutex mu;
+  std::vector<int64_t> closed;
+  int num_stale = 0;
+  ASSERT_TRUE(restarted
+                  .RegisterWindowCloseCallback(
+                      "closed",
+                      [&](SymbolId sym_id, DataStoreIndex index,
+                          int64_t window_start) {
+                        std::lock_guard<std::mutex> lock(mu);
+                        if (sym_id == shard0 && index == TEN_SEC) {
+                          closed.push_back(window_start);
+                        }
+                      })
+                  .ok());
+  ASSERT_TRUE(restarted
+                  .Subscribe("stale", SYMBOL_STALE, kInvalidSymbolId,
+                             [&](const Event&) {
+                               std::lock_guard<std::mutex> lock(mu);
+                               ++num_stale;
+                             })
+                  .ok());
+  // The clock runs on the shard threads before and after the restore.
+  const int64_t now_ms = absl::ToUnixMillis(absl::Now());
+  restarted.AdvanceTime(now_ms);
+  ASSERT_TRUE(restarted.LoadSnapshot(path).ok());
+  for (int i = 0; i < kNumTickers; ++i) {
+    SymbolId sym_id = SymbolTable::Get().Intern("SHARD" + std::to_string(i));
+    for (int index = 0; index < NUM_DATA_STORE; ++index) {
+      const auto& expected =
+          expected_dh.GetData(static_cast<DataStoreIndex>(index), sym_id);
+      const auto& actual =
+          restarted.GetData(static_cast<DataStoreIndex>(index), sym_id);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(actual[j].start_, expected[j].start_);
+        EXPECT_EQ(actual[j].vol_, expected[j].vol_);
+      }
+    }
+  }
+
+  // The windows open in the snapshot close by time, as the symbols are
+  // silent since.
+  restarted.AdvanceTime(now_ms + 1000);
+  restarted.Flush();
+  std::lock_guard<std::mutex> lock(mu);
+  EXPECT_EQ(closed, std::vector<int64_t>({1610144950000}));
+  EXPECT_EQ(num_stale, kNumTickers);
+}
+
 }  // namespace
 }  // namespace pasta
 
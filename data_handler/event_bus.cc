@@ -0,0 +1,68 @@
+#include "data_handler/event_bus.h"
+
+#include "absl/status/status.h"
+#include "data_handler/symbol_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace pasta {
+
+absl::Status EventBus::Subscribe(const std::string& name, EventType type,
+                                 SymbolId sym_id, Handler handler) {
+  for (const auto& sub : subscriptions_) {
+    if (sub->name == name && sub->type == type && sub->sym_id == sym_id) {
+      return absl::AlreadyExistsError("Subscriber <" + name +
+                                      "> is already subscribed.");
+    }
+  }
+  subscriptions_.push_back(std::make_unique<Subscription>(
+      Subscription{name, type, sym_id, std::move(handler)}));
+  Index();
+  return absl::OkStatus();
+}
+
+absl::Status EventBus::Unsubscribe(const std::string& name) {
+  return Remove(name, [](const Subscription&) { return true; });
+}
+
+absl::Status EventBus::Unsubscribe(const std::string& name, EventType type) {
+  return Remove(name,
+                [type](const Subscription& sub) { return sub.type == type; });
+}
+
+absl::Status EventBus::Remove(
+    const std::string& name,
+    const std::function<bool(const Subscription&)>& pred) {
+  auto end = std::remove_if(subscriptions_.begin(), subscriptions_.end(),
+                            [&](const auto& sub) {
+                              return sub->name == name && pred(*sub);
+                            });
+  if (end == subscriptions_.end()) {
+    return absl::NotFoundError("Subscriber <" + name +
+                               "> is not subscribed.");
+  }
+  subscriptions_.erase(end, subscriptions_.end());
+  Index();
+  return absl::OkStatus();
+}
+
+void EventBus::Index() {
+  for (int type = 0; type < NUM_EVENT_TYPES; ++type) {
+    all_symbols_[type].clear();
+    by_symbol_[type].clear();
+  }
+  for (const auto& sub : subscriptions_) {
+    if (sub->sym_id == kInvalidSymbolId) {
+      all_symbols_[sub->type].push_back(sub.get());
+      continue;
+    }
+    auto& by_symbol = by_symbol_[sub->type];
+    if (sub->sym_id >= by_symbol.size()) by_symbol.resize(sub->sym_id + 1);
+    by_symbol[sub->sym_id].push_back(sub.get());
+  }
+}
+
+}  // namespace pasta
@@ -0,0 +1,101 @@
+#ifndef PASTA_DATA_HANDLER_EVENT_BUS_H_
+#define PASTA_DATA_HANDLER_EVENT_BUS_H_
+
+#include "absl/status/status.h"
+#include "data_handler/symbol_table.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+enum EventType {
+  // A live aggregate of the symbol updated its bars. Not published for the
+  // bars backfilled after a gap in the data.
+  BAR_UPDATED = 0,
+  // A window of the symbol closed, by data or by the clock.
+  WINDOW_CLOSED = 1,
+  // The symbol went silent: a window of it closed by the clock since its
+  // last aggregate. Once per silence.
+  SYMBOL_STALE = 2,
+  NUM_EVENT_TYPES = 3,
+};
+
+struct Event {
+  EventType type;
+  SymbolId sym_id;
+  // The timeframe index and start (Unix millis) of the window of a
+  // WINDOW_CLOSED event, otherwise -1.
+  int timeframe;
+  int64_t window_start;
+};
+
+// Dispatches market data events to the handlers subscribed to their type,
+// either for every symbol or for one symbol. Subscribers are kept in
+// precomputed lists per event type and SymbolId, so publishing an event
+// costs O(1) plus one call per interested handler, however many handlers
+// are subscribed to other symbols or types.
+//
+// Subscriptions must be made before events are published. Publish() may then
+// be called from several threads concurrently.
+class EventBus {
+ public:
+  typedef std::function<void(const Event&)> Handler;
+
+  EventBus() = default;
+  EventBus(const EventBus&) = delete;
+  EventBus& operator=(const EventBus&) = delete;
+
+  // Subscribes `handler` to the events of `type` of `sym_id`, or of every
+  // symbol if `sym_id` is kInvalidSymbolId. Handlers of every symbol run
+  // before those of one symbol, each in subscription order. Fails if `name`
+  // is already subscribed to the same events.
+  absl::Status Subscribe(const std::string& name, EventType type,
+                         SymbolId sym_id, Handler handler);
+
+  // Removes every subscription of `name`, or those to events of `type`.
+  absl::Status Unsubscribe(const std::string& name);
+  absl::Status Unsubscribe(const std::string& name, EventType type);
+
+  void Publish(const Event& event) const {
+    for (const Subscription* sub : all_symbols_[event.type]) {
+      sub->handler(event);
+    }
+    const auto& by_symbol = by_symbol_[event.type];
+    if (event.sym_id < by_symbol.size()) {
+      for (const Subscription* sub : by_symbol[event.sym_id]) {
+        sub->handler(event);
+      }
+    }
+  }
+
+ private:
+  struct Subscription {
+    std::string name;
+    EventType type;
+    SymbolId sym_id;
+    Handler handler;
+  };
+
+  // Removes the subscriptions of `name` for which `pred` holds.
+  absl::Status Remove(const std::string& name,
+                      const std::function<bool(const Subscription&)>& pred);
+
+  // Rebuilds the dispatch lists from subscriptions_.
+  void Index();
+
+  // In subscription order.
+  std::vector<std::unique_ptr<Subscription>> subscriptions_;
+
+  // Dispatch lists by event type, and by SymbolId for subscriptions of one
+  // symbol.
+  std::vector<const Subscription*> all_symbols_[NUM_EVENT_TYPES];
+  std::vector<std::vector<const Subscription*>> by_symbol_[NUM_EVENT_TYPES];
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_EVENT_BUS_H_
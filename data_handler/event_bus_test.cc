@@ -0,0 +1,78 @@
+#include "data_handler/event_bus.h"
+
+#include "absl/status/status.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+class EventBusTest : public ::testing::Test {
+ protected:
+  // Subscribes a handler recording "<name>:<sym_id>" of every event.
+  absl::Status Record(const std::string& name, EventType type,
+                      SymbolId sym_id) {
+    return bus_.Subscribe(name, type, sym_id, [this, name](const Event& e) {
+      calls_.push_back(name + ":" + std::to_string(e.sym_id));
+    });
+  }
+
+  void Publish(EventType type, SymbolId sym_id) {
+    bus_.Publish(Event{type, sym_id, -1, -1});
+  }
+
+  EventBus bus_;
+  std::vector<std::string> calls_;
+};
+
+TEST_F(EventBusTest, DispatchesToInterestedHandlers) {
+  ASSERT_TRUE(Record("one", BAR_UPDATED, 1).ok());
+  ASSERT_TRUE(Record("all", BAR_UPDATED, kInvalidSymbolId).ok());
+  ASSERT_TRUE(Record("stale", SYMBOL_STALE, 1).ok());
+  ASSERT_TRUE(Record("two", BAR_UPDATED, 2).ok());
+
+  Publish(BAR_UPDATED, 1);
+  Publish(BAR_UPDATED, 3);
+  Publish(SYMBOL_STALE, 2);
+  Publish(SYMBOL_STALE, 1);
+  Publish(WINDOW_CLOSED, 1);
+  EXPECT_EQ(calls_, (std::vector<std::string>{"all:1", "one:1", "all:3",
+                                              "stale:1"}));
+}
+
+TEST_F(EventBusTest, Subscriptions) {
+  ASSERT_TRUE(Record("a", BAR_UPDATED, kInvalidSymbolId).ok());
+  EXPECT_EQ(Record("a", BAR_UPDATED, kInvalidSymbolId).code(),
+            absl::StatusCode::kAlreadyExists);
+  // The same name may follow other events.
+  ASSERT_TRUE(Record("a", BAR_UPDATED, 4).ok());
+  ASSERT_TRUE(Record("a", WINDOW_CLOSED, kInvalidSymbolId).ok());
+  ASSERT_TRUE(Record("b", WINDOW_CLOSED, kInvalidSymbolId).ok());
+
+  ASSERT_TRUE(bus_.Unsubscribe("a", BAR_UPDATED).ok());
+  EXPECT_EQ(bus_.Unsubscribe("a", BAR_UPDATED).code(),
+            absl::StatusCode::kNotFound);
+  Publish(BAR_UPDATED, 4);
+  Publish(WINDOW_CLOSED, 4);
+  EXPECT_EQ(calls_, (std::vector<std::string>{"a:4", "b:4"}));
+
+  calls_.clear();
+  ASSERT_TRUE(bus_.Unsubscribe("a").ok());
+  EXPECT_EQ(bus_.Unsubscribe("a").code(), absl::StatusCode::kNotFound);
+  Publish(WINDOW_CLOSED, 4);
+  EXPECT_EQ(calls_, (std::vector<std::string>{"b:4"}));
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,89 @@
+#include "data_handler/event_loop.h"
+
+#include "glog/logging.h"
+
+#include <utility>
+
+namespace pasta {
+
+EventLoop::EventLoop()
+    : work_(std::make_unique<boost::asio::io_service::work>(io_service_)),
+      next_timer_id_(1) {}
+
+EventLoop::~EventLoop() {
+  for (auto& id_timer : timers_) {
+    id_timer.second->timer.cancel();
+  }
+}
+
+void EventLoop::Run() {
+  io_service_.run();
+  // Ready for the next Run().
+  io_service_.restart();
+}
+
+void EventLoop::Stop() { io_service_.stop(); }
+
+void EventLoop::Post(std::function<void()> task) {
+  io_service_.post(std::move(task));
+}
+
+EventLoop::TimerId EventLoop::RunAfter(absl::Duration delay,
+                                       std::function<void()> task) {
+  return AddTimer(delay, absl::ZeroDuration(), std::move(task));
+}
+
+EventLoop::TimerId EventLoop::RunEvery(absl::Duration interval,
+                                       std::function<void()> task) {
+  CHECK_GT(interval, absl::ZeroDuration());
+  return AddTimer(interval, interval, std::move(task));
+}
+
+void EventLoop::Cancel(TimerId id) {
+  auto iter = timers_.find(id);
+  if (iter == timers_.end()) return;
+  // The handler of the timer still runs, with operation_aborted, and finds
+  // the timer gone.
+  iter->second->timer.cancel();
+  timers_.erase(iter);
+}
+
+EventLoop::TimerId EventLoop::AddTimer(absl::Duration delay,
+                                       absl::Duration interval,
+                                       std::function<void()> task) {
+  TimerId id = next_timer_id_++;
+  auto timer = std::make_unique<Timer>(&io_service_);
+  timer->task = std::move(task);
+  timer->interval = interval;
+  timer->timer.expires_after(absl::ToChronoNanoseconds(delay));
+  Wait(id, timer.get());
+  timers_[id] = std::move(timer);
+  return id;
+}
+
+void EventLoop::Wait(TimerId id, Timer* timer) {
+  timer->timer.async_wait([this, id](const boost::system::error_code&) {
+    auto iter = timers_.find(id);
+    if (iter == timers_.end()) {
+      // Cancelled.
+      return;
+    }
+    Timer* timer = iter->second.get();
+    if (timer->interval == absl::ZeroDuration()) {
+      std::function<void()> task = std::move(timer->task);
+      timers_.erase(iter);
+      task();
+      return;
+    }
+    // Scheduled from the previous expiry, so that the period does not drift
+    // by the handling latency.
+    timer->timer.expires_at(timer->timer.expiry() +
+                            absl::ToChronoNanoseconds(timer->interval));
+    Wait(id, timer);
+    // A copy, as the task may cancel the timer.
+    std::function<void()> task = timer->task;
+    task();
+  });
+}
+
+}  // namespace pasta
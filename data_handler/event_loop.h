@@ -0,0 +1,79 @@
+#ifndef PASTA_DATA_HANDLER_EVENT_LOOP_H_
+#define PASTA_DATA_HANDLER_EVENT_LOOP_H_
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace pasta {
+
+// A single-threaded asio event loop shared by the network connections of the
+// process, i.e. the Polygon data stream and the Alpaca trade update stream.
+// Every handler -- messages of all connections, timers and posted tasks --
+// runs on the thread calling Run(), one at a time, so the events of all
+// streams form a single sequence.
+class EventLoop {
+ public:
+  typedef int64_t TimerId;
+
+  EventLoop();
+  ~EventLoop();
+
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Runs handlers until Stop() is called, even while there is nothing to
+  // handle. Returns immediately if Stop() was called since the last Run()
+  // returned. May be called again after returning.
+  void Run();
+
+  // Makes Run() return after the handler that is running. Thread safe.
+  void Stop();
+
+  // Runs `task` on the loop thread. Thread safe.
+  void Post(std::function<void()> task);
+
+  // Runs `task` on the loop thread after `delay`, or every `interval`, until
+  // cancelled. Must be called on the loop thread, or while Run() is not
+  // running, as must Cancel(). Timer ids are positive, so 0 can stand for no
+  // timer.
+  TimerId RunAfter(absl::Duration delay, std::function<void()> task);
+  TimerId RunEvery(absl::Duration interval, std::function<void()> task);
+  void Cancel(TimerId id);
+
+  // The number of pending timers.
+  int NumTimers() const { return timers_.size(); }
+
+  // For hosting asio based clients on the loop.
+  boost::asio::io_service* io_service() { return &io_service_; }
+
+ private:
+  struct Timer {
+    Timer(boost::asio::io_service* io_service) : timer(*io_service) {}
+
+    boost::asio::steady_timer timer;
+    std::function<void()> task;
+    // Zero for a one-shot timer.
+    absl::Duration interval;
+  };
+
+  TimerId AddTimer(absl::Duration delay, absl::Duration interval,
+                   std::function<void()> task);
+  void Wait(TimerId id, Timer* timer);
+
+  boost::asio::io_service io_service_;
+  // Keeps Run() running while there is nothing to handle.
+  std::unique_ptr<boost::asio::io_service::work> work_;
+
+  absl::flat_hash_map<TimerId, std::unique_ptr<Timer>> timers_;
+  TimerId next_timer_id_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_EVENT_LOOP_H_
@@ -0,0 +1,93 @@
+#include "data_handler/event_loop.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+TEST(EventLoopTest, TimersRunInExpiryOrder) {
+  EventLoop loop;
+  std::vector<std::string> events;
+  loop.RunAfter(absl::Milliseconds(20), [&]() {
+    events.push_back("20ms");
+    loop.Stop();
+  });
+  loop.RunAfter(absl::Milliseconds(10), [&]() { events.push_back("10ms"); });
+  EventLoop::TimerId cancelled =
+      loop.RunAfter(absl::Milliseconds(5), [&]() { events.push_back("5ms"); });
+  loop.Post([&]() { events.push_back("posted"); });
+  loop.Cancel(cancelled);
+  EXPECT_EQ(loop.NumTimers(), 2);
+
+  loop.Run();
+  EXPECT_EQ(events, std::vector<std::string>({"posted", "10ms", "20ms"}));
+  EXPECT_EQ(loop.NumTimers(), 0);
+}
+
+TEST(EventLoopTest, RunEveryUntilCancelled) {
+  EventLoop loop;
+  int runs = 0;
+  EventLoop::TimerId id;
+  id = loop.RunEvery(absl::Milliseconds(1), [&]() {
+    if (++runs == 5) {
+      loop.Cancel(id);
+      loop.RunAfter(absl::Milliseconds(10), [&]() { loop.Stop(); });
+    }
+  });
+  EXPECT_GT(id, 0);
+  loop.Run();
+  EXPECT_EQ(runs, 5);
+}
+
+TEST(EventLoopTest, PostFromOtherThreads) {
+  EventLoop loop;
+  const std::thread::id loop_thread = std::this_thread::get_id();
+  int posted = 0;
+  bool same_thread = true;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < 1000; ++j) {
+        loop.Post([&]() {
+          same_thread &= std::this_thread::get_id() == loop_thread;
+          if (++posted == 4000) loop.Stop();
+        });
+      }
+    });
+  }
+  // Keeps running while nothing is posted yet.
+  loop.Run();
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(posted, 4000);
+  EXPECT_TRUE(same_thread);
+}
+
+TEST(EventLoopTest, RunsAgainAfterStop) {
+  EventLoop loop;
+  loop.Stop();
+  loop.Run();
+  bool ran = false;
+  loop.Post([&]() {
+    ran = true;
+    loop.Stop();
+  });
+  loop.Run();
+  EXPECT_TRUE(ran);
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
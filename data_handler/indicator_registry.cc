@@ -0,0 +1,106 @@
+#include "data_handler/indicator_registry.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/indicators.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <limits>
+#include <memory>
+
+namespace pasta {
+
+IndicatorRegistry::IndicatorRegistry(CascadingAggregator* agg_data,
+                                     int num_partitions)
+    : agg_data_(agg_data),
+      num_partitions_(num_partitions),
+      by_timeframe_(agg_data->num_timeframes()) {}
+
+IndicatorId IndicatorRegistry::Add(const IndicatorSpec& spec) {
+  CHECK(spec.timeframe >= 0 && spec.timeframe < by_timeframe_.size())
+      << "Invalid timeframe: " << spec.timeframe;
+  CHECK_GE(spec.period, 1) << "Invalid indicator period: " << spec.period;
+  for (IndicatorId id = 0; id < specs_.size(); ++id) {
+    if (specs_[id] == spec) return id;
+  }
+  specs_.push_back(spec);
+  by_timeframe_[spec.timeframe].push_back(specs_.size() - 1);
+  return specs_.size() - 1;
+}
+
+IndicatorRegistry::SymbolIndicators& IndicatorRegistry::GetSymbolIndicators(
+    SymbolId sym_id) {
+  const size_t index = sym_id / num_partitions_;
+  if (index >= symbols_.size()) symbols_.resize(index + 1);
+  SymbolIndicators& symbol = symbols_[index];
+  if (symbol.open.empty()) symbol.open.resize(by_timeframe_.size(), -1);
+  return symbol;
+}
+
+void IndicatorRegistry::OnAggregate(SymbolId sym_id) {
+  if (specs_.empty()) return;
+  SymbolIndicators& symbol = GetSymbolIndicators(sym_id);
+  // Indicators created now start with the open bar.
+  const IndicatorId first_new = symbol.indicators.size();
+  while (symbol.indicators.size() < specs_.size()) {
+    const IndicatorSpec& spec = specs_[symbol.indicators.size()];
+    symbol.indicators.push_back(MakeIndicator(
+        spec, agg_data_->window_size(spec.timeframe) * NUM_MILLIS_PER_SECOND));
+  }
+
+  for (int i = 0; i < by_timeframe_.size(); ++i) {
+    if (by_timeframe_[i].empty()) continue;
+    const AggDataStore::AggDataQueue& data = agg_data_->GetData(i, sym_id);
+    const AggregateData& front = data.front();
+    if (front.start_ != symbol.open[i]) {
+      // A window opened, so the one before it, if any, is final.
+      if (symbol.open[i] >= 0 && data.size() > 1) {
+        for (IndicatorId id : by_timeframe_[i]) {
+          if (id < first_new) symbol.indicators[id]->OnClose(data[1]);
+        }
+      }
+      symbol.open[i] = front.start_;
+    }
+    for (IndicatorId id : by_timeframe_[i]) {
+      symbol.indicators[id]->OnUpdate(front);
+    }
+  }
+}
+
+void IndicatorRegistry::Warm(SymbolId sym_id) {
+  if (specs_.empty()) return;
+  SymbolIndicators& symbol = GetSymbolIndicators(sym_id);
+  symbol.indicators.clear();
+  for (const IndicatorSpec& spec : specs_) {
+    symbol.indicators.push_back(MakeIndicator(
+        spec, agg_data_->window_size(spec.timeframe) * NUM_MILLIS_PER_SECOND));
+  }
+
+  for (int i = 0; i < by_timeframe_.size(); ++i) {
+    symbol.open[i] = -1;
+    const AggDataStore::AggDataQueue& data = agg_data_->GetData(i, sym_id);
+    if (by_timeframe_[i].empty() || data.empty()) continue;
+    for (IndicatorId id : by_timeframe_[i]) {
+      Indicator& indicator = *symbol.indicators[id];
+      // Every window but the newest is final.
+      for (size_t j = data.size() - 1; j > 0; --j) {
+        indicator.OnUpdate(data[j]);
+        indicator.OnClose(data[j]);
+      }
+      indicator.OnUpdate(data.front());
+    }
+    symbol.open[i] = data.front().start_;
+  }
+}
+
+double IndicatorRegistry::Value(IndicatorId id, SymbolId sym_id) const {
+  DCHECK(id >= 0 && id < specs_.size());
+  const size_t index = sym_id / num_partitions_;
+  if (index >= symbols_.size() || id >= symbols_[index].indicators.size()) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return symbols_[index].indicators[id]->value();
+}
+
+}  // namespace pasta
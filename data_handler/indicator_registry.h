@@ -0,0 +1,77 @@
+#ifndef PASTA_DATA_HANDLER_INDICATOR_REGISTRY_H_
+#define PASTA_DATA_HANDLER_INDICATOR_REGISTRY_H_
+
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/indicators.h"
+#include "data_handler/symbol_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pasta {
+
+typedef int IndicatorId;
+
+// The indicators that strategies declared over the timeframes of a
+// CascadingAggregator, for every symbol. Each distinct IndicatorSpec is
+// computed once per symbol, however many strategies ask for it, and only
+// timeframes with indicators cost anything per aggregate.
+//
+// Not thread safe. With a partitioned aggregator, the registry of a
+// partition is updated and read on the thread owning the partition.
+class IndicatorRegistry {
+ public:
+  // Computes indicators over `agg_data`, which must outlive the registry, and
+  // of which the registry is one of `num_partitions` partitions like
+  // CascadingAggregator.
+  IndicatorRegistry(CascadingAggregator* agg_data, int num_partitions);
+
+  IndicatorRegistry(const IndicatorRegistry&) = delete;
+  IndicatorRegistry& operator=(const IndicatorRegistry&) = delete;
+
+  // Returns the id of the indicator of `spec`, adding it unless it was added
+  // before. Symbols that traded before get the indicator from their next
+  // aggregate on, over the bars from then on.
+  IndicatorId Add(const IndicatorSpec& spec);
+
+  // Called after every CascadingAggregator::AddData(), with the symbol of the
+  // aggregate.
+  void OnAggregate(SymbolId sym_id);
+
+  // Recomputes the indicators of `sym_id` from its histories, e.g. restored
+  // ones, as if its windows had been added one by one. Indicators that look
+  // back further than the histories keep, e.g. EMA, start from the oldest
+  // window kept.
+  void Warm(SymbolId sym_id);
+
+  // The value of indicator `id` for `sym_id`, or NaN if there is not enough
+  // data yet. O(1).
+  double Value(IndicatorId id, SymbolId sym_id) const;
+
+  int size() const { return specs_.size(); }
+
+ private:
+  struct SymbolIndicators {
+    // The start of the newest window per timeframe, or -1.
+    std::vector<int64_t> open;
+    // Indexed by IndicatorId.
+    std::vector<std::unique_ptr<Indicator>> indicators;
+  };
+
+  SymbolIndicators& GetSymbolIndicators(SymbolId sym_id);
+
+  CascadingAggregator* agg_data_;
+  int num_partitions_;
+
+  std::vector<IndicatorSpec> specs_;
+  // Indicator ids by timeframe.
+  std::vector<std::vector<IndicatorId>> by_timeframe_;
+
+  // Indexed by SymbolId / num_partitions_.
+  std::vector<SymbolIndicators> symbols_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_INDICATOR_REGISTRY_H_
@@ -0,0 +1,153 @@
+#include "data_handler/indicator_registry.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/indicators.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+AggregateData MakeAgg(SymbolId sym_id, int64_t start, int64_t vol,
+                      double close) {
+  AggregateData agg;
+  agg.sym_id_ = sym_id;
+  agg.vol_ = vol;
+  agg.open_ = close;
+  agg.close_ = close;
+  agg.high_ = close + .01;
+  agg.low_ = close - .01;
+  agg.start_ = start;
+  agg.end_ = start + NUM_MILLIS_PER_SECOND;
+  return agg;
+}
+
+TEST(IndicatorRegistryTest, SharesEqualSpecs) {
+  CascadingAggregator agg_data({1, 10});
+  IndicatorRegistry registry(&agg_data, 1);
+  IndicatorId ema = registry.Add(IndicatorSpec{EMA, 1, 20});
+  EXPECT_EQ(registry.Add(IndicatorSpec{SMA, 1, 20}), ema + 1);
+  EXPECT_EQ(registry.Add(IndicatorSpec{EMA, 0, 20}), ema + 2);
+  EXPECT_EQ(registry.Add(IndicatorSpec{EMA, 1, 20}), ema);
+  EXPECT_EQ(registry.size(), 3);
+  EXPECT_TRUE(std::isnan(registry.Value(ema, SymbolTable::Get().Intern("X"))));
+}
+
+TEST(IndicatorRegistryTest, FollowsTheWindowsOfItsTimeframe) {
+  const int64_t start = 1610144860000;
+  CascadingAggregator agg_data({1, 10});
+  IndicatorRegistry registry(&agg_data, 1);
+  // The volume of the last three 10s windows and the average close of the
+  // last two.
+  IndicatorId vol = registry.Add(IndicatorSpec{VOLUME_SUM, 1, 3});
+  IndicatorId sma = registry.Add(IndicatorSpec{SMA, 1, 2});
+  SymbolId sym_id = SymbolTable::Get().Intern("SPCE");
+
+  auto add = [&](int64_t second, int64_t vol, double close) {
+    agg_data.AddData(MakeAgg(sym_id, start + second * NUM_MILLIS_PER_SECOND,
+                             vol, close));
+    registry.OnAggregate(sym_id);
+  };
+  add(0, 100, 10);
+  add(5, 200, 11);
+  EXPECT_EQ(registry.Value(vol, sym_id), 300);
+  EXPECT_TRUE(std::isnan(registry.Value(sma, sym_id)));
+  add(12, 50, 13);
+  EXPECT_EQ(registry.Value(vol, sym_id), 350);
+  EXPECT_DOUBLE_EQ(registry.Value(sma, sym_id), 12);
+  add(19, 50, 15);
+  EXPECT_EQ(registry.Value(vol, sym_id), 400);
+  EXPECT_DOUBLE_EQ(registry.Value(sma, sym_id), 13);
+  // The first window is out of range of the window at 30 seconds.
+  add(31, 10, 16);
+  EXPECT_EQ(registry.Value(vol, sym_id), 110);
+  EXPECT_DOUBLE_EQ(registry.Value(sma, sym_id), 15.5);
+}
+
+TEST(IndicatorRegistryTest, SpecsAddedLater) {
+  const int64_t start = 1610144860000;
+  CascadingAggregator agg_data({1}, 2);
+  IndicatorRegistry registry(&agg_data, 2);
+  IndicatorId high = registry.Add(IndicatorSpec{ROLLING_HIGH, 0, 10});
+  SymbolId sym_id = SymbolTable::Get().Intern("GME");
+  for (int i = 0; i < 5; ++i) {
+    agg_data.AddData(MakeAgg(sym_id, start + i * NUM_MILLIS_PER_SECOND, 100,
+                             20 - i));
+    registry.OnAggregate(sym_id);
+  }
+  EXPECT_DOUBLE_EQ(registry.Value(high, sym_id), 20.01);
+
+  IndicatorId low = registry.Add(IndicatorSpec{ROLLING_LOW, 0, 10});
+  EXPECT_TRUE(std::isnan(registry.Value(low, sym_id)));
+  for (int i = 5; i < 7; ++i) {
+    agg_data.AddData(MakeAgg(sym_id, start + i * NUM_MILLIS_PER_SECOND, 100,
+                             20 + i));
+    registry.OnAggregate(sym_id);
+  }
+  EXPECT_DOUBLE_EQ(registry.Value(high, sym_id), 26.01);
+  // Only over the bars since it was added.
+  EXPECT_DOUBLE_EQ(registry.Value(low, sym_id), 24.99);
+}
+
+TEST(IndicatorRegistryTest, WarmsFromRestoredHistories) {
+  const int64_t start = 1610144860000;
+  CascadingAggregator live_data({1, 10});
+  IndicatorRegistry live(&live_data, 1);
+  CascadingAggregator restored_data({1, 10});
+  IndicatorRegistry restored(&restored_data, 1);
+  std::vector<IndicatorId> ids;
+  for (IndicatorRegistry* registry : {&live, &restored}) {
+    ids = {registry->Add(IndicatorSpec{EMA, 1, 3}),
+           registry->Add(IndicatorSpec{RSI, 0, 5}),
+           registry->Add(IndicatorSpec{VOLUME_SUM, 1, 2})};
+  }
+  SymbolId sym_id = SymbolTable::Get().Intern("AMC");
+  auto add = [&](int second, double close) {
+    AggregateData agg = MakeAgg(
+        sym_id, start + second * NUM_MILLIS_PER_SECOND, 100 + second, close);
+    live_data.AddData(agg);
+    live.OnAggregate(sym_id);
+    return agg;
+  };
+  // Within the capacity of the histories, which Wilder's averages look
+  // beyond.
+  for (int i = 0; i < 28; ++i) {
+    add(i, 10 + (i % 7) * .1);
+  }
+
+  for (int index = 0; index < 2; ++index) {
+    const AggDataStore::AggDataQueue& history =
+        live_data.GetData(index, sym_id);
+    for (size_t j = history.size(); j > 0; --j) {
+      restored_data.Restore(index, history[j - 1]);
+    }
+  }
+  restored.Warm(sym_id);
+  for (IndicatorId id : ids) {
+    EXPECT_DOUBLE_EQ(restored.Value(id, sym_id), live.Value(id, sym_id));
+  }
+
+  // Both go on alike, closing the restored open windows.
+  for (int i = 28; i < 35; ++i) {
+    restored_data.AddData(add(i, 11 - i * .01));
+    restored.OnAggregate(sym_id);
+    for (IndicatorId id : ids) {
+      EXPECT_DOUBLE_EQ(restored.Value(id, sym_id), live.Value(id, sym_id));
+    }
+  }
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
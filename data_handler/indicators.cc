@@ -0,0 +1,310 @@
+#include "data_handler/indicators.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/ring_buffer.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace pasta {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+class Ema : public Indicator {
+ public:
+  explicit Ema(int period)
+      : period_(period), alpha_(2. / (period + 1)), ema_(kNaN), count_(0) {}
+
+  void OnClose(const AggregateData& bar) override {
+    ema_ = Next(bar.close_);
+    ++count_;
+  }
+
+  void OnUpdate(const AggregateData& bar) override {
+    value_ = count_ + 1 >= period_ ? Next(bar.close_) : kNaN;
+  }
+
+ private:
+  // The average after `close`, seeded with the first close.
+  double Next(double close) const {
+    return std::isnan(ema_) ? close : ema_ + alpha_ * (close - ema_);
+  }
+
+  const int period_;
+  const double alpha_;
+  // The average as of the last closed bar.
+  double ema_;
+  int count_;
+};
+
+class Sma : public Indicator {
+ public:
+  explicit Sma(int period) : period_(period), closes_(period), sum_(0) {}
+
+  void OnClose(const AggregateData& bar) override {
+    if (period_ == 1) return;
+    if (closes_.size() == period_ - 1) {
+      sum_ -= closes_.back();
+      closes_.pop_back();
+    }
+    closes_.push_front(bar.close_);
+    sum_ += bar.close_;
+  }
+
+  void OnUpdate(const AggregateData& bar) override {
+    value_ = closes_.size() == period_ - 1 ? (sum_ + bar.close_) / period_
+                                           : kNaN;
+  }
+
+ private:
+  const int period_;
+  // The closes of the last period_ - 1 closed bars and their sum.
+  RingBuffer<double> closes_;
+  double sum_;
+};
+
+// Sums of the volume and price times volume of the closed bars within the
+// last `period` windows before the open bar.
+class WindowSums {
+ public:
+  WindowSums(int period, int64_t window_ms)
+      : span_ms_((period - 1) * window_ms), bars_(period), vol_(0), pv_(0) {}
+
+  void Add(const AggregateData& bar) {
+    const double pv = TypicalPrice(bar) * bar.vol_;
+    bars_.push_front(Bar{bar.start_, bar.vol_, pv});
+    vol_ += bar.vol_;
+    pv_ += pv;
+  }
+
+  // Drops the bars that are out of range of the open bar `bar`.
+  void Evict(const AggregateData& bar) {
+    while (!bars_.empty() && bars_.back().start < bar.start_ - span_ms_) {
+      vol_ -= bars_.back().vol;
+      pv_ -= bars_.back().pv;
+      bars_.pop_back();
+    }
+  }
+
+  static double TypicalPrice(const AggregateData& bar) {
+    return (bar.high_ + bar.low_ + bar.close_) / 3;
+  }
+
+  int64_t vol() const { return vol_; }
+  double pv() const { return pv_; }
+
+ private:
+  struct Bar {
+    int64_t start;
+    int64_t vol;
+    double pv;
+  };
+
+  const int64_t span_ms_;
+  // At most period - 1 bars after Evict(), so Add() never overwrites one.
+  RingBuffer<Bar> bars_;
+  int64_t vol_;
+  double pv_;
+};
+
+class VolumeSum : public Indicator {
+ public:
+  VolumeSum(int period, int64_t window_ms) : sums_(period, window_ms) {}
+
+  void OnClose(const AggregateData& bar) override { sums_.Add(bar); }
+
+  void OnUpdate(const AggregateData& bar) override {
+    sums_.Evict(bar);
+    value_ = sums_.vol() + bar.vol_;
+  }
+
+ private:
+  WindowSums sums_;
+};
+
+class Vwap : public Indicator {
+ public:
+  Vwap(int period, int64_t window_ms) : sums_(period, window_ms) {}
+
+  void OnClose(const AggregateData& bar) override { sums_.Add(bar); }
+
+  void OnUpdate(const AggregateData& bar) override {
+    sums_.Evict(bar);
+    const int64_t vol = sums_.vol() + bar.vol_;
+    value_ = vol > 0
+                 ? (sums_.pv() + WindowSums::TypicalPrice(bar) * bar.vol_) / vol
+                 : kNaN;
+  }
+
+ private:
+  WindowSums sums_;
+};
+
+// Wilder's smoothing of a series with one sample per bar: the mean of the
+// first `period` samples, then avg = (avg * (period - 1) + sample) / period.
+class WilderAverage {
+ public:
+  explicit WilderAverage(int period)
+      : period_(period), count_(0), sum_(0), avg_(kNaN) {}
+
+  void Add(double sample) {
+    if (count_ < period_) {
+      sum_ += sample;
+      if (++count_ == period_) avg_ = sum_ / period_;
+    } else {
+      avg_ = Next(sample);
+    }
+  }
+
+  // The average if `sample` was added, or NaN.
+  double Next(double sample) const {
+    if (count_ >= period_) return (avg_ * (period_ - 1) + sample) / period_;
+    return count_ + 1 == period_ ? (sum_ + sample) / period_ : kNaN;
+  }
+
+ private:
+  const int period_;
+  int count_;
+  double sum_;
+  double avg_;
+};
+
+class Atr : public Indicator {
+ public:
+  explicit Atr(int period) : atr_(period), prev_close_(kNaN) {}
+
+  void OnClose(const AggregateData& bar) override {
+    atr_.Add(TrueRange(bar));
+    prev_close_ = bar.close_;
+  }
+
+  void OnUpdate(const AggregateData& bar) override {
+    value_ = atr_.Next(TrueRange(bar));
+  }
+
+ private:
+  double TrueRange(const AggregateData& bar) const {
+    double range = bar.high_ - bar.low_;
+    if (std::isnan(prev_close_)) return range;
+    return std::max({range, std::abs(bar.high_ - prev_close_),
+                     std::abs(bar.low_ - prev_close_)});
+  }
+
+  WilderAverage atr_;
+  double prev_close_;
+};
+
+class Rsi : public Indicator {
+ public:
+  explicit Rsi(int period) : gain_(period), loss_(period), prev_close_(kNaN) {}
+
+  void OnClose(const AggregateData& bar) override {
+    if (!std::isnan(prev_close_)) {
+      const double change = bar.close_ - prev_close_;
+      gain_.Add(std::max(change, 0.));
+      loss_.Add(std::max(-change, 0.));
+    }
+    prev_close_ = bar.close_;
+  }
+
+  void OnUpdate(const AggregateData& bar) override {
+    if (std::isnan(prev_close_)) return;
+    const double change = bar.close_ - prev_close_;
+    const double gain = gain_.Next(std::max(change, 0.));
+    const double loss = loss_.Next(std::max(-change, 0.));
+    if (std::isnan(gain)) {
+      value_ = kNaN;
+    } else if (loss == 0) {
+      value_ = gain == 0 ? 50 : 100;
+    } else {
+      value_ = 100 - 100 / (1 + gain / loss);
+    }
+  }
+
+ private:
+  WilderAverage gain_;
+  WilderAverage loss_;
+  double prev_close_;
+};
+
+// The extreme of the highs, or lows, within the last `period` windows. Keeps
+// a monotonic queue of the closed bars that can still become the extreme:
+// each is more extreme than every bar after it, so the oldest is the extreme
+// of the closed bars, and each bar is pushed and popped at most once.
+template <bool kHigh>
+class RollingExtreme : public Indicator {
+ public:
+  RollingExtreme(int period, int64_t window_ms)
+      : span_ms_((period - 1) * window_ms), bars_(period) {}
+
+  void OnClose(const AggregateData& bar) override {
+    const double price = PriceOf(bar);
+    while (!bars_.empty() && !Before(bars_.front().price, price)) {
+      bars_.pop_front();
+    }
+    bars_.push_front(Bar{bar.start_, price});
+  }
+
+  void OnUpdate(const AggregateData& bar) override {
+    while (!bars_.empty() && bars_.back().start < bar.start_ - span_ms_) {
+      bars_.pop_back();
+    }
+    value_ = PriceOf(bar);
+    if (!bars_.empty() && Before(bars_.back().price, value_)) {
+      value_ = bars_.back().price;
+    }
+  }
+
+ private:
+  struct Bar {
+    int64_t start;
+    double price;
+  };
+
+  static double PriceOf(const AggregateData& bar) {
+    return kHigh ? bar.high_ : bar.low_;
+  }
+
+  // Whether `a` is strictly more extreme than `b`.
+  static bool Before(double a, double b) { return kHigh ? a > b : a < b; }
+
+  const int64_t span_ms_;
+  // Newest first, with strictly less extreme prices towards the front. At
+  // most period - 1 bars after eviction, so pushing never overwrites one.
+  RingBuffer<Bar> bars_;
+};
+
+}  // namespace
+
+Indicator::Indicator() : value_(kNaN) {}
+
+std::unique_ptr<Indicator> MakeIndicator(const IndicatorSpec& spec,
+                                         int64_t window_ms) {
+  CHECK_GE(spec.period, 1) << "Invalid indicator period: " << spec.period;
+  switch (spec.type) {
+    case EMA:
+      return std::make_unique<Ema>(spec.period);
+    case SMA:
+      return std::make_unique<Sma>(spec.period);
+    case VOLUME_SUM:
+      return std::make_unique<VolumeSum>(spec.period, window_ms);
+    case VWAP:
+      return std::make_unique<Vwap>(spec.period, window_ms);
+    case ATR:
+      return std::make_unique<Atr>(spec.period);
+    case RSI:
+      return std::make_unique<Rsi>(spec.period);
+    case ROLLING_HIGH:
+      return std::make_unique<RollingExtreme<true>>(spec.period, window_ms);
+    case ROLLING_LOW:
+      return std::make_unique<RollingExtreme<false>>(spec.period, window_ms);
+  }
+  LOG(FATAL) << "Unknown indicator type: " << spec.type;
+}
+
+}  // namespace pasta
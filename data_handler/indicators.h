@@ -0,0 +1,80 @@
+#ifndef PASTA_DATA_HANDLER_INDICATORS_H_
+#define PASTA_DATA_HANDLER_INDICATORS_H_
+
+#include "data_handler/agg_data.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace pasta {
+
+enum IndicatorType {
+  // Exponential moving average of the close, with alpha = 2 / (period + 1).
+  EMA = 0,
+  // Simple moving average of the close over the last `period` bars.
+  SMA = 1,
+  // The volume traded within the last `period` windows.
+  VOLUME_SUM = 2,
+  // The volume weighted typical price (high + low + close) / 3 within the
+  // last `period` windows.
+  VWAP = 3,
+  // Wilder's average true range over `period` bars.
+  ATR = 4,
+  // Wilder's relative strength index over `period` bars, from 0 to 100.
+  RSI = 5,
+  // The highest high and lowest low within the last `period` windows.
+  ROLLING_HIGH = 6,
+  ROLLING_LOW = 7,
+};
+
+// An indicator over a timeframe, e.g. the 20 bar EMA of the 1m bars.
+struct IndicatorSpec {
+  IndicatorType type;
+  // The timeframe index, i.e. a DataStoreIndex.
+  int timeframe;
+  // The number of bars or windows, at least 1.
+  int period;
+
+  bool operator==(const IndicatorSpec& other) const {
+    return type == other.type && timeframe == other.timeframe &&
+           period == other.period;
+  }
+};
+
+// The value of an indicator for one symbol, maintained incrementally as the
+// bars of its timeframe update and close. Both updates and reads are O(1)
+// (amortized for the rolling high and low), and nothing allocates after
+// construction, so a strategy can read an indicator on every aggregate
+// instead of walking the history.
+//
+// The value includes the open bar, as of its latest update, so that it
+// reacts within the window like the data stores do. Indicators over a number
+// of windows count time rather than bars: the windows in which a symbol did
+// not trade are empty, like the data stores leave them out.
+class Indicator {
+ public:
+  virtual ~Indicator() = default;
+
+  // Called with the final state of a bar once the next bar has opened,
+  // before OnUpdate() of the next bar.
+  virtual void OnClose(const AggregateData& bar) = 0;
+
+  // Called with the open bar every time it is updated.
+  virtual void OnUpdate(const AggregateData& bar) = 0;
+
+  // The value as of the last OnUpdate(), or NaN until there is enough data.
+  double value() const { return value_; }
+
+ protected:
+  Indicator();
+
+  double value_;
+};
+
+// Creates the indicator of `spec` over windows of `window_ms` milliseconds.
+std::unique_ptr<Indicator> MakeIndicator(const IndicatorSpec& spec,
+                                         int64_t window_ms);
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_INDICATORS_H_
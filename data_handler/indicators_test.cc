@@ -0,0 +1,212 @@
+#include "data_handler/indicators.h"
+
+#include "data_handler/agg_data.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr int64_t kWindowMs = 10000;
+
+// Straightforward recomputations of the indicators from the whole history,
+// with the open bar last.
+double Sma(const std::vector<AggregateData>& bars, int period) {
+  if (bars.size() < period) return kNaN;
+  double sum = 0;
+  for (int i = bars.size() - period; i < bars.size(); ++i) {
+    sum += bars[i].close_;
+  }
+  return sum / period;
+}
+
+double Ema(const std::vector<AggregateData>& bars, int period) {
+  if (bars.size() < period) return kNaN;
+  double ema = bars[0].close_;
+  for (int i = 1; i < bars.size(); ++i) {
+    ema += 2. / (period + 1) * (bars[i].close_ - ema);
+  }
+  return ema;
+}
+
+// The bars within `period` windows of the open bar.
+std::vector<AggregateData> InRange(const std::vector<AggregateData>& bars,
+                                   int period) {
+  std::vector<AggregateData> in_range;
+  for (const auto& bar : bars) {
+    if (bar.start_ > bars.back().start_ - period * kWindowMs) {
+      in_range.push_back(bar);
+    }
+  }
+  return in_range;
+}
+
+double VolumeSum(const std::vector<AggregateData>& bars, int period) {
+  double vol = 0;
+  for (const auto& bar : InRange(bars, period)) {
+    vol += bar.vol_;
+  }
+  return vol;
+}
+
+double Vwap(const std::vector<AggregateData>& bars, int period) {
+  double vol = 0;
+  double pv = 0;
+  for (const auto& bar : InRange(bars, period)) {
+    vol += bar.vol_;
+    pv += (bar.high_ + bar.low_ + bar.close_) / 3 * bar.vol_;
+  }
+  return vol > 0 ? pv / vol : kNaN;
+}
+
+double RollingHigh(const std::vector<AggregateData>& bars, int period) {
+  double high = -1;
+  for (const auto& bar : InRange(bars, period)) {
+    high = std::max(high, bar.high_);
+  }
+  return high;
+}
+
+double RollingLow(const std::vector<AggregateData>& bars, int period) {
+  double low = 1e9;
+  for (const auto& bar : InRange(bars, period)) {
+    low = std::min(low, bar.low_);
+  }
+  return low;
+}
+
+double Wilder(const std::vector<double>& samples, int period) {
+  if (samples.size() < period) return kNaN;
+  double avg = 0;
+  for (int i = 0; i < period; ++i) {
+    avg += samples[i] / period;
+  }
+  for (int i = period; i < samples.size(); ++i) {
+    avg = (avg * (period - 1) + samples[i]) / period;
+  }
+  return avg;
+}
+
+double Atr(const std::vector<AggregateData>& bars, int period) {
+  std::vector<double> ranges;
+  for (int i = 0; i < bars.size(); ++i) {
+    double range = bars[i].high_ - bars[i].low_;
+    if (i > 0) {
+      range = std::max({range, std::abs(bars[i].high_ - bars[i - 1].close_),
+                        std::abs(bars[i].low_ - bars[i - 1].close_)});
+    }
+    ranges.push_back(range);
+  }
+  return Wilder(ranges, period);
+}
+
+double Rsi(const std::vector<AggregateData>& bars, int period) {
+  std::vector<double> gains;
+  std::vector<double> losses;
+  for (int i = 1; i < bars.size(); ++i) {
+    gains.push_back(std::max(bars[i].close_ - bars[i - 1].close_, 0.));
+    losses.push_back(std::max(bars[i - 1].close_ - bars[i].close_, 0.));
+  }
+  double gain = Wilder(gains, period);
+  double loss = Wilder(losses, period);
+  if (std::isnan(gain)) return kNaN;
+  if (loss == 0) return gain == 0 ? 50 : 100;
+  return 100 - 100 / (1 + gain / loss);
+}
+
+double Reference(IndicatorType type, const std::vector<AggregateData>& bars,
+                 int period) {
+  switch (type) {
+    case EMA:
+      return Ema(bars, period);
+    case SMA:
+      return Sma(bars, period);
+    case VOLUME_SUM:
+      return VolumeSum(bars, period);
+    case VWAP:
+      return Vwap(bars, period);
+    case ATR:
+      return Atr(bars, period);
+    case RSI:
+      return Rsi(bars, period);
+    case ROLLING_HIGH:
+      return RollingHigh(bars, period);
+    case ROLLING_LOW:
+      return RollingLow(bars, period);
+  }
+  return kNaN;
+}
+
+class IndicatorTest : public ::testing::TestWithParam<IndicatorType> {};
+
+TEST_P(IndicatorTest, SameAsRecomputing) {
+  for (int period : {1, 2, 5, 14}) {
+    SCOPED_TRACE(period);
+    std::unique_ptr<Indicator> indicator =
+        MakeIndicator(IndicatorSpec{GetParam(), 0, period}, kWindowMs);
+    EXPECT_TRUE(std::isnan(indicator->value()));
+
+    std::mt19937 rng(period);
+    // Mostly consecutive windows, sometimes a gap of up to 20 windows.
+    std::uniform_int_distribution<int> gap_dist(0, 99);
+    std::uniform_int_distribution<int> updates_dist(1, 3);
+    std::uniform_real_distribution<double> price_dist(10., 11.);
+    std::uniform_int_distribution<int> vol_dist(0, 1000);
+    std::vector<AggregateData> bars;
+    int64_t start = 1610144860000;
+    for (int n = 0; n < 500; ++n) {
+      int gap = gap_dist(rng);
+      start += gap < 80 ? kWindowMs : (gap - 79) * kWindowMs;
+      if (!bars.empty()) indicator->OnClose(bars.back());
+      AggregateData bar;
+      bar.start_ = start;
+      bar.vol_ = 0;
+      bar.open_ = price_dist(rng);
+      bar.high_ = bar.open_;
+      bar.low_ = bar.open_;
+      bars.push_back(bar);
+      for (int u = updates_dist(rng); u > 0; --u) {
+        AggregateData& open = bars.back();
+        open.close_ = price_dist(rng);
+        open.high_ = std::max(open.high_, open.close_ + .01);
+        open.low_ = std::min(open.low_, open.close_ - .01);
+        open.vol_ += vol_dist(rng);
+        open.end_ = open.start_ + kWindowMs / 10 * u;
+        indicator->OnUpdate(open);
+
+        double expected = Reference(GetParam(), bars, period);
+        if (std::isnan(expected)) {
+          ASSERT_TRUE(std::isnan(indicator->value())) << n;
+        } else {
+          ASSERT_NEAR(indicator->value(), expected, 1e-6) << n;
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllTypes, IndicatorTest,
+                         ::testing::Values(EMA, SMA, VOLUME_SUM, VWAP, ATR,
+                                           RSI, ROLLING_HIGH, ROLLING_LOW));
+
+TEST(IndicatorDeathTest, InvalidPeriod) {
+  ASSERT_DEATH(MakeIndicator(IndicatorSpec{SMA, 0, 0}, kWindowMs), "");
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include "data_handler/latency_tracker.h"
+
+#include "absl/flags/flag.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cmath>
+
+ABSL_FLAG(absl::Duration, latency_dump_interval, absl::Minutes(1),
+          "How often to log and reset the latency histograms while the data "
+          "client runs. 0 disables logging.");
+
+namespace pasta {
+
+namespace {
+
+constexpr const char* kStageNames[NUM_LATENCY_STAGE] = {
+    "queue", "parse", "store", "strategy", "order", "tick to order"};
+
+thread_local int64_t current_message_receive_ns = 0;
+
+void AppendStats(const char* name, const LatencyHistogram::Snapshot& snapshot,
+                 std::string* out) {
+  if (snapshot.count() == 0) return;
+  absl::StrAppendFormat(
+      out, "\n  %-13s n=%-10d p50=%.3fus p99=%.3fus p99.9=%.3fus max=%.3fus",
+      name, snapshot.count(), snapshot.Percentile(50) / 1e3,
+      snapshot.Percentile(99) / 1e3, snapshot.Percentile(99.9) / 1e3,
+      snapshot.max() / 1e3);
+}
+
+}  // namespace
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+LatencyHistogram::LatencyHistogram() : max_(0) {
+  for (auto& count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+}
+
+// static
+int LatencyHistogram::BucketIndex(int64_t nanos) {
+  if (nanos < 2 * kSubBuckets) return std::max<int64_t>(nanos, 0);
+  nanos = std::min<int64_t>(nanos, (int64_t{1} << kMaxValueBits) - 1);
+  // Values in [2^exp, 2^(exp+1)) share kSubBuckets buckets.
+  const int exp = 63 - __builtin_clzll(nanos);
+  const int shift = exp - kSubBucketBits;
+  return shift * kSubBuckets + (nanos >> shift);
+}
+
+// static
+int64_t LatencyHistogram::BucketMax(int index) {
+  if (index < 2 * kSubBuckets) return index;
+  const int shift = index / kSubBuckets - 1;
+  const int64_t sub_bucket = index - shift * kSubBuckets;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t nanos) {
+  counts_[BucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+  int64_t max = max_.load(std::memory_order_relaxed);
+  while (nanos > max &&
+         !max_.compare_exchange_weak(max, nanos, std::memory_order_relaxed)) {
+  }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.counts_.resize(kNumBuckets);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    snapshot.counts_[i] = counts_[i].load(std::memory_order_relaxed);
+    snapshot.count_ += snapshot.counts_[i];
+  }
+  snapshot.max_ = max_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::SnapshotAndReset() {
+  Snapshot snapshot;
+  snapshot.counts_.resize(kNumBuckets);
+  snapshot.max_ = max_.exchange(0, std::memory_order_relaxed);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    snapshot.counts_[i] = counts_[i].exchange(0, std::memory_order_relaxed);
+    snapshot.count_ += snapshot.counts_[i];
+  }
+  return snapshot;
+}
+
+int64_t LatencyHistogram::Snapshot::Percentile(double percentile) const {
+  if (count_ == 0) return 0;
+  const int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(percentile / 100 * count_)));
+  int64_t seen = 0;
+  for (int i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) return std::min(BucketMax(i), max_);
+  }
+  return max_;
+}
+
+// ============================================================================
+// LatencyTracker
+// ============================================================================
+
+// static
+LatencyTracker& LatencyTracker::Get() {
+  static LatencyTracker* tracker = new LatencyTracker();
+  return *tracker;
+}
+
+LatencyTracker::LatencyTracker() : dumping_(false) {}
+
+LatencyTracker::~LatencyTracker() { StopDumping(); }
+
+void LatencyTracker::Reset() {
+  for (auto& histogram : histograms_) {
+    histogram.SnapshotAndReset();
+  }
+}
+
+std::string LatencyTracker::Summary() const {
+  std::string summary = "Latencies:";
+  for (int i = 0; i < NUM_LATENCY_STAGE; ++i) {
+    AppendStats(kStageNames[i], histograms_[i].GetSnapshot(), &summary);
+  }
+  return summary;
+}
+
+void LatencyTracker::StartDumping(absl::Duration interval) {
+  absl::MutexLock lock(&mu_);
+  CHECK(!dumping_) << "Latencies are already being dumped.";
+  dumping_ = true;
+  dump_thread_ = std::thread([this, interval]() {
+    absl::MutexLock lock(&mu_);
+    auto stopped = [](bool* dumping) { return !*dumping; };
+    while (!mu_.AwaitWithTimeout(absl::Condition(+stopped, &dumping_),
+                                 interval)) {
+      std::string summary = "Latencies over the last " +
+                            absl::FormatDuration(interval) + ":";
+      for (int i = 0; i < NUM_LATENCY_STAGE; ++i) {
+        AppendStats(kStageNames[i], histograms_[i].SnapshotAndReset(),
+                    &summary);
+      }
+      LOG(INFO) << summary;
+    }
+  });
+}
+
+void LatencyTracker::StopDumping() {
+  {
+    absl::MutexLock lock(&mu_);
+    dumping_ = false;
+  }
+  if (dump_thread_.joinable()) dump_thread_.join();
+}
+
+int64_t CurrentMessageReceiveTime() { return current_message_receive_ns; }
+
+void SetCurrentMessageReceiveTime(int64_t receive_ns) {
+  current_message_receive_ns = receive_ns;
+}
+
+}  // namespace pasta
@@ -0,0 +1,145 @@
+#ifndef PASTA_DATA_HANDLER_LATENCY_TRACKER_H_
+#define PASTA_DATA_HANDLER_LATENCY_TRACKER_H_
+
+#include "absl/flags/flag.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pasta {
+
+// Returns the time of a monotonic clock (nanoseconds). Only differences are
+// meaningful.
+inline int64_t MonotonicNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// A high dynamic range histogram of latencies (nanoseconds). Buckets are
+// linear within each power of two, so every recorded value is known to
+// about 1.6%, from 1ns to about two minutes; larger values are clamped.
+// Record() is lock free and can be called from any thread.
+class LatencyHistogram {
+ public:
+  // A copy of the counts of a histogram.
+  class Snapshot {
+   public:
+    int64_t count() const { return count_; }
+    int64_t max() const { return max_; }
+
+    // Returns the smallest value that `percentile` percent of the values are
+    // less than or equal to, up to the bucket precision. 0 if empty.
+    int64_t Percentile(double percentile) const;
+
+   private:
+    friend class LatencyHistogram;
+
+    std::vector<int64_t> counts_;
+    int64_t count_ = 0;
+    int64_t max_ = 0;
+  };
+
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(int64_t nanos);
+
+  Snapshot GetSnapshot() const;
+
+  // Returns the counts and clears them. Values recorded concurrently end up
+  // in either this snapshot or the next one.
+  Snapshot SnapshotAndReset();
+
+ private:
+  // 2^kSubBucketBits buckets per power of two.
+  static constexpr int kSubBucketBits = 6;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  // Values are clamped to less than 2^kMaxValueBits.
+  static constexpr int kMaxValueBits = 37;
+  static constexpr int kNumBuckets =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  static int BucketIndex(int64_t nanos);
+  // The largest value that falls into bucket `index`.
+  static int64_t BucketMax(int index);
+
+  std::array<std::atomic<int64_t>, kNumBuckets> counts_;
+  std::atomic<int64_t> max_;
+};
+
+// Stages of the path from receiving a data message to submitting an order.
+enum LatencyStage {
+  // From socket receipt to the start of processing, i.e. waiting in the
+  // processing ring. Per message.
+  QUEUE = 0,
+  // Parsing a message. Per message.
+  PARSE = 1,
+  // Updating the data stores. Per aggregate.
+  STORE = 2,
+  // Running the strategy callbacks. Per aggregate.
+  STRATEGY = 3,
+  // Submitting an order to the broker. Per order.
+  ORDER = 4,
+  // From socket receipt of the message that triggered an order to the
+  // submission of the order. Per order.
+  TICK_TO_ORDER = 5,
+  NUM_LATENCY_STAGE = 6,
+};
+
+// Per-stage latency histograms of the process.
+class LatencyTracker {
+ public:
+  static LatencyTracker& Get();
+
+  LatencyTracker();
+  ~LatencyTracker();
+
+  void Record(LatencyStage stage, int64_t nanos) {
+    histograms_[stage].Record(nanos);
+  }
+
+  LatencyHistogram::Snapshot GetSnapshot(LatencyStage stage) const {
+    return histograms_[stage].GetSnapshot();
+  }
+  LatencyHistogram::Snapshot SnapshotAndReset(LatencyStage stage) {
+    return histograms_[stage].SnapshotAndReset();
+  }
+  void Reset();
+
+  // Returns p50, p99, p99.9 and max of every stage that has values.
+  std::string Summary() const;
+
+  // Logs and resets the histograms every `interval` on a background thread,
+  // until StopDumping() is called.
+  void StartDumping(absl::Duration interval);
+  void StopDumping();
+
+ private:
+  std::array<LatencyHistogram, NUM_LATENCY_STAGE> histograms_;
+
+  absl::Mutex mu_;
+  bool dumping_ ABSL_GUARDED_BY(mu_);
+  std::thread dump_thread_;
+};
+
+// The monotonic receive time of the data message the current thread is
+// processing, so that later stages can measure from socket receipt. 0 if
+// unknown.
+int64_t CurrentMessageReceiveTime();
+void SetCurrentMessageReceiveTime(int64_t receive_ns);
+
+}  // namespace pasta
+
+extern absl::Flag<absl::Duration> FLAGS_latency_dump_interval;
+
+#endif  // PASTA_DATA_HANDLER_LATENCY_TRACKER_H_
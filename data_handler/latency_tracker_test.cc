@@ -0,0 +1,130 @@
+#include "data_handler/latency_tracker.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+  LatencyHistogram histogram;
+  for (int64_t i = 0; i < 100; ++i) {
+    histogram.Record(i);
+  }
+  LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 100);
+  EXPECT_EQ(snapshot.max(), 99);
+  EXPECT_EQ(snapshot.Percentile(50), 49);
+  EXPECT_EQ(snapshot.Percentile(99), 98);
+  EXPECT_EQ(snapshot.Percentile(100), 99);
+  EXPECT_EQ(snapshot.Percentile(0), 0);
+}
+
+TEST(LatencyHistogramTest, PercentilesWithinPrecision) {
+  LatencyHistogram histogram;
+  // 1us to 1s.
+  for (int64_t i = 1; i <= 1000000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 1000000);
+  EXPECT_EQ(snapshot.max(), 1000000000);
+  for (double percentile : {1., 50., 90., 99., 99.9, 99.99}) {
+    double expected = percentile * 1e7;
+    EXPECT_LE(std::abs(snapshot.Percentile(percentile) - expected),
+              expected / 64)
+        << percentile;
+  }
+  EXPECT_EQ(snapshot.Percentile(100), 1000000000);
+}
+
+TEST(LatencyHistogramTest, ClampsLargeValues) {
+  LatencyHistogram histogram;
+  histogram.Record(int64_t{1} << 50);
+  histogram.Record(-5);
+  LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 2);
+  EXPECT_EQ(snapshot.max(), int64_t{1} << 50);
+  EXPECT_EQ(snapshot.Percentile(50), 0);
+}
+
+TEST(LatencyHistogramTest, SnapshotAndReset) {
+  LatencyHistogram histogram;
+  histogram.Record(1000);
+  histogram.Record(2000);
+  LatencyHistogram::Snapshot snapshot = histogram.SnapshotAndReset();
+  EXPECT_EQ(snapshot.count(), 2);
+  EXPECT_EQ(snapshot.max(), 2000);
+  snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 0);
+  EXPECT_EQ(snapshot.max(), 0);
+  EXPECT_EQ(snapshot.Percentile(99), 0);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecords) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram, t]() {
+      for (int i = 0; i < 100000; ++i) {
+        histogram.Record(t * 100000 + i);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LatencyHistogram::Snapshot snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count(), 400000);
+  EXPECT_EQ(snapshot.max(), 399999);
+}
+
+TEST(LatencyTrackerTest, RecordsPerStage) {
+  LatencyTracker tracker;
+  tracker.Record(PARSE, 1500);
+  tracker.Record(STORE, 200);
+  tracker.Record(STORE, 300);
+  EXPECT_EQ(tracker.GetSnapshot(PARSE).count(), 1);
+  EXPECT_EQ(tracker.GetSnapshot(STORE).count(), 2);
+  EXPECT_EQ(tracker.GetSnapshot(ORDER).count(), 0);
+  std::string summary = tracker.Summary();
+  EXPECT_NE(summary.find("parse"), std::string::npos);
+  EXPECT_NE(summary.find("store"), std::string::npos);
+  EXPECT_EQ(summary.find("order"), std::string::npos);
+  tracker.Reset();
+  EXPECT_EQ(tracker.GetSnapshot(STORE).count(), 0);
+}
+
+TEST(LatencyTrackerTest, StartAndStopDumping) {
+  LatencyTracker tracker;
+  tracker.Record(QUEUE, 100);
+  tracker.StartDumping(absl::Milliseconds(1));
+  absl::SleepFor(absl::Milliseconds(20));
+  tracker.StopDumping();
+  // Dumping resets the histograms.
+  EXPECT_EQ(tracker.GetSnapshot(QUEUE).count(), 0);
+}
+
+TEST(LatencyTrackerTest, ReceiveTimeIsPerThread) {
+  SetCurrentMessageReceiveTime(42);
+  int64_t other = -1;
+  std::thread thread([&other]() { other = CurrentMessageReceiveTime(); });
+  thread.join();
+  EXPECT_EQ(CurrentMessageReceiveTime(), 42);
+  EXPECT_EQ(other, 0);
+}
+
+}  // namespace
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,101 @@
+#include "data_handler/message_pipeline.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+
+#include <thread>
+
+namespace pasta {
+
+namespace {
+
+// Empty polls before the processing thread starts sleeping between polls.
+constexpr int kIdleSpins = 1000;
+
+}  // namespace
+
+MessagePipeline::MessagePipeline(size_t ring_size, OverflowPolicy policy,
+                                 Consumer consumer)
+    : policy_(policy),
+      consumer_(std::move(consumer)),
+      queue_(ring_size),
+      stopping_(false),
+      pushed_(0),
+      dropped_(0),
+      processed_(0),
+      max_depth_(0) {}
+
+MessagePipeline::~MessagePipeline() { Stop(); }
+
+void MessagePipeline::Start() {
+  CHECK(!thread_.joinable()) << "Message pipeline is already running.";
+  stopping_.store(false, std::memory_order_release);
+  thread_ = std::thread(&MessagePipeline::Drain, this);
+}
+
+void MessagePipeline::Stop() {
+  if (!thread_.joinable()) return;
+  stopping_.store(true, std::memory_order_release);
+  thread_.join();
+  Stats stats = GetStats();
+  LOG(INFO) << "Message pipeline stopped. Pushed: " << stats.pushed
+            << ", dropped: " << stats.dropped
+            << ", max depth: " << stats.max_depth << ".";
+}
+
+bool MessagePipeline::Push(std::string* payload, int64_t receive_ns) {
+  Slot* slot = queue_.BeginPush();
+  while (slot == nullptr) {
+    if (policy_ == DROP) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    std::this_thread::yield();
+    slot = queue_.BeginPush();
+  }
+  slot->payload.swap(*payload);
+  slot->receive_ns = receive_ns;
+  queue_.CommitPush();
+  pushed_.fetch_add(1, std::memory_order_relaxed);
+  int64_t depth = queue_.size();
+  if (depth > max_depth_.load(std::memory_order_relaxed)) {
+    max_depth_.store(depth, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+MessagePipeline::Stats MessagePipeline::GetStats() const {
+  Stats stats;
+  stats.pushed = pushed_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.processed = processed_.load(std::memory_order_relaxed);
+  stats.depth = queue_.size();
+  stats.max_depth = max_depth_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void MessagePipeline::Drain() {
+  int idle = 0;
+  while (true) {
+    const Slot* slot = queue_.Front();
+    if (slot == nullptr) {
+      // Check the ring once more after seeing the stop request, so that
+      // everything pushed before Stop() is processed.
+      if (stopping_.load(std::memory_order_acquire) &&
+          queue_.Front() == nullptr) {
+        return;
+      }
+      if (++idle > kIdleSpins) {
+        absl::SleepFor(absl::Microseconds(50));
+      }
+      continue;
+    }
+    idle = 0;
+    consumer_(slot->payload, slot->receive_ns);
+    queue_.Pop();
+    processed_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace pasta
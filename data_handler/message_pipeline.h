@@ -0,0 +1,89 @@
+#ifndef PASTA_DATA_HANDLER_MESSAGE_PIPELINE_H_
+#define PASTA_DATA_HANDLER_MESSAGE_PIPELINE_H_
+
+#include "data_handler/spsc_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace pasta {
+
+// Hands messages from a network I/O thread to a dedicated processing thread
+// through a preallocated lock-free SPSC ring, so that slow processing does
+// not stall socket reads.
+class MessagePipeline {
+ public:
+  // What Push() does when the ring is full.
+  enum OverflowPolicy {
+    // Wait for the processing thread to free a slot.
+    BLOCK = 0,
+    // Drop the new message.
+    DROP = 1,
+  };
+
+  struct Stats {
+    // Messages accepted by Push().
+    int64_t pushed;
+    // Messages dropped by Push() because the ring was full.
+    int64_t dropped;
+    // Messages handed to the consumer.
+    int64_t processed;
+    // Messages in the ring.
+    int64_t depth;
+    // The largest depth seen by Push().
+    int64_t max_depth;
+  };
+
+  // Called on the processing thread with every message and the time it was
+  // pushed with.
+  typedef std::function<void(const std::string& payload, int64_t receive_ns)>
+      Consumer;
+
+  MessagePipeline(size_t ring_size, OverflowPolicy policy, Consumer consumer);
+  ~MessagePipeline();
+
+  MessagePipeline(const MessagePipeline&) = delete;
+  MessagePipeline& operator=(const MessagePipeline&) = delete;
+
+  // Starts the processing thread.
+  void Start();
+
+  // Processes the messages left in the ring and stops the processing thread.
+  // Must not be called concurrently with Push().
+  void Stop();
+
+  // Called from the I/O thread only. Moves `payload` into the ring by
+  // swapping it with the buffer of a free slot. `receive_ns` is handed to the
+  // consumer along with it. Returns false if the message was dropped.
+  bool Push(std::string* payload, int64_t receive_ns);
+
+  Stats GetStats() const;
+
+ private:
+  struct Slot {
+    std::string payload;
+    int64_t receive_ns;
+  };
+
+  // The processing thread's loop.
+  void Drain();
+
+  const OverflowPolicy policy_;
+  const Consumer consumer_;
+
+  SpscQueue<Slot> queue_;
+  std::thread thread_;
+  std::atomic<bool> stopping_;
+
+  std::atomic<int64_t> pushed_;
+  std::atomic<int64_t> dropped_;
+  std::atomic<int64_t> processed_;
+  std::atomic<int64_t> max_depth_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_MESSAGE_PIPELINE_H_
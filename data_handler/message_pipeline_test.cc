@@ -0,0 +1,78 @@
+#include "data_handler/message_pipeline.h"
+
+#include "absl/synchronization/notification.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+TEST(MessagePipelineTest, ProcessesInOrderOnAnotherThread) {
+  std::vector<std::string> received;
+  std::vector<int64_t> received_times;
+  std::thread::id io_thread = std::this_thread::get_id();
+  bool same_thread = false;
+  MessagePipeline pipeline(
+      4, MessagePipeline::BLOCK,
+      [&](const std::string& payload, int64_t receive_ns) {
+        same_thread |= std::this_thread::get_id() == io_thread;
+        received.push_back(payload);
+        received_times.push_back(receive_ns);
+      });
+  pipeline.Start();
+  std::vector<std::string> sent;
+  std::vector<int64_t> sent_times;
+  for (int i = 0; i < 10000; ++i) {
+    std::string payload = "message " + std::to_string(i);
+    sent.push_back(payload);
+    sent_times.push_back(1000 + i);
+    EXPECT_TRUE(pipeline.Push(&payload, 1000 + i));
+  }
+  pipeline.Stop();
+
+  EXPECT_FALSE(same_thread);
+  EXPECT_EQ(received, sent);
+  EXPECT_EQ(received_times, sent_times);
+  MessagePipeline::Stats stats = pipeline.GetStats();
+  EXPECT_EQ(stats.pushed, 10000);
+  EXPECT_EQ(stats.processed, 10000);
+  EXPECT_EQ(stats.dropped, 0);
+  EXPECT_EQ(stats.depth, 0);
+  EXPECT_LE(stats.max_depth, 4);
+}
+
+TEST(MessagePipelineTest, DropsWhenFull) {
+  absl::Notification release;
+  int processed = 0;
+  MessagePipeline pipeline(
+      2, MessagePipeline::DROP,
+      [&](const std::string& payload, int64_t receive_ns) {
+        release.WaitForNotification();
+        ++processed;
+      });
+  pipeline.Start();
+  int accepted = 0;
+  for (int i = 0; i < 10; ++i) {
+    std::string payload = "message";
+    accepted += pipeline.Push(&payload, i);
+  }
+  // At most one message is being processed and two wait in the ring.
+  EXPECT_LE(accepted, 3);
+  EXPECT_EQ(pipeline.GetStats().dropped, 10 - accepted);
+  release.Notify();
+  pipeline.Stop();
+  EXPECT_EQ(processed, accepted);
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
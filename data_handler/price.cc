@@ -0,0 +1,24 @@
+#include "data_handler/price.h"
+
+#include "absl/strings/str_format.h"
+
+#include <string>
+
+namespace pasta {
+
+std::string FormatPrice(Price price) {
+  const char* sign = price < 0 ? "-" : "";
+  // Not negated, which could overflow.
+  int64_t dollars = price / kTicksPerDollar;
+  int64_t ticks = price % kTicksPerDollar;
+  if (dollars < 0) dollars = -dollars;
+  if (ticks < 0) ticks = -ticks;
+  if (ticks % kTicksPerCent == 0) {
+    return absl::StrFormat("%s%d.%02d", sign, dollars, ticks / kTicksPerCent);
+  }
+  std::string s = absl::StrFormat("%s%d.%04d", sign, dollars, ticks);
+  if (ticks % 10 == 0) s.pop_back();
+  return s;
+}
+
+}  // namespace pasta
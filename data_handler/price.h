@@ -0,0 +1,52 @@
+#ifndef PASTA_DATA_HANDLER_PRICE_H_
+#define PASTA_DATA_HANDLER_PRICE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace pasta {
+
+// A price in ticks of 1/10000 dollar, the finest increment US equities are
+// quoted in. Unlike doubles, prices compare exactly against thresholds and
+// format to the exact string sent to the broker.
+typedef int64_t Price;
+
+constexpr Price kTicksPerDollar = 10000;
+constexpr Price kTicksPerCent = kTicksPerDollar / 100;
+
+constexpr Price Dollars(int64_t dollars) { return dollars * kTicksPerDollar; }
+constexpr Price Cents(int64_t cents) { return cents * kTicksPerCent; }
+
+// Rounds `dollars` to the nearest tick.
+inline Price PriceFromDouble(double dollars) {
+  return std::llround(dollars * kTicksPerDollar);
+}
+
+inline double PriceToDouble(Price price) {
+  return static_cast<double>(price) / kTicksPerDollar;
+}
+
+// The smallest increment that orders may be priced in at `price`: a cent at
+// or above $1, a tick below (Reg NMS Rule 612).
+constexpr Price MinPriceIncrement(Price price) {
+  return price >= kTicksPerDollar ? kTicksPerCent : 1;
+}
+
+// Rounds a non-negative `price` down, or up, to its MinPriceIncrement(). A buy
+// limit price is rounded down so as not to pay more than intended, a sell
+// limit price up so as not to sell for less.
+constexpr Price RoundDownToIncrement(Price price) {
+  return price - price % MinPriceIncrement(price);
+}
+constexpr Price RoundUpToIncrement(Price price) {
+  return RoundDownToIncrement(price + MinPriceIncrement(price) - 1);
+}
+
+// Formats `price` in dollars with at least two decimal places and no
+// trailing zeros beyond, e.g. "12.30" or "0.1234".
+std::string FormatPrice(Price price);
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_PRICE_H_
@@ -0,0 +1,60 @@
+#include "data_handler/price.h"
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace pasta {
+
+namespace {
+
+TEST(PriceTest, FromDouble) {
+  EXPECT_EQ(PriceFromDouble(17.37), 173700);
+  EXPECT_EQ(PriceFromDouble(0.0001), 1);
+  EXPECT_EQ(PriceFromDouble(2.), Dollars(2));
+  // Prices finer than a tick are rounded to the nearest tick.
+  EXPECT_EQ(PriceFromDouble(1.23456), 12346);
+  EXPECT_EQ(PriceFromDouble(-0.05), -Cents(5));
+  EXPECT_DOUBLE_EQ(PriceToDouble(173700), 17.37);
+}
+
+TEST(PriceTest, ExactComparison) {
+  // 0.1 + 0.2 > 0.3 in double, but not in ticks.
+  EXPECT_EQ(PriceFromDouble(0.1) + PriceFromDouble(0.2), PriceFromDouble(0.3));
+  EXPECT_EQ(PriceFromDouble(2.15) + Cents(5), PriceFromDouble(2.2));
+}
+
+TEST(PriceTest, RoundToIncrement) {
+  EXPECT_EQ(MinPriceIncrement(Dollars(1)), Cents(1));
+  EXPECT_EQ(MinPriceIncrement(Dollars(1) - 1), 1);
+
+  EXPECT_EQ(RoundDownToIncrement(123456), 123400);
+  EXPECT_EQ(RoundUpToIncrement(123456), 123500);
+  EXPECT_EQ(RoundDownToIncrement(123400), 123400);
+  EXPECT_EQ(RoundUpToIncrement(123400), 123400);
+  // Sub-penny prices below $1.
+  EXPECT_EQ(RoundDownToIncrement(5123), 5123);
+  EXPECT_EQ(RoundUpToIncrement(5123), 5123);
+  // Rounding up may cross $1.
+  EXPECT_EQ(RoundUpToIncrement(Dollars(1) + 1), Dollars(1) + Cents(1));
+}
+
+TEST(PriceTest, Format) {
+  EXPECT_EQ(FormatPrice(173700), "17.37");
+  EXPECT_EQ(FormatPrice(Dollars(3)), "3.00");
+  EXPECT_EQ(FormatPrice(170000 + Cents(30)), "17.30");
+  EXPECT_EQ(FormatPrice(12345), "1.2345");
+  EXPECT_EQ(FormatPrice(12340), "1.234");
+  EXPECT_EQ(FormatPrice(5), "0.0005");
+  EXPECT_EQ(FormatPrice(0), "0.00");
+  EXPECT_EQ(FormatPrice(-Cents(5)), "-0.05");
+  EXPECT_EQ(FormatPrice(-12345), "-1.2345");
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,305 @@
+#include "data_handler/recorder.h"
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+ABSL_FLAG(int64_t, recorder_buffer_size, 64 << 20,
+          "The size (bytes) of the recorder's in-memory buffers. A buffer is "
+          "written out when it is half full.");
+ABSL_FLAG(absl::Duration, recorder_flush_interval, absl::Seconds(1),
+          "The longest time a recorded message stays in memory before it is "
+          "written out.");
+
+namespace pasta {
+
+namespace {
+
+// How often the flush thread checks whether to write out the buffer.
+constexpr absl::Duration kPollInterval = absl::Milliseconds(10);
+
+std::string ErrnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+}  // namespace
+
+// ============================================================================
+// Recorder
+// ============================================================================
+
+Recorder::Recorder(const std::string& dir)
+    : dir_(dir),
+      buffer_size_(absl::GetFlag(FLAGS_recorder_buffer_size)),
+      flush_interval_(absl::GetFlag(FLAGS_recorder_flush_interval)),
+      fd_(-1),
+      next_day_ns_(std::numeric_limits<int64_t>::min()),
+      stopping_(false),
+      appended_(0),
+      written_(0) {
+  if (!absl::LoadTimeZone("America/New_York", &nyc_)) {
+    LOG(WARNING) << "Failed to load the New York time zone. Record files are "
+                    "rotated on UTC days.";
+    nyc_ = absl::UTCTimeZone();
+  }
+  // Touch the buffers once, so that appending does not page fault.
+  buffer_.resize(buffer_size_);
+  buffer_.clear();
+  flush_buffer_.resize(buffer_size_);
+  flush_buffer_.clear();
+}
+
+Recorder::~Recorder() { Stop(); }
+
+absl::Status Recorder::Start() {
+  CHECK(!thread_.joinable()) << "Recorder is already running.";
+  if (::mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST) {
+    return absl::InternalError(ErrnoMessage("Cannot create " + dir_));
+  }
+  stopping_.store(false, std::memory_order_release);
+  thread_ = std::thread(&Recorder::Flush, this);
+  return absl::OkStatus();
+}
+
+void Recorder::Stop() {
+  if (!thread_.joinable()) return;
+  stopping_.store(true, std::memory_order_release);
+  thread_.join();
+  LOG(INFO) << "Recorder stopped. Appended: " << appended()
+            << ", written: " << written() << ".";
+}
+
+void Recorder::Append(absl::string_view payload, int64_t receive_ns) {
+  const RecordHeader header = {static_cast<uint32_t>(payload.size()), 0,
+                               receive_ns};
+  const size_t padding =
+      RecordSize(payload.size()) - sizeof(header) - payload.size();
+  absl::MutexLock lock(&mu_);
+  buffer_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  buffer_.append(payload.data(), payload.size());
+  buffer_.append(padding, '\0');
+  appended_.fetch_add(1, std::memory_order_relaxed);
+}
+
+absl::Status Recorder::status() const {
+  absl::MutexLock lock(&mu_);
+  return status_;
+}
+
+void Recorder::Flush() {
+  absl::Time last_flush = absl::Now();
+  while (true) {
+    // Swap once more after seeing the stop request, so that everything
+    // appended before Stop() is written.
+    const bool stopping = stopping_.load(std::memory_order_acquire);
+    const absl::Time now = absl::Now();
+    {
+      absl::MutexLock lock(&mu_);
+      if (!buffer_.empty() &&
+          (stopping || buffer_.size() >= buffer_size_ / 2 ||
+           now - last_flush >= flush_interval_)) {
+        // The emptied flush buffer keeps its capacity, so appending does
+        // not allocate.
+        buffer_.swap(flush_buffer_);
+      }
+    }
+    if (!flush_buffer_.empty()) {
+      Write(flush_buffer_);
+      flush_buffer_.clear();
+      last_flush = now;
+    }
+    if (stopping) break;
+    absl::SleepFor(kPollInterval);
+  }
+  CloseFile();
+}
+
+void Recorder::Write(const std::string& buffer) {
+  if (!status().ok()) return;
+  size_t begin = 0;
+  size_t offset = 0;
+  int64_t count = 0;
+  while (offset < buffer.size()) {
+    RecordHeader header;
+    std::memcpy(&header, buffer.data() + offset, sizeof(header));
+    if (fd_ < 0 || header.receive_ns >= next_day_ns_) {
+      // Rotate to the file of the day of this record.
+      WriteToFile(buffer.data() + begin, offset - begin);
+      begin = offset;
+      absl::Status s = OpenFile(
+          absl::ToCivilDay(absl::FromUnixNanos(header.receive_ns), nyc_));
+      if (!s.ok()) {
+        LOG(ERROR) << "Recorder failure: " << s;
+        absl::MutexLock lock(&mu_);
+        status_ = s;
+        return;
+      }
+    }
+    offset += RecordSize(header.length);
+    ++count;
+  }
+  WriteToFile(buffer.data() + begin, offset - begin);
+  if (fd_ >= 0 && ::fsync(fd_) != 0) {
+    LOG(ERROR) << ErrnoMessage("Recorder cannot sync");
+  }
+  written_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void Recorder::WriteToFile(const char* data, size_t size) {
+  while (size > 0 && fd_ >= 0) {
+    ssize_t n = ::write(fd_, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      absl::Status s = absl::InternalError(ErrnoMessage("Recorder write"));
+      LOG(ERROR) << s;
+      absl::MutexLock lock(&mu_);
+      status_ = s;
+      return;
+    }
+    data += n;
+    size -= n;
+  }
+}
+
+absl::Status Recorder::OpenFile(absl::CivilDay day) {
+  CloseFile();
+  const std::string path = dir_ + "/" + absl::FormatCivilTime(day) + ".rec";
+
+  // A file left by an earlier run may end with an incomplete record. Cut it
+  // off, so that appended records stay readable.
+  size_t valid_size = 0;
+  struct stat st;
+  if (::stat(path.c_str(), &st) == 0 && st.st_size > 0) {
+    RecordReader reader;
+    absl::Status s = reader.Open(path);
+    if (!s.ok()) return s;
+    RecordReader::Record record;
+    while (reader.Next(&record)) {
+    }
+    valid_size = reader.offset();
+    if (reader.truncated()) {
+      LOG(WARNING) << "Cutting off an incomplete record at the end of " << path
+                   << ".";
+      if (::truncate(path.c_str(), valid_size) != 0) {
+        return absl::InternalError(ErrnoMessage("Cannot truncate " + path));
+      }
+    }
+  }
+
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    return absl::InternalError(ErrnoMessage("Cannot open " + path));
+  }
+  if (valid_size == 0) {
+    RecordFileHeader header;
+    std::memcpy(header.magic, kRecordFileMagic, sizeof(header.magic));
+    header.version = kRecordFileVersion;
+    header.reserved = 0;
+    WriteToFile(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+  next_day_ns_ = absl::ToUnixNanos(absl::FromCivil(day + 1, nyc_));
+  LOG(INFO) << "Recording to " << path << ".";
+  return absl::OkStatus();
+}
+
+void Recorder::CloseFile() {
+  if (fd_ < 0) return;
+  ::fsync(fd_);
+  ::close(fd_);
+  fd_ = -1;
+}
+
+// ============================================================================
+// RecordReader
+// ============================================================================
+
+RecordReader::RecordReader()
+    : data_(nullptr), size_(0), offset_(0), truncated_(false) {}
+
+RecordReader::~RecordReader() { Close(); }
+
+absl::Status RecordReader::Open(const std::string& path) {
+  Close();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(ErrnoMessage("Cannot open " + path));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return absl::InternalError(ErrnoMessage("Cannot stat " + path));
+  }
+  if (st.st_size < sizeof(RecordFileHeader)) {
+    ::close(fd);
+    return absl::DataLossError(path + " is not a record file.");
+  }
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the file.
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return absl::InternalError(ErrnoMessage("Cannot map " + path));
+  }
+  ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(data);
+  size_ = st.st_size;
+
+  RecordFileHeader header;
+  std::memcpy(&header, data_, sizeof(header));
+  if (std::memcmp(header.magic, kRecordFileMagic, sizeof(header.magic)) != 0 ||
+      header.version != kRecordFileVersion) {
+    Close();
+    return absl::DataLossError(path + " is not a record file.");
+  }
+  Rewind();
+  return absl::OkStatus();
+}
+
+bool RecordReader::Next(Record* record) {
+  if (offset_ == size_) return false;
+  RecordHeader header;
+  if (size_ - offset_ < sizeof(header)) {
+    truncated_ = true;
+    return false;
+  }
+  std::memcpy(&header, data_ + offset_, sizeof(header));
+  if (size_ - offset_ < RecordSize(header.length)) {
+    truncated_ = true;
+    return false;
+  }
+  record->receive_ns = header.receive_ns;
+  record->payload =
+      absl::string_view(data_ + offset_ + sizeof(header), header.length);
+  offset_ += RecordSize(header.length);
+  return true;
+}
+
+void RecordReader::Rewind() {
+  offset_ = sizeof(RecordFileHeader);
+  truncated_ = false;
+}
+
+void RecordReader::Close() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  offset_ = 0;
+  truncated_ = false;
+}
+
+}  // namespace pasta
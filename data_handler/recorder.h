@@ -0,0 +1,156 @@
+#ifndef PASTA_DATA_HANDLER_RECORDER_H_
+#define PASTA_DATA_HANDLER_RECORDER_H_
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/time.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace pasta {
+
+// Record files start with a RecordFileHeader followed by records. A record is
+// a RecordHeader followed by the payload, padded with zeros to a multiple of
+// 8 bytes so that every header is aligned. Integers are in host byte order.
+struct RecordFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct RecordHeader {
+  // The size of the payload (bytes), without padding.
+  uint32_t length;
+  uint32_t reserved;
+  // When the payload was received (Unix nanoseconds).
+  int64_t receive_ns;
+};
+
+constexpr char kRecordFileMagic[8] = {'P', 'A', 'S', 'T', 'A', 'R', 'E', 'C'};
+constexpr uint32_t kRecordFileVersion = 1;
+
+// Returns the size of a record with a payload of `length` bytes.
+inline size_t RecordSize(size_t length) {
+  return sizeof(RecordHeader) + (length + 7) / 8 * 8;
+}
+
+// Appends received data messages to per-day record files in a directory.
+//
+// Append() only copies the message into an in-memory buffer. A background
+// thread swaps the buffer for an empty one when it is large enough or old
+// enough, writes it with a single write per file and fsyncs, so the caller
+// never waits for the disk. Records are written to the file of the New York
+// calendar day they were received on, <dir>/<YYYY-MM-DD>.rec. A file that
+// already exists is appended to.
+class Recorder {
+ public:
+  explicit Recorder(const std::string& dir);
+  ~Recorder();
+
+  Recorder(const Recorder&) = delete;
+  Recorder& operator=(const Recorder&) = delete;
+
+  // Creates the directory if needed and starts the flush thread.
+  absl::Status Start();
+
+  // Writes all appended records and stops the flush thread.
+  void Stop();
+
+  // Appends a record. Thread safe, but records are written in the order
+  // Append() is called, so calls from different threads are not ordered by
+  // `receive_ns`.
+  void Append(absl::string_view payload, int64_t receive_ns);
+
+  // Returns the first write error, if any. Records are dropped after an
+  // error.
+  absl::Status status() const;
+
+  // The number of records appended and written so far.
+  int64_t appended() const { return appended_.load(std::memory_order_relaxed); }
+  int64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+ private:
+  void Flush();
+
+  // Writes `buffer` to the files of the days its records were received on.
+  void Write(const std::string& buffer);
+  void WriteToFile(const char* data, size_t size);
+  absl::Status OpenFile(absl::CivilDay day);
+  void CloseFile();
+
+  const std::string dir_;
+  const size_t buffer_size_;
+  const absl::Duration flush_interval_;
+  absl::TimeZone nyc_;
+
+  mutable absl::Mutex mu_;
+  // Records not yet handed to the flush thread.
+  std::string buffer_ ABSL_GUARDED_BY(mu_);
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+
+  // Owned by the flush thread.
+  std::string flush_buffer_;
+  int fd_;
+  // The first instant after the day of the open file (Unix nanoseconds).
+  int64_t next_day_ns_;
+
+  std::thread thread_;
+  std::atomic<bool> stopping_;
+  std::atomic<int64_t> appended_;
+  std::atomic<int64_t> written_;
+};
+
+// Reads a record file written by Recorder. The file is memory-mapped and
+// records are returned as views into the mapping, so the payloads are never
+// copied. A record cut short at the end of the file, e.g. by a crash while
+// writing, ends the iteration.
+class RecordReader {
+ public:
+  struct Record {
+    int64_t receive_ns;
+    absl::string_view payload;
+  };
+
+  RecordReader();
+  ~RecordReader();
+
+  RecordReader(const RecordReader&) = delete;
+  RecordReader& operator=(const RecordReader&) = delete;
+
+  absl::Status Open(const std::string& path);
+
+  // Reads the next record. The payload stays valid until the reader is
+  // closed or destroyed. Returns false at the end of the file.
+  bool Next(Record* record);
+
+  // Restarts from the first record.
+  void Rewind();
+
+  // Whether the file ends with an incomplete record.
+  bool truncated() const { return truncated_; }
+
+  // The file offset of the next record.
+  size_t offset() const { return offset_; }
+
+  void Close();
+
+ private:
+  const char* data_;
+  size_t size_;
+  size_t offset_;
+  bool truncated_;
+};
+
+}  // namespace pasta
+
+extern absl::Flag<int64_t> FLAGS_recorder_buffer_size;
+extern absl::Flag<absl::Duration> FLAGS_recorder_flush_interval;
+
+#endif  // PASTA_DATA_HANDLER_RECORDER_H_
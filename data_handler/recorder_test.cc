@@ -0,0 +1,152 @@
+#include "data_handler/recorder.h"
+
+#include "absl/flags/flag.h"
+#include "absl/time/civil_time.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+class RecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = ::testing::TempDir() + "/recorder_test_" +
+           std::to_string(::getpid()) + "_" +
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    absl::TimeZone nyc;
+    ASSERT_TRUE(absl::LoadTimeZone("America/New_York", &nyc));
+    // 2021-01-08 23:59:59.5 in New York.
+    day_end_ns_ = absl::ToUnixNanos(
+        absl::FromCivil(absl::CivilSecond(2021, 1, 8, 23, 59, 59), nyc) +
+        absl::Milliseconds(500));
+  }
+
+  std::string Path(const std::string& day) {
+    return dir_ + "/" + day + ".rec";
+  }
+
+  std::vector<std::pair<int64_t, std::string>> ReadAll(
+      const std::string& path) {
+    std::vector<std::pair<int64_t, std::string>> records;
+    RecordReader reader;
+    absl::Status s = reader.Open(path);
+    EXPECT_TRUE(s.ok()) << s;
+    RecordReader::Record record;
+    while (reader.Next(&record)) {
+      records.emplace_back(record.receive_ns, std::string(record.payload));
+    }
+    EXPECT_FALSE(reader.truncated());
+    return records;
+  }
+
+  std::string dir_;
+  int64_t day_end_ns_;
+};
+
+TEST_F(RecorderTest, RecordsAndRotatesDaily) {
+  std::vector<std::pair<int64_t, std::string>> day_1 = {
+      {day_end_ns_ - 1000, "[{\"ev\":\"A\"}]"},
+      {day_end_ns_, ""},
+      {day_end_ns_ + 1, std::string(1000, 'x')},
+  };
+  std::vector<std::pair<int64_t, std::string>> day_2 = {
+      {day_end_ns_ + 500000000, "first of the day"},
+      {day_end_ns_ + 600000000, "second"},
+  };
+  {
+    Recorder recorder(dir_);
+    ASSERT_TRUE(recorder.Start().ok());
+    for (const auto& record : day_1) {
+      recorder.Append(record.second, record.first);
+    }
+    for (const auto& record : day_2) {
+      recorder.Append(record.second, record.first);
+    }
+    recorder.Stop();
+    EXPECT_TRUE(recorder.status().ok());
+    EXPECT_EQ(recorder.appended(), 5);
+    EXPECT_EQ(recorder.written(), 5);
+  }
+  EXPECT_EQ(ReadAll(Path("2021-01-08")), day_1);
+  EXPECT_EQ(ReadAll(Path("2021-01-09")), day_2);
+}
+
+TEST_F(RecorderTest, AppendsToExistingFileAndCutsIncompleteRecord) {
+  {
+    Recorder recorder(dir_);
+    ASSERT_TRUE(recorder.Start().ok());
+    recorder.Append("one", day_end_ns_ - 2);
+    recorder.Append("two", day_end_ns_ - 1);
+  }
+  // Simulate a crash in the middle of writing a record.
+  FILE* file = std::fopen(Path("2021-01-08").c_str(), "a");
+  ASSERT_NE(file, nullptr);
+  std::fputs("partial", file);
+  std::fclose(file);
+  {
+    RecordReader reader;
+    ASSERT_TRUE(reader.Open(Path("2021-01-08")).ok());
+    RecordReader::Record record;
+    int n = 0;
+    while (reader.Next(&record)) ++n;
+    EXPECT_EQ(n, 2);
+    EXPECT_TRUE(reader.truncated());
+  }
+  {
+    Recorder recorder(dir_);
+    ASSERT_TRUE(recorder.Start().ok());
+    recorder.Append("three", day_end_ns_);
+  }
+  std::vector<std::pair<int64_t, std::string>> expected = {
+      {day_end_ns_ - 2, "one"},
+      {day_end_ns_ - 1, "two"},
+      {day_end_ns_, "three"},
+  };
+  EXPECT_EQ(ReadAll(Path("2021-01-08")), expected);
+}
+
+TEST_F(RecorderTest, FlushesPeriodically) {
+  absl::SetFlag(&FLAGS_recorder_flush_interval, absl::Milliseconds(10));
+  Recorder recorder(dir_);
+  absl::SetFlag(&FLAGS_recorder_flush_interval, absl::Seconds(1));
+  ASSERT_TRUE(recorder.Start().ok());
+  recorder.Append("data", day_end_ns_);
+  for (int i = 0; i < 500 && recorder.written() == 0; ++i) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_EQ(recorder.written(), 1);
+  // Written records are readable while recording goes on.
+  std::vector<std::pair<int64_t, std::string>> expected = {
+      {day_end_ns_, "data"}};
+  EXPECT_EQ(ReadAll(Path("2021-01-08")), expected);
+}
+
+TEST(RecordReaderTest, RejectsOtherFiles) {
+  RecordReader reader;
+  EXPECT_FALSE(reader.Open(::testing::TempDir() + "/does_not_exist").ok());
+  std::string path = ::testing::TempDir() + "/not_a_record_file";
+  FILE* file = std::fopen(path.c_str(), "w");
+  ASSERT_NE(file, nullptr);
+  std::fputs("[{\"ev\":\"A\",\"sym\":\"SPCE\"}]", file);
+  std::fclose(file);
+  EXPECT_FALSE(reader.Open(path).ok());
+}
+
+}  // namespace
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,50 @@
+#include "data_handler/replay_driver.h"
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/latency_tracker.h"
+#include "data_handler/recorder.h"
+#include "glog/logging.h"
+
+namespace pasta {
+
+ReplayDriver::ReplayDriver(DataHandler* dh, double speed)
+    : dh_(dh), speed_(speed), stats_{0, 0, absl::ZeroDuration()} {
+  CHECK(speed >= 0) << "Replay speed must not be negative.";
+}
+
+absl::Status ReplayDriver::Replay(const std::string& path) {
+  RecordReader reader;
+  absl::Status s = reader.Open(path);
+  if (!s.ok()) return s;
+
+  const absl::Time start = absl::Now();
+  int64_t first_receive_ns = -1;
+  RecordReader::Record record;
+  while (reader.Next(&record)) {
+    if (speed_ > 0) {
+      if (first_receive_ns < 0) first_receive_ns = record.receive_ns;
+      const absl::Time due =
+          start + absl::Nanoseconds(record.receive_ns - first_receive_ns) /
+                      speed_;
+      const absl::Time now = absl::Now();
+      if (due > now) absl::SleepFor(due - now);
+    }
+    // Latencies are measured from when a message is handed over.
+    SetCurrentMessageReceiveTime(MonotonicNanos());
+    dh_->ProcessMessage(record.payload);
+    ++stats_.messages;
+    stats_.bytes += record.payload.size();
+  }
+  dh_->Flush();
+  stats_.elapsed += absl::Now() - start;
+
+  if (reader.truncated()) {
+    LOG(WARNING) << path << " ends with an incomplete record.";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace pasta
@@ -0,0 +1,44 @@
+#ifndef PASTA_DATA_HANDLER_REPLAY_DRIVER_H_
+#define PASTA_DATA_HANDLER_REPLAY_DRIVER_H_
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "data_handler/data_handler.h"
+
+#include <cstdint>
+#include <string>
+
+namespace pasta {
+
+// Feeds recorded data messages into a DataHandler, exactly as DataClient
+// would have handed them over live, so that registered strategies see the
+// same data in the same order.
+class ReplayDriver {
+ public:
+  struct Stats {
+    int64_t messages;
+    int64_t bytes;
+    absl::Duration elapsed;
+  };
+
+  // With `speed` 0, messages are replayed as fast as possible. Otherwise the
+  // gaps between receive timestamps are kept, sped up by `speed`; 1 replays
+  // in real time.
+  ReplayDriver(DataHandler* dh, double speed);
+
+  // Replays the records of a file written by Recorder. Returns once every
+  // message has been processed, including by the data handler shards.
+  absl::Status Replay(const std::string& path);
+
+  // The totals over all Replay() calls.
+  Stats stats() const { return stats_; }
+
+ private:
+  DataHandler* dh_;
+  double speed_;
+  Stats stats_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_REPLAY_DRIVER_H_
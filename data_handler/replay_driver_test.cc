@@ -0,0 +1,107 @@
+#include "data_handler/replay_driver.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/data_handler_testutil.h"
+#include "data_handler/recorder.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+class ReplayDriverTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = ::testing::TempDir() + "/replay_driver_test_" +
+           std::to_string(::getpid()) + "_" +
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    msgs_ = {GetMessage({kTestCases_1[0]}),
+             GetMessage({kTestCases_1[1], kTestCase_2}),
+             GetMessage({kTestCases_1[2]})};
+    // Received 100ms apart during a trading day.
+    const int64_t receive_ns = 1610144869000000000;
+    Recorder recorder(dir_);
+    ASSERT_TRUE(recorder.Start().ok());
+    for (int i = 0; i < msgs_.size(); ++i) {
+      recorder.Append(msgs_[i], receive_ns + i * 100000000);
+    }
+    recorder.Stop();
+    path_ = dir_ + "/2021-01-08.rec";
+  }
+
+  std::string dir_;
+  std::string path_;
+  std::vector<std::string> msgs_;
+};
+
+TEST_F(ReplayDriverTest, FeedsRecordedMessages) {
+  DataHandler live = DataHandler(nullptr);
+  for (const auto& msg : msgs_) {
+    live.ProcessMessage(msg);
+  }
+
+  DataHandler replayed = DataHandler(nullptr);
+  std::vector<std::string> tickers;
+  ASSERT_TRUE(replayed
+                  .RegisterCallback("record_ticker",
+                                    [&tickers](SymbolId sym_id) {
+                                      tickers.push_back(
+                                          SymbolTable::Get().Name(sym_id));
+                                    })
+                  .ok());
+  ReplayDriver driver(&replayed, 0);
+  absl::Status s = driver.Replay(path_);
+  ASSERT_TRUE(s.ok()) << s;
+
+  EXPECT_EQ(tickers,
+            std::vector<std::string>({"SPCE", "SPCE", "AAPL", "SPCE"}));
+  EXPECT_EQ(driver.stats().messages, 3);
+  EXPECT_EQ(driver.stats().bytes,
+            msgs_[0].size() + msgs_[1].size() + msgs_[2].size());
+  for (const std::string ticker : {"SPCE", "AAPL"}) {
+    for (int index = 0; index < NUM_DATA_STORE; ++index) {
+      const auto& expected =
+          live.GetData(static_cast<DataStoreIndex>(index), ticker);
+      const auto& actual =
+          replayed.GetData(static_cast<DataStoreIndex>(index), ticker);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(actual[i].start_, expected[i].start_);
+        EXPECT_EQ(actual[i].end_, expected[i].end_);
+        EXPECT_EQ(actual[i].vol_, expected[i].vol_);
+        EXPECT_EQ(actual[i].close_, expected[i].close_);
+      }
+    }
+  }
+}
+
+TEST_F(ReplayDriverTest, PacesByReceiveTime) {
+  DataHandler dh = DataHandler(nullptr);
+  // The messages span 200ms, replayed at twice the speed.
+  ReplayDriver driver(&dh, 2);
+  absl::Time start = absl::Now();
+  ASSERT_TRUE(driver.Replay(path_).ok());
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(100));
+}
+
+TEST_F(ReplayDriverTest, MissingFile) {
+  DataHandler dh = DataHandler(nullptr);
+  ReplayDriver driver(&dh, 0);
+  EXPECT_FALSE(driver.Replay(dir_ + "/2021-01-09.rec").ok());
+}
+
+}  // namespace
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
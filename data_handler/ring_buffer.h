@@ -0,0 +1,138 @@
+#ifndef PASTA_DATA_HANDLER_RING_BUFFER_H_
+#define PASTA_DATA_HANDLER_RING_BUFFER_H_
+
+#include "absl/types/span.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace pasta {
+
+// A fixed-capacity ring buffer indexed newest-first, i.e. [0] is the element
+// added by the latest push_front() and [size() - 1] is the oldest one. It is
+// a drop-in replacement for the std::deque usage pattern of pushing to the
+// front and popping from the back, except that pushing to a full buffer
+// overwrites the oldest element instead of growing.
+//
+// Storage is allocated once at construction. Pushing and popping never
+// allocate. Buffers can be moved but not copied, so that a history cannot be
+// copied by accident, e.g. by `auto` taking the result of a getter.
+template <typename T>
+class RingBuffer {
+ public:
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T* pointer;
+    typedef const T& reference;
+
+    const_iterator(const RingBuffer* buffer, size_t index)
+        : buffer_(buffer), index_(index) {}
+
+    reference operator*() const { return (*buffer_)[index_]; }
+    pointer operator->() const { return &(*buffer_)[index_]; }
+    const_iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator iter = *this;
+      ++index_;
+      return iter;
+    }
+    bool operator==(const const_iterator& other) const {
+      return buffer_ == other.buffer_ && index_ == other.index_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    const RingBuffer* buffer_;
+    size_t index_;
+  };
+
+  RingBuffer() : RingBuffer(0) {}
+  explicit RingBuffer(size_t capacity)
+      : buffer_(capacity > 0 ? new T[capacity] : nullptr),
+        capacity_(capacity),
+        head_(0),
+        size_(0) {}
+
+  RingBuffer(const RingBuffer&) = delete;
+  RingBuffer& operator=(const RingBuffer&) = delete;
+  RingBuffer(RingBuffer&& other) = default;
+  RingBuffer& operator=(RingBuffer&& other) = default;
+
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == capacity_; }
+
+  // Adds `value` as the newest element. If the buffer is full, the oldest
+  // element is dropped.
+  void push_front(const T& value) {
+    DCHECK(capacity_ > 0);
+    head_ = head_ == 0 ? capacity_ - 1 : head_ - 1;
+    buffer_[head_] = value;
+    if (size_ < capacity_) ++size_;
+  }
+
+  // Drops the oldest element.
+  void pop_back() {
+    DCHECK(size_ > 0);
+    --size_;
+  }
+
+  // Drops the newest element.
+  void pop_front() {
+    DCHECK(size_ > 0);
+    head_ = head_ + 1 == capacity_ ? 0 : head_ + 1;
+    --size_;
+  }
+
+  void clear() { size_ = 0; }
+
+  T& operator[](size_t i) { return buffer_[Slot(i)]; }
+  const T& operator[](size_t i) const { return buffer_[Slot(i)]; }
+
+  T& front() { return (*this)[0]; }
+  const T& front() const { return (*this)[0]; }
+  T& back() { return (*this)[size_ - 1]; }
+  const T& back() const { return (*this)[size_ - 1]; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+
+  // Returns the history as at most two contiguous newest-first spans. The
+  // elements of the first span are newer than those of the second one, which
+  // is empty unless the history wraps around the end of the storage.
+  std::pair<absl::Span<const T>, absl::Span<const T>> Spans() const {
+    size_t first = std::min(size_, capacity_ - head_);
+    return {absl::Span<const T>(buffer_.get() + head_, first),
+            absl::Span<const T>(buffer_.get(), size_ - first)};
+  }
+
+ private:
+  size_t Slot(size_t i) const {
+    DCHECK(i < size_);
+    size_t slot = head_ + i;
+    return slot >= capacity_ ? slot - capacity_ : slot;
+  }
+
+  std::unique_ptr<T[]> buffer_;
+  size_t capacity_;
+  // Slot of the newest element.
+  size_t head_;
+  size_t size_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_RING_BUFFER_H_
@@ -0,0 +1,91 @@
+#include "data_handler/ring_buffer.h"
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+std::vector<int> ToVector(const RingBuffer<int>& buffer) {
+  return std::vector<int>(buffer.begin(), buffer.end());
+}
+
+TEST(RingBufferTest, NewestFirst) {
+  RingBuffer<int> buffer(3);
+  EXPECT_TRUE(buffer.empty());
+  buffer.push_front(1);
+  buffer.push_front(2);
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_EQ(buffer.front(), 2);
+  EXPECT_EQ(buffer.back(), 1);
+  EXPECT_EQ(buffer[1], 1);
+  buffer.front() = 20;
+  EXPECT_EQ(ToVector(buffer), std::vector<int>({20, 1}));
+}
+
+TEST(RingBufferTest, OverwritesOldestWhenFull) {
+  RingBuffer<int> buffer(3);
+  for (int i = 0; i < 7; ++i) {
+    buffer.push_front(i);
+  }
+  EXPECT_TRUE(buffer.full());
+  EXPECT_EQ(buffer.capacity(), 3);
+  EXPECT_EQ(ToVector(buffer), std::vector<int>({6, 5, 4}));
+  buffer.pop_back();
+  EXPECT_EQ(ToVector(buffer), std::vector<int>({6, 5}));
+  buffer.clear();
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(RingBufferTest, PopFront) {
+  RingBuffer<int> buffer(3);
+  for (int i = 0; i < 4; ++i) {
+    buffer.push_front(i);
+  }
+  buffer.pop_front();
+  EXPECT_EQ(ToVector(buffer), std::vector<int>({2, 1}));
+  buffer.push_front(4);
+  buffer.push_front(5);
+  EXPECT_EQ(ToVector(buffer), std::vector<int>({5, 4, 2}));
+  buffer.pop_front();
+  buffer.pop_front();
+  buffer.pop_front();
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(RingBufferTest, Spans) {
+  RingBuffer<int> buffer(4);
+  for (int i = 0; i < 6; ++i) {
+    buffer.push_front(i);
+    auto spans = buffer.Spans();
+    std::vector<int> joined(spans.first.begin(), spans.first.end());
+    joined.insert(joined.end(), spans.second.begin(), spans.second.end());
+    EXPECT_EQ(joined, ToVector(buffer));
+  }
+}
+
+TEST(RingBufferTest, MovesButDoesNotCopy) {
+  static_assert(!std::is_copy_constructible<RingBuffer<int>>::value,
+                "RingBuffer must not be copyable");
+  static_assert(!std::is_copy_assignable<RingBuffer<int>>::value,
+                "RingBuffer must not be copyable");
+  RingBuffer<int> buffer(2);
+  buffer.push_front(1);
+  RingBuffer<int> moved = std::move(buffer);
+  moved.push_front(2);
+  EXPECT_EQ(ToVector(moved), std::vector<int>({2, 1}));
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,369 @@
+#include "data_handler/snapshot.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace pasta {
+
+namespace {
+
+// The number of words summed before reducing the sums, small enough that
+// neither 64-bit sum overflows.
+constexpr size_t kChecksumBlock = 1 << 16;
+constexpr uint64_t kChecksumModulus = 0xffffffff;
+
+std::string ErrnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+size_t Padded(size_t size) { return (size + 7) / 8 * 8; }
+
+template <typename T>
+void AppendRaw(const T& value, std::string* buffer) {
+  buffer->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Adds the 32-bit words of `size` bytes at `data` to the Fletcher sums `a`
+// and `b`.
+void AddToChecksum(const char* data, size_t size, uint64_t* a, uint64_t* b) {
+  DCHECK(size % sizeof(uint32_t) == 0);
+  const size_t num_words = size / sizeof(uint32_t);
+  for (size_t begin = 0; begin < num_words; begin += kChecksumBlock) {
+    const size_t end = std::min(num_words, begin + kChecksumBlock);
+    uint64_t sum_a = *a;
+    uint64_t sum_b = *b;
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t word;
+      std::memcpy(&word, data + i * sizeof(word), sizeof(word));
+      sum_a += word;
+      sum_b += sum_a;
+    }
+    *a = sum_a % kChecksumModulus;
+    *b = sum_b % kChecksumModulus;
+  }
+}
+
+absl::Status WriteAll(int fd, const char* data, size_t size,
+                      const std::string& path) {
+  while (size > 0) {
+    ssize_t written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return absl::InternalError(ErrnoMessage("Cannot write " + path));
+    }
+    data += written;
+    size -= written;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+SnapshotWindow ToSnapshotWindow(const AggregateData& agg) {
+  SnapshotWindow window;
+  window.vol = agg.vol_;
+  window.acc_vol = agg.acc_vol_;
+  window.day_open = agg.day_open_;
+  window.vwap = agg.vwap_;
+  window.open = agg.open_ticks_;
+  window.close = agg.close_ticks_;
+  window.high = agg.high_ticks_;
+  window.low = agg.low_ticks_;
+  window.start = agg.start_;
+  window.end = agg.end_;
+  return window;
+}
+
+AggregateData FromSnapshotWindow(SymbolId sym_id,
+                                 const SnapshotWindow& window) {
+  AggregateData agg;
+  agg.sym_id_ = sym_id;
+  agg.vol_ = window.vol;
+  agg.acc_vol_ = window.acc_vol;
+  agg.day_open_ = window.day_open;
+  agg.vwap_ = window.vwap;
+  agg.open_ = PriceToDouble(window.open);
+  agg.close_ = PriceToDouble(window.close);
+  agg.high_ = PriceToDouble(window.high);
+  agg.low_ = PriceToDouble(window.low);
+  agg.open_ticks_ = window.open;
+  agg.close_ticks_ = window.close;
+  agg.high_ticks_ = window.high;
+  agg.low_ticks_ = window.low;
+  agg.start_ = window.start;
+  agg.end_ = window.end;
+  return agg;
+}
+
+uint64_t SnapshotChecksum(const char* data, size_t size) {
+  uint64_t a = 0;
+  uint64_t b = 0;
+  AddToChecksum(data, size, &a, &b);
+  return b << 32 | a;
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path,
+                               const std::vector<int64_t>& window_sizes,
+                               int num_parts)
+    : path_(path),
+      window_sizes_(window_sizes),
+      parts_(num_parts),
+      num_symbols_(num_parts, 0),
+      taken_ms_(0),
+      in_progress_(false),
+      parts_left_(0),
+      stopping_(false) {
+  CHECK(num_parts > 0);
+  thread_ = std::thread(&SnapshotWriter::Run, this);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  thread_.join();
+}
+
+bool SnapshotWriter::Begin(int64_t taken_ms) {
+  absl::MutexLock lock(&mu_);
+  if (in_progress_) return false;
+  in_progress_ = true;
+  parts_left_ = parts_.size();
+  taken_ms_ = taken_ms;
+  for (int i = 0; i < parts_.size(); ++i) {
+    // Keeps the capacity, so that snapshots of a steady universe do not
+    // allocate.
+    parts_[i].clear();
+    num_symbols_[i] = 0;
+  }
+  return true;
+}
+
+void SnapshotWriter::AddSymbol(int part, SymbolId sym_id,
+                               CascadingAggregator::SymbolView view) {
+  DCHECK(view.num_timeframes() == window_sizes_.size());
+  bool empty = true;
+  for (int i = 0; i < view.num_timeframes(); ++i) {
+    empty = empty && view[i].empty();
+  }
+  if (empty) return;
+  std::string& buffer = parts_[part];
+  const std::string& ticker = SymbolTable::Get().Name(sym_id);
+  SnapshotSymbol symbol;
+  symbol.ticker_length = ticker.size();
+  symbol.reserved = 0;
+  AppendRaw(symbol, &buffer);
+  buffer.append(ticker);
+  buffer.append(Padded(ticker.size()) - ticker.size(), '\0');
+  for (int i = 0; i < view.num_timeframes(); ++i) {
+    const AggDataStore::AggDataQueue& history = view[i];
+    AppendRaw(uint64_t{history.size()}, &buffer);
+    for (size_t j = history.size(); j > 0; --j) {
+      AppendRaw(ToSnapshotWindow(history[j - 1]), &buffer);
+    }
+  }
+  ++num_symbols_[part];
+}
+
+void SnapshotWriter::EndPart(int part) {
+  absl::MutexLock lock(&mu_);
+  DCHECK(in_progress_ && parts_left_ > 0);
+  --parts_left_;
+}
+
+absl::Status SnapshotWriter::Wait() {
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(
+      +[](bool* in_progress) { return !*in_progress; }, &in_progress_));
+  return status_;
+}
+
+bool SnapshotWriter::HasWork() const {
+  return stopping_ || (in_progress_ && parts_left_ == 0);
+}
+
+void SnapshotWriter::Run() {
+  absl::MutexLock lock(&mu_);
+  while (true) {
+    mu_.Await(absl::Condition(this, &SnapshotWriter::HasWork));
+    if (!in_progress_ || parts_left_ > 0) return;
+    // The parts are not touched by others until the snapshot is written.
+    mu_.Unlock();
+    absl::Status s = Write();
+    if (!s.ok()) LOG(ERROR) << "Snapshot failure: " << s;
+    mu_.Lock();
+    status_ = s;
+    in_progress_ = false;
+  }
+}
+
+absl::Status SnapshotWriter::Write() {
+  SnapshotHeader header;
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.num_timeframes = window_sizes_.size();
+  header.num_symbols = 0;
+  header.size = sizeof(header) + window_sizes_.size() * sizeof(int64_t);
+  header.taken_ms = taken_ms_;
+  uint64_t a = 0;
+  uint64_t b = 0;
+  AddToChecksum(reinterpret_cast<const char*>(window_sizes_.data()),
+                window_sizes_.size() * sizeof(int64_t), &a, &b);
+  for (int i = 0; i < parts_.size(); ++i) {
+    header.num_symbols += num_symbols_[i];
+    header.size += parts_[i].size();
+    AddToChecksum(parts_[i].data(), parts_[i].size(), &a, &b);
+  }
+  header.checksum = b << 32 | a;
+
+  const std::string tmp_path = path_ + ".tmp";
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+  if (fd < 0) {
+    return absl::InternalError(ErrnoMessage("Cannot open " + tmp_path));
+  }
+  absl::Status s = WriteAll(fd, reinterpret_cast<const char*>(&header),
+                            sizeof(header), tmp_path);
+  if (s.ok()) {
+    s = WriteAll(fd, reinterpret_cast<const char*>(window_sizes_.data()),
+                 window_sizes_.size() * sizeof(int64_t), tmp_path);
+  }
+  for (int i = 0; s.ok() && i < parts_.size(); ++i) {
+    s = WriteAll(fd, parts_[i].data(), parts_[i].size(), tmp_path);
+  }
+  if (s.ok() && ::fsync(fd) != 0) {
+    s = absl::InternalError(ErrnoMessage("Cannot sync " + tmp_path));
+  }
+  ::close(fd);
+  if (s.ok() && std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+    s = absl::InternalError(ErrnoMessage("Cannot rename " + tmp_path));
+  }
+  if (!s.ok()) return s;
+  VLOG(1) << "Wrote a snapshot of " << header.num_symbols << " symbols ("
+          << header.size << " bytes) to " << path_ << ".";
+  return absl::OkStatus();
+}
+
+SnapshotReader::SnapshotReader() : data_(nullptr), size_(0), offset_(0) {}
+
+SnapshotReader::~SnapshotReader() { Close(); }
+
+absl::Status SnapshotReader::Open(const std::string& path) {
+  Close();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(ErrnoMessage("Cannot open " + path));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return absl::InternalError(ErrnoMessage("Cannot stat " + path));
+  }
+  if (st.st_size < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    return absl::DataLossError(path + " is not a snapshot.");
+  }
+  void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after closing the file.
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    return absl::InternalError(ErrnoMessage("Cannot map " + path));
+  }
+  ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(data);
+  size_ = st.st_size;
+
+  std::memcpy(&header_, data_, sizeof(header_));
+  if (std::memcmp(header_.magic, kSnapshotMagic, sizeof(header_.magic)) != 0 ||
+      header_.version != kSnapshotVersion) {
+    Close();
+    return absl::DataLossError(path + " is not a snapshot.");
+  }
+  const size_t symbols_offset =
+      sizeof(header_) + header_.num_timeframes * sizeof(int64_t);
+  if (header_.size != size_ || header_.num_timeframes == 0 ||
+      symbols_offset > size_) {
+    Close();
+    return absl::DataLossError(path + " is incomplete.");
+  }
+  if (SnapshotChecksum(data_ + sizeof(header_), size_ - sizeof(header_)) !=
+      header_.checksum) {
+    Close();
+    return absl::DataLossError(path + " is corrupt.");
+  }
+  window_sizes_ = absl::MakeConstSpan(
+      reinterpret_cast<const int64_t*>(data_ + sizeof(header_)),
+      header_.num_timeframes);
+
+  // Walks the symbols once, so that Next() needs no checks.
+  size_t offset = symbols_offset;
+  Symbol symbol;
+  for (uint64_t i = 0; i < header_.num_symbols; ++i) {
+    if (!Parse(&offset, &symbol)) break;
+  }
+  if (offset != size_) {
+    Close();
+    return absl::DataLossError(path + " is corrupt.");
+  }
+  offset_ = symbols_offset;
+  return absl::OkStatus();
+}
+
+bool SnapshotReader::Next(Symbol* symbol) {
+  if (offset_ == size_) return false;
+  return Parse(&offset_, symbol);
+}
+
+bool SnapshotReader::Parse(size_t* offset, Symbol* symbol) const {
+  size_t pos = *offset;
+  if (size_ - pos < sizeof(SnapshotSymbol)) return false;
+  SnapshotSymbol entry;
+  std::memcpy(&entry, data_ + pos, sizeof(entry));
+  pos += sizeof(entry);
+  if (size_ - pos < Padded(entry.ticker_length)) return false;
+  symbol->ticker = absl::string_view(data_ + pos, entry.ticker_length);
+  pos += Padded(entry.ticker_length);
+  symbol->windows.clear();
+  for (uint32_t i = 0; i < header_.num_timeframes; ++i) {
+    uint64_t count;
+    if (size_ - pos < sizeof(count)) return false;
+    std::memcpy(&count, data_ + pos, sizeof(count));
+    pos += sizeof(count);
+    if ((size_ - pos) / sizeof(SnapshotWindow) < count) return false;
+    symbol->windows.push_back(absl::MakeConstSpan(
+        reinterpret_cast<const SnapshotWindow*>(data_ + pos), count));
+    pos += count * sizeof(SnapshotWindow);
+  }
+  *offset = pos;
+  return true;
+}
+
+void SnapshotReader::Close() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  offset_ = 0;
+  window_sizes_ = {};
+}
+
+}  // namespace pasta
@@ -0,0 +1,182 @@
+#ifndef PASTA_DATA_HANDLER_SNAPSHOT_H_
+#define PASTA_DATA_HANDLER_SNAPSHOT_H_
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pasta {
+
+// Snapshot files start with a SnapshotHeader and the window sizes (seconds)
+// of the timeframes as int64_t, followed by one entry per symbol: a
+// SnapshotSymbol, the ticker padded with zeros to a multiple of 8 bytes, and
+// for every timeframe a uint64_t count followed by that many
+// SnapshotWindows, oldest first. Everything is 8-byte aligned, so a mapped
+// file is read in place. Integers are in host byte order.
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_timeframes;
+  uint64_t num_symbols;
+  // The size of the file (bytes).
+  uint64_t size;
+  // SnapshotChecksum() of everything after the header.
+  uint64_t checksum;
+  // When the snapshot was taken (Unix millis).
+  int64_t taken_ms;
+};
+
+struct SnapshotSymbol {
+  uint32_t ticker_length;
+  uint32_t reserved;
+};
+
+// An aggregate window. The window prices are kept in ticks only, and the
+// double prices of AggregateData are restored from them, to the tick.
+struct SnapshotWindow {
+  int64_t vol;
+  int64_t acc_vol;
+  double day_open;
+  double vwap;
+  Price open;
+  Price close;
+  Price high;
+  Price low;
+  int64_t start;
+  int64_t end;
+};
+
+constexpr char kSnapshotMagic[8] = {'P', 'A', 'S', 'T', 'A', 'S', 'N', 'P'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+SnapshotWindow ToSnapshotWindow(const AggregateData& agg);
+AggregateData FromSnapshotWindow(SymbolId sym_id, const SnapshotWindow& window);
+
+// A Fletcher checksum of `size` bytes at `data`, which must be a multiple of
+// 4 bytes.
+uint64_t SnapshotChecksum(const char* data, size_t size);
+
+// Writes snapshots of the histories of all timeframes, e.g. of the shards of
+// a DataHandler, to a file.
+//
+// A snapshot is taken in `num_parts` parts, e.g. one per shard, which are
+// filled concurrently, each by a single thread: Begin() starts a snapshot,
+// every part then gets the histories of its symbols with AddSymbol() and is
+// ended by EndPart(). Adding only copies the windows into the in-memory
+// buffer of the part. A background thread checksums and writes the snapshot
+// once every part ended, to a temporary file that is fsynced and then
+// renamed over `path`, so `path` always holds a whole snapshot.
+class SnapshotWriter {
+ public:
+  SnapshotWriter(const std::string& path,
+                 const std::vector<int64_t>& window_sizes, int num_parts);
+  // Stops the write thread. A snapshot not written by then is dropped.
+  ~SnapshotWriter();
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  // Starts a snapshot taken at `taken_ms` (Unix millis). Returns false, and
+  // starts nothing, while the previous snapshot is being taken or written.
+  bool Begin(int64_t taken_ms);
+
+  // Adds the histories of `sym_id` to `part`. Symbols without any window are
+  // left out.
+  void AddSymbol(int part, SymbolId sym_id,
+                 CascadingAggregator::SymbolView view);
+
+  void EndPart(int part);
+
+  // Blocks until the snapshot begun last, if any, is written, and returns
+  // the status of writing it.
+  absl::Status Wait();
+
+ private:
+  // Whether the write thread has a snapshot to write or is to stop.
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  void Run();
+
+  // Writes the parts to the file.
+  absl::Status Write();
+
+  const std::string path_;
+  const std::vector<int64_t> window_sizes_;
+
+  // The entries of the symbols of each part, and their number. A part is
+  // owned by the thread filling it from Begin() to its EndPart(), and by the
+  // write thread from the last EndPart() until the snapshot is written.
+  std::vector<std::string> parts_;
+  std::vector<uint64_t> num_symbols_;
+  int64_t taken_ms_;
+
+  absl::Mutex mu_;
+  // Whether a snapshot is begun and not written yet.
+  bool in_progress_ ABSL_GUARDED_BY(mu_);
+  // The number of parts of it not ended yet.
+  int parts_left_ ABSL_GUARDED_BY(mu_);
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_);
+
+  std::thread thread_;
+};
+
+// Reads a snapshot file written by SnapshotWriter. The file is
+// memory-mapped, checked whole on opening and read in place, so the windows
+// are never copied before they are restored.
+class SnapshotReader {
+ public:
+  struct Symbol {
+    absl::string_view ticker;
+    // The windows of each timeframe, oldest first.
+    absl::InlinedVector<absl::Span<const SnapshotWindow>, 8> windows;
+  };
+
+  SnapshotReader();
+  ~SnapshotReader();
+
+  SnapshotReader(const SnapshotReader&) = delete;
+  SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+  // Maps the file and checks its header, size, checksum and structure.
+  // Returns DataLossError if the file is not a whole snapshot.
+  absl::Status Open(const std::string& path);
+
+  const SnapshotHeader& header() const { return header_; }
+
+  // The window sizes (seconds) in timeframe order.
+  absl::Span<const int64_t> window_sizes() const { return window_sizes_; }
+
+  // Reads the next symbol. The views stay valid until the reader is closed
+  // or destroyed. Returns false after the last symbol.
+  bool Next(Symbol* symbol);
+
+  void Close();
+
+ private:
+  // Reads the symbol at `*offset` and advances past it, or returns false if
+  // it extends beyond the file.
+  bool Parse(size_t* offset, Symbol* symbol) const;
+
+  const char* data_;
+  size_t size_;
+  size_t offset_;
+  SnapshotHeader header_;
+  absl::Span<const int64_t> window_sizes_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_SNAPSHOT_H_
@@ -0,0 +1,154 @@
+#include "data_handler/snapshot.h"
+
+#include "absl/status/status.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kStart = 1610144860000;
+
+AggregateData MakeAgg(SymbolId sym_id, int64_t start, Price close) {
+  AggregateData agg;
+  agg.sym_id_ = sym_id;
+  agg.vol_ = 100;
+  agg.acc_vol_ = 5000;
+  agg.vwap_ = 10.5;
+  agg.open_ticks_ = close - 100;
+  agg.close_ticks_ = close;
+  agg.high_ticks_ = close + 200;
+  agg.low_ticks_ = close - 200;
+  agg.open_ = PriceToDouble(agg.open_ticks_);
+  agg.close_ = PriceToDouble(agg.close_ticks_);
+  agg.high_ = PriceToDouble(agg.high_ticks_);
+  agg.low_ = PriceToDouble(agg.low_ticks_);
+  agg.start_ = start;
+  agg.end_ = start + NUM_MILLIS_PER_SECOND;
+  return agg;
+}
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  SnapshotTest()
+      : path_(::testing::TempDir() + "/snapshot_test.snapshot"),
+        agg_data_({1, 10}) {
+    for (const char* ticker : {"SNAP_A", "SNAP_B", "SNAP_C"}) {
+      sym_ids_.push_back(SymbolTable::Get().Intern(ticker));
+    }
+    for (int t = 0; t < 45; ++t) {
+      for (int i = 0; i < sym_ids_.size(); ++i) {
+        // The last symbol stops early.
+        if (i == 2 && t > 3) continue;
+        agg_data_.AddData(MakeAgg(sym_ids_[i], kStart + t * 1000,
+                                  Dollars(10 + i) + t * 10));
+      }
+    }
+  }
+
+  // Writes the symbols in two parts.
+  void Write() {
+    SnapshotWriter writer(path_, {1, 10}, 2);
+    ASSERT_TRUE(writer.Begin(kStart + 45000));
+    // A symbol without data is left out.
+    SymbolId empty = SymbolTable::Get().Intern("SNAP_EMPTY");
+    writer.AddSymbol(0, empty, agg_data_.GetSymbolView(empty));
+    for (int i = 0; i < sym_ids_.size(); ++i) {
+      writer.AddSymbol(i % 2, sym_ids_[i],
+                       agg_data_.GetSymbolView(sym_ids_[i]));
+    }
+    writer.EndPart(1);
+    // Not done before every part ended.
+    EXPECT_FALSE(writer.Begin(kStart + 46000));
+    writer.EndPart(0);
+    EXPECT_TRUE(writer.Wait().ok());
+  }
+
+  std::string ReadFile() {
+    std::ifstream in(path_, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  }
+
+  void WriteFile(const std::string& data) {
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    out << data;
+  }
+
+  const std::string path_;
+  CascadingAggregator agg_data_;
+  std::vector<SymbolId> sym_ids_;
+};
+
+TEST_F(SnapshotTest, RestoresTheHistories) {
+  Write();
+  SnapshotReader reader;
+  ASSERT_TRUE(reader.Open(path_).ok());
+  EXPECT_EQ(reader.header().taken_ms, kStart + 45000);
+  EXPECT_EQ(reader.header().num_symbols, 3);
+  EXPECT_EQ(std::vector<int64_t>(reader.window_sizes().begin(),
+                                 reader.window_sizes().end()),
+            std::vector<int64_t>({1, 10}));
+
+  CascadingAggregator restored({1, 10});
+  std::vector<std::string> tickers;
+  SnapshotReader::Symbol symbol;
+  while (reader.Next(&symbol)) {
+    tickers.emplace_back(symbol.ticker);
+    SymbolId sym_id = SymbolTable::Get().Intern(symbol.ticker);
+    ASSERT_EQ(symbol.windows.size(), 2);
+    for (int i = 0; i < 2; ++i) {
+      for (const SnapshotWindow& window : symbol.windows[i]) {
+        restored.Restore(i, FromSnapshotWindow(sym_id, window));
+      }
+    }
+  }
+  // Part by part.
+  EXPECT_EQ(tickers,
+            std::vector<std::string>({"SNAP_A", "SNAP_C", "SNAP_B"}));
+  for (SymbolId sym_id : sym_ids_) {
+    for (int i = 0; i < 2; ++i) {
+      const AggDataStore::AggDataQueue& expected = agg_data_.GetData(i, sym_id);
+      const AggDataStore::AggDataQueue& actual = restored.GetData(i, sym_id);
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int j = 0; j < expected.size(); ++j) {
+        EXPECT_TRUE(actual[j] == expected[j]);
+      }
+    }
+  }
+}
+
+TEST_F(SnapshotTest, RejectsDamagedFiles) {
+  SnapshotReader reader;
+  EXPECT_TRUE(absl::IsNotFound(reader.Open(path_ + ".missing")));
+
+  Write();
+  const std::string data = ReadFile();
+  std::string corrupt = data;
+  corrupt[data.size() / 2] ^= 1;
+  WriteFile(corrupt);
+  EXPECT_TRUE(absl::IsDataLoss(reader.Open(path_)));
+
+  WriteFile(data.substr(0, data.size() - sizeof(SnapshotWindow)));
+  EXPECT_TRUE(absl::IsDataLoss(reader.Open(path_)));
+
+  WriteFile(data);
+  EXPECT_TRUE(reader.Open(path_).ok());
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,103 @@
+#ifndef PASTA_DATA_HANDLER_SPSC_QUEUE_H_
+#define PASTA_DATA_HANDLER_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace pasta {
+
+// A bounded lock-free single-producer/single-consumer queue. All slots are
+// allocated at construction and reused, so callers that keep buffers in the
+// slots (e.g. by swapping strings in and out) never allocate in steady state.
+//
+// The producer fills the slot returned by BeginPush() and publishes it with
+// CommitPush(). The consumer reads the slot returned by Front() and releases
+// it with Pop().
+template <typename T>
+class SpscQueue {
+ public:
+  // `capacity` is rounded up to a power of two.
+  explicit SpscQueue(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        slots_(new T[mask_ + 1]),
+        head_(0),
+        cached_tail_(0),
+        tail_(0),
+        cached_head_(0) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Producer only. Returns the slot to fill next, or nullptr if the queue is
+  // full.
+  T* BeginPush() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cached_tail_ > mask_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head - cached_tail_ > mask_) return nullptr;
+    }
+    return &slots_[head & mask_];
+  }
+
+  // Producer only. Publishes the slot returned by BeginPush().
+  void CommitPush() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  // Consumer only. Returns the oldest published slot, or nullptr if the queue
+  // is empty.
+  T* Front() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail == cached_head_) return nullptr;
+    }
+    return &slots_[tail & mask_];
+  }
+
+  // Consumer only. Releases the slot returned by Front().
+  void Pop() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+  }
+
+  // The number of published slots not yet popped. Exact only when called from
+  // the producer or the consumer thread while the other one is idle, and only
+  // approximate from any other thread, e.g. a stats reader. `tail_` is loaded
+  // first: both only grow and `tail_` never passes `head_`, so the later load
+  // of `head_` is at least the earlier one of `tail_`.
+  size_t size() const {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return head_.load(std::memory_order_acquire) - tail;
+  }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    return power;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Written by the producer. Each side caches the other side's index so that
+  // it only touches the other side's cache line when the queue looks full or
+  // empty.
+  alignas(kCacheLineSize) std::atomic<size_t> head_;
+  size_t cached_tail_;
+
+  // Written by the consumer.
+  alignas(kCacheLineSize) std::atomic<size_t> tail_;
+  size_t cached_head_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_SPSC_QUEUE_H_
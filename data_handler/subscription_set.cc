@@ -0,0 +1,75 @@
+#include "data_handler/subscription_set.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// Appends the messages of `action` for `tickers` to `msgs`.
+void AppendMessages(const std::string& action,
+                    const std::vector<std::string>& tickers,
+                    std::vector<std::string>* msgs) {
+  for (size_t i = 0; i < tickers.size();
+       i += SubscriptionSet::kMaxTickersPerMessage) {
+    const size_t end = std::min(
+        tickers.size(), i + SubscriptionSet::kMaxTickersPerMessage);
+    std::string params;
+    for (size_t j = i; j < end; ++j) {
+      absl::StrAppend(&params, j > i ? "," : "", "A.", tickers[j]);
+    }
+    msgs->push_back(absl::StrCat("{\"action\":\"", action,
+                                 "\",\"params\":\"", params, "\"}"));
+  }
+}
+
+}  // namespace
+
+SubscriptionSet::SubscriptionSet(const std::vector<std::string>& tickers)
+    : requested_(tickers.begin(), tickers.end()) {}
+
+void SubscriptionSet::Add(const std::vector<std::string>& tickers) {
+  absl::MutexLock lock(&mu_);
+  requested_.insert(tickers.begin(), tickers.end());
+}
+
+void SubscriptionSet::Remove(const std::vector<std::string>& tickers) {
+  absl::MutexLock lock(&mu_);
+  for (const std::string& ticker : tickers) {
+    requested_.erase(ticker);
+  }
+}
+
+std::vector<std::string> SubscriptionSet::TakeMessages() {
+  absl::MutexLock lock(&mu_);
+  std::vector<std::string> to_remove;
+  std::set_difference(sent_.begin(), sent_.end(), requested_.begin(),
+                      requested_.end(), std::back_inserter(to_remove));
+  std::vector<std::string> to_add;
+  std::set_difference(requested_.begin(), requested_.end(), sent_.begin(),
+                      sent_.end(), std::back_inserter(to_add));
+  std::vector<std::string> msgs;
+  AppendMessages("unsubscribe", to_remove, &msgs);
+  AppendMessages("subscribe", to_add, &msgs);
+  sent_ = requested_;
+  return msgs;
+}
+
+void SubscriptionSet::Reset() {
+  absl::MutexLock lock(&mu_);
+  sent_.clear();
+}
+
+std::vector<std::string> SubscriptionSet::Requested() const {
+  absl::MutexLock lock(&mu_);
+  return std::vector<std::string>(requested_.begin(), requested_.end());
+}
+
+}  // namespace pasta
@@ -0,0 +1,51 @@
+#ifndef PASTA_DATA_HANDLER_SUBSCRIPTION_SET_H_
+#define PASTA_DATA_HANDLER_SUBSCRIPTION_SET_H_
+
+#include "absl/synchronization/mutex.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+// The tickers whose aggregates the data client subscribes to, as requested
+// and as sent on the connection. Requests only change the requested set;
+// TakeMessages() then turns the difference to the sent set into as few
+// subscribe and unsubscribe messages as possible, so a burst of requests,
+// including ones that cancel out, costs one round of messages.
+//
+// The ticker "*" stands for the whole market.
+class SubscriptionSet {
+ public:
+  explicit SubscriptionSet(const std::vector<std::string>& tickers);
+
+  SubscriptionSet(const SubscriptionSet&) = delete;
+  SubscriptionSet& operator=(const SubscriptionSet&) = delete;
+
+  // Requests or releases tickers. Thread-safe.
+  void Add(const std::vector<std::string>& tickers);
+  void Remove(const std::vector<std::string>& tickers);
+
+  // Returns the messages that bring the subscriptions of the connection in
+  // line with the requested tickers, at most kMaxTickersPerMessage each, and
+  // considers them sent. Unsubscribe messages come first.
+  std::vector<std::string> TakeMessages();
+
+  // Considers nothing sent, e.g. for a new connection.
+  void Reset();
+
+  // Returns the requested tickers, in order.
+  std::vector<std::string> Requested() const;
+
+  static constexpr int kMaxTickersPerMessage = 500;
+
+ private:
+  mutable absl::Mutex mu_;
+  std::set<std::string> requested_ ABSL_GUARDED_BY(mu_);
+  std::set<std::string> sent_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_SUBSCRIPTION_SET_H_
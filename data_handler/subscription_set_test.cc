@@ -0,0 +1,58 @@
+#include "data_handler/subscription_set.h"
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+TEST(SubscriptionSetTest, SendsTheDifference) {
+  SubscriptionSet set({"*"});
+  EXPECT_EQ(set.TakeMessages(), std::vector<std::string>(
+                                    {"{\"action\":\"subscribe\",\"params\":"
+                                     "\"A.*\"}"}));
+  EXPECT_TRUE(set.TakeMessages().empty());
+
+  set.Add({"TSLA", "AAPL"});
+  set.Remove({"*"});
+  // Cancels out.
+  set.Add({"GME"});
+  set.Remove({"GME"});
+  EXPECT_EQ(set.TakeMessages(),
+            std::vector<std::string>(
+                {"{\"action\":\"unsubscribe\",\"params\":\"A.*\"}",
+                 "{\"action\":\"subscribe\",\"params\":\"A.AAPL,A.TSLA\"}"}));
+  EXPECT_EQ(set.Requested(), std::vector<std::string>({"AAPL", "TSLA"}));
+
+  // A new connection subscribes to the whole universe again.
+  set.Reset();
+  EXPECT_EQ(set.TakeMessages(),
+            std::vector<std::string>(
+                {"{\"action\":\"subscribe\",\"params\":\"A.AAPL,A.TSLA\"}"}));
+}
+
+TEST(SubscriptionSetTest, SplitsLargeChanges) {
+  SubscriptionSet set({});
+  EXPECT_TRUE(set.TakeMessages().empty());
+  std::vector<std::string> tickers;
+  for (int i = 0; i < 2 * SubscriptionSet::kMaxTickersPerMessage + 1; ++i) {
+    tickers.push_back("T" + std::to_string(i));
+  }
+  set.Add(tickers);
+  std::vector<std::string> msgs = set.TakeMessages();
+  ASSERT_EQ(msgs.size(), 3);
+  EXPECT_EQ(msgs[2], "{\"action\":\"subscribe\",\"params\":\"A.T999\"}");
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,59 @@
+#include "data_handler/symbol_table.h"
+
+#include "absl/flags/flag.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "glog/logging.h"
+
+ABSL_FLAG(int64_t, symbol_table_capacity, 12000,
+          "The number of symbols the process-wide symbol table is pre-sized "
+          "for. Should cover the full US equity universe so that no "
+          "rehashing happens during the opening burst.");
+
+namespace pasta {
+
+// static
+SymbolTable& SymbolTable::Get() {
+  static SymbolTable* table =
+      new SymbolTable(absl::GetFlag(FLAGS_symbol_table_capacity));
+  return *table;
+}
+
+SymbolTable::SymbolTable(int64_t capacity) : capacity_(capacity) {
+  ids_.reserve(capacity);
+}
+
+SymbolId SymbolTable::Intern(absl::string_view symbol) {
+  absl::MutexLock lock(&mu_);
+  auto iter = ids_.find(symbol);
+  if (iter != ids_.end()) {
+    return iter->second;
+  }
+  SymbolId id = names_.size();
+  CHECK(id != kInvalidSymbolId) << "Symbol table is full.";
+  if (id == capacity_) {
+    LOG(WARNING) << "Symbol table grows beyond " << capacity_ << " symbols.";
+  }
+  names_.emplace_back(symbol);
+  ids_.emplace(symbol, id);
+  return id;
+}
+
+SymbolId SymbolTable::Find(absl::string_view symbol) const {
+  absl::ReaderMutexLock lock(&mu_);
+  auto iter = ids_.find(symbol);
+  return iter == ids_.end() ? kInvalidSymbolId : iter->second;
+}
+
+const std::string& SymbolTable::Name(SymbolId id) const {
+  absl::ReaderMutexLock lock(&mu_);
+  CHECK(id < names_.size()) << "Unknown symbol ID " << id << ".";
+  return names_[id];
+}
+
+size_t SymbolTable::size() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return names_.size();
+}
+
+}  // namespace pasta
@@ -0,0 +1,64 @@
+#ifndef PASTA_DATA_HANDLER_SYMBOL_TABLE_H_
+#define PASTA_DATA_HANDLER_SYMBOL_TABLE_H_
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+
+namespace pasta {
+
+// Dense integer ID of an interned ticker symbol. IDs are assigned in
+// interning order starting from 0, so they can index flat arrays.
+typedef uint32_t SymbolId;
+
+constexpr SymbolId kInvalidSymbolId = std::numeric_limits<SymbolId>::max();
+
+// Interns ticker symbols into dense SymbolIds. Symbols are never removed, so
+// an ID stays valid for the lifetime of the table.
+class SymbolTable {
+ public:
+  // Returns the process-wide symbol table, sized by
+  // FLAGS_symbol_table_capacity.
+  static SymbolTable& Get();
+
+  explicit SymbolTable(int64_t capacity);
+
+  SymbolTable(const SymbolTable&) = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  // Returns the ID of `symbol`, assigning the next free ID if it has not been
+  // seen before.
+  SymbolId Intern(absl::string_view symbol);
+
+  // Returns the ID of `symbol`, or kInvalidSymbolId if it has not been
+  // interned.
+  SymbolId Find(absl::string_view symbol) const;
+
+  // Returns the symbol that `id` was assigned to. The reference stays valid
+  // for the lifetime of the table.
+  const std::string& Name(SymbolId id) const;
+
+  // Returns the number of interned symbols, i.e. one past the largest ID.
+  size_t size() const;
+
+ private:
+  // The number of symbols the table is sized for.
+  const int64_t capacity_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, SymbolId> ids_ ABSL_GUARDED_BY(mu_);
+  // A deque so that references handed out by Name() survive growth.
+  std::deque<std::string> names_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace pasta
+
+extern absl::Flag<int64_t> FLAGS_symbol_table_capacity;
+
+#endif  // PASTA_DATA_HANDLER_SYMBOL_TABLE_H_
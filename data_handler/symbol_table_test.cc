@@ -0,0 +1,46 @@
+#include "data_handler/symbol_table.h"
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace pasta {
+
+namespace {
+
+TEST(SymbolTableTest, InternAssignsDenseIds) {
+  SymbolTable table(2);
+  EXPECT_EQ(table.Intern("SPCE"), 0);
+  EXPECT_EQ(table.Intern("AAPL"), 1);
+  EXPECT_EQ(table.Intern("SPCE"), 0);
+  // Growing beyond the pre-sized capacity still works.
+  EXPECT_EQ(table.Intern("MSFT"), 2);
+  EXPECT_EQ(table.size(), 3);
+}
+
+TEST(SymbolTableTest, FindAndName) {
+  SymbolTable table(16);
+  SymbolId id = table.Intern("AAPL");
+  const std::string& name = table.Name(id);
+  for (int i = 0; i < 1000; ++i) {
+    table.Intern("T" + std::to_string(i));
+  }
+  EXPECT_EQ(table.Find("AAPL"), id);
+  EXPECT_EQ(table.Find("NOPE"), kInvalidSymbolId);
+  // References returned by Name() survive growth of the table.
+  EXPECT_EQ(name, "AAPL");
+  EXPECT_EQ(table.Name(table.Find("T999")), "T999");
+}
+
+TEST(SymbolTableTest, UnknownIdDies) {
+  SymbolTable table(16);
+  ASSERT_DEATH(table.Name(0), "");
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+#include "data_handler/timer_wheel.h"
+
+#include "glog/logging.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace pasta {
+
+TimerWheel::TimerWheel(int64_t tick_ms, int64_t now_ms)
+    : tick_ms_(tick_ms),
+      now_(now_ms / tick_ms + 1),
+      size_(0),
+      slots_(kLevels * kSlots, kNone),
+      occupied_{},
+      free_(kNone) {
+  CHECK(tick_ms > 0);
+}
+
+void TimerWheel::Schedule(int64_t deadline_ms, uint64_t payload) {
+  int32_t index = free_;
+  if (index == kNone) {
+    index = entries_.size();
+    entries_.emplace_back();
+  } else {
+    free_ = entries_[index].next;
+  }
+  Entry& entry = entries_[index];
+  // Rounded up, so that a timer never expires before its deadline.
+  entry.deadline = (deadline_ms + tick_ms_ - 1) / tick_ms_;
+  entry.payload = payload;
+  Insert(index);
+  ++size_;
+}
+
+void TimerWheel::Insert(int32_t index) {
+  Entry& entry = entries_[index];
+  const int64_t delta = entry.deadline - now_;
+  int slot;
+  if (delta < 0) {
+    // Already due. Expires with the next tick.
+    slot = now_ & (kSlots - 1);
+  } else {
+    int level = 0;
+    while (level < kLevels && delta >> (kLevelBits * (level + 1)) != 0) {
+      ++level;
+    }
+    if (level < kLevels) {
+      slot = level * kSlots +
+             ((entry.deadline >> (kLevelBits * level)) & (kSlots - 1));
+    } else {
+      // Beyond the span of the wheels. Parked in the last slot of the
+      // coarsest wheel to come around, and re-inserted from there.
+      level = kLevels - 1;
+      const int64_t last = now_ + (int64_t{1} << (kLevelBits * kLevels)) - 1;
+      slot = level * kSlots + ((last >> (kLevelBits * level)) & (kSlots - 1));
+    }
+  }
+  entry.next = slots_[slot];
+  slots_[slot] = index;
+  occupied_[slot / kSlots] |= uint64_t{1} << (slot % kSlots);
+}
+
+int TimerWheel::Cascade(int level, int slot) {
+  int32_t index = slots_[level * kSlots + slot];
+  slots_[level * kSlots + slot] = kNone;
+  occupied_[level] &= ~(uint64_t{1} << slot);
+  while (index != kNone) {
+    const int32_t next = entries_[index].next;
+    Insert(index);
+    index = next;
+  }
+  return slot;
+}
+
+int64_t TimerWheel::NextEvent() const {
+  int64_t next = INT64_MAX;
+  for (int level = 0; level < kLevels; ++level) {
+    if (occupied_[level] == 0) continue;
+    // Slots of the level are visited at multiples of its slot width, the
+    // first of them being `block`.
+    const int shift = kLevelBits * level;
+    const int64_t block = (now_ + (int64_t{1} << shift) - 1) >> shift;
+    const int offset = block & (kSlots - 1);
+    // Rotates the slot at `offset` to bit 0.
+    const uint64_t rotated =
+        offset == 0 ? occupied_[level]
+                    : occupied_[level] >> offset |
+                          occupied_[level] << (kSlots - offset);
+    next = std::min(next, (block + __builtin_ctzll(rotated)) << shift);
+  }
+  return next;
+}
+
+void TimerWheel::Advance(int64_t now_ms,
+                         const std::function<void(uint64_t)>& expire) {
+  const int64_t last = now_ms / tick_ms_;
+  while (now_ <= last) {
+    if (size_ == 0) {
+      now_ = last + 1;
+      break;
+    }
+    const int64_t next = NextEvent();
+    if (next > now_) {
+      now_ = std::min(next, last + 1);
+      continue;
+    }
+    const int slot = now_ & (kSlots - 1);
+    if (slot == 0) {
+      // A finer wheel came around. Refill it from the next coarser one, and
+      // so on as long as those come around too.
+      for (int level = 1; level < kLevels; ++level) {
+        if (Cascade(level, (now_ >> (kLevelBits * level)) & (kSlots - 1)) !=
+            0) {
+          break;
+        }
+      }
+    }
+    int32_t index = slots_[slot];
+    slots_[slot] = kNone;
+    occupied_[0] &= ~(uint64_t{1} << slot);
+    ++now_;
+    while (index != kNone) {
+      Entry& entry = entries_[index];
+      const int32_t next = entry.next;
+      const uint64_t payload = entry.payload;
+      // Freed first, as `expire` may schedule and grow the pool.
+      entry.next = free_;
+      free_ = index;
+      --size_;
+      expire(payload);
+      index = next;
+    }
+  }
+}
+
+}  // namespace pasta
@@ -0,0 +1,86 @@
+#ifndef PASTA_DATA_HANDLER_TIMER_WHEEL_H_
+#define PASTA_DATA_HANDLER_TIMER_WHEEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace pasta {
+
+// A hierarchical timing wheel for very many short timers, e.g. one per open
+// aggregate window of every symbol and timeframe. Scheduling and expiry are
+// O(1) amortized: a timer is linked into a slot of one of kLevels wheels of
+// kSlots slots each, by how far ahead its deadline is, and is moved down to a
+// finer wheel at most once per level as the clock approaches its deadline.
+// Timers carry a 64-bit payload instead of a closure, so that scheduling does
+// not allocate once the entry pool has grown to the number of pending timers.
+//
+// Timers cannot be cancelled. Owners that need to are expected to check on
+// expiry whether the payload still refers to something pending.
+//
+// Not thread safe.
+class TimerWheel {
+ public:
+  // The clock counts in ticks of `tick_ms` milliseconds, starting at the tick
+  // of `now_ms`.
+  TimerWheel(int64_t tick_ms, int64_t now_ms);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Schedules `payload` to expire at `deadline_ms`, rounded up to a tick.
+  // Deadlines not after now_ms() are due at the next tick.
+  void Schedule(int64_t deadline_ms, uint64_t payload);
+
+  // Advances the clock to `now_ms` and calls `expire` with the payload of
+  // every timer whose deadline is not after it, tick by tick. The timers of
+  // one tick expire in no particular order. `expire` may schedule new timers.
+  // Stretches without timers are skipped in O(1).
+  void Advance(int64_t now_ms, const std::function<void(uint64_t)>& expire);
+
+  // The number of pending timers.
+  size_t size() const { return size_; }
+
+  // The time up to which timers have expired.
+  int64_t now_ms() const { return (now_ - 1) * tick_ms_; }
+
+ private:
+  static constexpr int kLevelBits = 6;
+  static constexpr int kSlots = 1 << kLevelBits;
+  static constexpr int kLevels = 4;
+  static constexpr int32_t kNone = -1;
+
+  struct Entry {
+    int64_t deadline;
+    uint64_t payload;
+    // The next entry in the same slot or free list.
+    int32_t next;
+  };
+
+  // Links entry `index` into the slot for its deadline.
+  void Insert(int32_t index);
+
+  // Moves the timers of `slot` at `level` to finer levels, and returns the
+  // slot index.
+  int Cascade(int level, int slot);
+
+  // The first tick from now_ on at which a non-empty slot expires or
+  // cascades. Requires a pending timer.
+  int64_t NextEvent() const;
+
+  const int64_t tick_ms_;
+  // The next tick to expire.
+  int64_t now_;
+  size_t size_;
+
+  // Heads of the slot lists, kSlots per level.
+  std::vector<int32_t> slots_;
+  // Bit i of occupied_[level] is set if slot i of the level is not empty.
+  uint64_t occupied_[kLevels];
+  std::vector<Entry> entries_;
+  int32_t free_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_TIMER_WHEEL_H_
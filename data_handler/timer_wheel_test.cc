@@ -0,0 +1,112 @@
+#include "data_handler/timer_wheel.h"
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kStart = 1610144868000;
+
+TEST(TimerWheelTest, ExpiresAtDeadline) {
+  TimerWheel wheel(10, kStart);
+  std::vector<uint64_t> expired;
+  auto expire = [&expired](uint64_t payload) { expired.push_back(payload); };
+  wheel.Schedule(kStart + 1000, 1);
+  wheel.Schedule(kStart + 25, 2);
+  EXPECT_EQ(wheel.size(), 2);
+
+  wheel.Advance(kStart + 29, expire);
+  // Deadlines are rounded up to a tick.
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(kStart + 30, expire);
+  EXPECT_EQ(expired, std::vector<uint64_t>({2}));
+  wheel.Advance(kStart + 999, expire);
+  EXPECT_EQ(expired.size(), 1);
+  wheel.Advance(kStart + 5000, expire);
+  EXPECT_EQ(expired, std::vector<uint64_t>({2, 1}));
+  EXPECT_EQ(wheel.size(), 0);
+  EXPECT_EQ(wheel.now_ms(), kStart + 5000);
+}
+
+TEST(TimerWheelTest, PastDeadlineIsDueAtNextTick) {
+  TimerWheel wheel(10, kStart);
+  std::vector<uint64_t> expired;
+  auto expire = [&expired](uint64_t payload) { expired.push_back(payload); };
+  wheel.Schedule(kStart - 60000, 7);
+  wheel.Advance(kStart + 9, expire);
+  EXPECT_TRUE(expired.empty());
+  wheel.Advance(kStart + 10, expire);
+  EXPECT_EQ(expired, std::vector<uint64_t>({7}));
+}
+
+TEST(TimerWheelTest, ExpireMaySchedule) {
+  TimerWheel wheel(10, kStart);
+  int64_t fired = 0;
+  std::function<void(uint64_t)> expire = [&](uint64_t payload) {
+    ++fired;
+    // Re-arms every second, like a periodic timer.
+    wheel.Schedule(kStart + (payload + 1) * 1000, payload + 1);
+  };
+  wheel.Schedule(kStart + 1000, 1);
+  wheel.Advance(kStart + 60000, expire);
+  EXPECT_EQ(fired, 60);
+  EXPECT_EQ(wheel.size(), 1);
+}
+
+// Checks against a reference of every timer and its deadline, with deadlines
+// spread over all levels and beyond the span of the wheels.
+TEST(TimerWheelTest, MatchesReference) {
+  constexpr int64_t kTickMs = 10;
+  TimerWheel wheel(kTickMs, kStart);
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<int> level_dist(0, 5);
+  int64_t now = kStart;
+  uint64_t next_payload = 0;
+  // The time each timer is due, i.e. its deadline rounded up to a tick, or
+  // the next tick if that already passed.
+  std::map<uint64_t, int64_t> due;
+  for (int round = 0; round < 2000; ++round) {
+    for (int i = 0; i < 20; ++i) {
+      // Up to ~2^30 ticks ahead, i.e. 4 times the span of the wheels.
+      int64_t ahead = std::uniform_int_distribution<int64_t>(
+          -100, int64_t{kTickMs} << (6 * level_dist(rng)))(rng);
+      due[next_payload] =
+          std::max((now + ahead + kTickMs - 1) / kTickMs * kTickMs,
+                   wheel.now_ms() + kTickMs);
+      wheel.Schedule(now + ahead, next_payload++);
+    }
+    int64_t step = std::uniform_int_distribution<int64_t>(
+        0, int64_t{kTickMs} << (6 * level_dist(rng)))(rng);
+    int64_t prev = now;
+    now += step;
+    wheel.Advance(now, [&](uint64_t payload) {
+      auto iter = due.find(payload);
+      ASSERT_NE(iter, due.end()) << payload << " expired twice.";
+      EXPECT_LE(iter->second, now) << "Timer " << payload << " expired early.";
+      EXPECT_GT(iter->second, prev) << "Timer " << payload << " expired late.";
+      due.erase(iter);
+    });
+    for (const auto& payload_due : due) {
+      ASSERT_GT(payload_due.second, now)
+          << "Timer " << payload_due.first << " did not expire.";
+    }
+    ASSERT_EQ(wheel.size(), due.size());
+  }
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,155 @@
+#include "data_handler/websocket_connection.h"
+
+#include "absl/status/status.h"
+#include "glog/logging.h"
+
+#include <memory>
+#include <utility>
+
+namespace pasta {
+
+namespace {
+
+typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
+
+context_ptr OnTlsInit() {
+  // establishes a SSL connection
+  context_ptr ctx = std::make_shared<boost::asio::ssl::context>(
+      boost::asio::ssl::context::sslv23);
+
+  try {
+    ctx->set_options(boost::asio::ssl::context::default_workarounds |
+                     boost::asio::ssl::context::no_sslv2 |
+                     boost::asio::ssl::context::no_sslv3 |
+                     boost::asio::ssl::context::single_dh_use);
+  } catch (std::exception& e) {
+    LOG(ERROR) << "Error in context pointer: " << e.what();
+  }
+  return ctx;
+}
+
+}  // namespace
+
+WebSocketConnection::WebSocketConnection(EventLoop* loop,
+                                         const std::string& name)
+    : name_(name), connected_(false), open_(false), closing_(false) {
+  // Set logging to be error-only
+  client_.clear_access_channels(websocketpp::log::alevel::all);
+  client_.set_error_channels(websocketpp::log::elevel::all);
+
+  client_.init_asio(loop->io_service());
+  client_.set_tls_init_handler(
+      [](websocketpp::connection_hdl) { return OnTlsInit(); });
+  client_.set_open_handler(
+      [this](websocketpp::connection_hdl hdl) { OnOpen(hdl); });
+  client_.set_message_handler(
+      [this](websocketpp::connection_hdl hdl, Client::message_ptr msg) {
+        OnMessage(hdl, msg);
+      });
+  client_.set_close_handler(
+      [this](websocketpp::connection_hdl hdl) { OnClose(hdl); });
+  client_.set_fail_handler(
+      [this](websocketpp::connection_hdl hdl) { OnFail(hdl); });
+}
+
+void WebSocketConnection::SetOpenHandler(std::function<void()> handler) {
+  on_open_ = std::move(handler);
+}
+
+void WebSocketConnection::SetMessageHandler(
+    std::function<void(std::string* payload)> handler) {
+  on_message_ = std::move(handler);
+}
+
+void WebSocketConnection::SetCloseHandler(
+    std::function<void(const absl::Status&)> handler) {
+  on_close_ = std::move(handler);
+}
+
+absl::Status WebSocketConnection::Connect(const std::string& url) {
+  if (connected_) {
+    return absl::FailedPreconditionError(name_ + " is already connected.");
+  }
+  websocketpp::lib::error_code ec;
+  Client::connection_ptr con = client_.get_connection(url, ec);
+  if (ec) {
+    LOG(ERROR) << "Could not create " << name_
+               << " connection because: " << ec.message();
+    return absl::UnavailableError("Could not create connection because: " +
+                                  ec.message());
+  }
+  hdl_ = con->get_handle();
+  connected_ = true;
+  closing_ = false;
+  // Note that connect here only requests a connection. No network messages
+  // are exchanged until the event loop runs.
+  client_.connect(con);
+  return absl::OkStatus();
+}
+
+absl::Status WebSocketConnection::Send(const std::string& text) {
+  if (!open_) {
+    return absl::FailedPreconditionError(name_ + " is not open.");
+  }
+  websocketpp::lib::error_code ec;
+  client_.send(hdl_, text, websocketpp::frame::opcode::text, ec);
+  if (ec) {
+    return absl::UnavailableError("Failed sending to " + name_ + ": " +
+                                  ec.message());
+  }
+  return absl::OkStatus();
+}
+
+void WebSocketConnection::Close() {
+  if (!connected_ || closing_) return;
+  closing_ = true;
+  websocketpp::lib::error_code ec;
+  client_.close(hdl_, websocketpp::close::status::normal, "", ec);
+  if (ec) {
+    // E.g. still opening. Drop the connection without a closing handshake.
+    DLOG(INFO) << "Closing " << name_ << ": " << ec.message();
+    Client::connection_ptr con = client_.get_con_from_hdl(hdl_, ec);
+    if (!ec) con->terminate(ec);
+  }
+}
+
+void WebSocketConnection::OnOpen(websocketpp::connection_hdl hdl) {
+  LOG(INFO) << name_ << " is connected.";
+  open_ = true;
+  if (on_open_) on_open_();
+}
+
+void WebSocketConnection::OnMessage(websocketpp::connection_hdl hdl,
+                                    Client::message_ptr msg) {
+  if (on_message_) on_message_(&msg->get_raw_payload());
+}
+
+void WebSocketConnection::OnClose(websocketpp::connection_hdl hdl) {
+  Client::connection_ptr con = client_.get_con_from_hdl(hdl);
+  if (closing_) {
+    Closed(absl::OkStatus());
+    return;
+  }
+  Closed(absl::UnavailableError(
+      name_ + " is closed by the server (code " +
+      std::to_string(con->get_remote_close_code()) +
+      "): " + con->get_remote_close_reason()));
+}
+
+void WebSocketConnection::OnFail(websocketpp::connection_hdl hdl) {
+  Client::connection_ptr con = client_.get_con_from_hdl(hdl);
+  if (closing_) {
+    Closed(absl::OkStatus());
+    return;
+  }
+  Closed(absl::UnavailableError(name_ + " failed: " + con->get_ec().message()));
+}
+
+void WebSocketConnection::Closed(const absl::Status& status) {
+  connected_ = false;
+  open_ = false;
+  if (!status.ok()) LOG(ERROR) << status;
+  if (on_close_) on_close_(status);
+}
+
+}  // namespace pasta
@@ -0,0 +1,70 @@
+#ifndef PASTA_DATA_HANDLER_WEBSOCKET_CONNECTION_H_
+#define PASTA_DATA_HANDLER_WEBSOCKET_CONNECTION_H_
+
+#include "absl/status/status.h"
+#include "data_handler/event_loop.h"
+
+#include <functional>
+#include <string>
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+
+namespace pasta {
+
+// A TLS websocket connection hosted on an EventLoop. The handlers run on the
+// loop thread, and the methods must be called there too, or while the loop is
+// not running. A connection may connect again after it is closed. It must
+// outlive the handling of its close, or the loop.
+class WebSocketConnection {
+ public:
+  // `name` identifies the connection in logs.
+  WebSocketConnection(EventLoop* loop, const std::string& name);
+
+  WebSocketConnection(const WebSocketConnection&) = delete;
+  WebSocketConnection& operator=(const WebSocketConnection&) = delete;
+
+  void SetOpenHandler(std::function<void()> handler);
+  // The handler may take the payload by swapping it.
+  void SetMessageHandler(std::function<void(std::string* payload)> handler);
+  // Called once per Connect(), when the connection closes or fails to open.
+  // The status is OK if closed by Close().
+  void SetCloseHandler(std::function<void(const absl::Status&)> handler);
+
+  // Requests a connection, which opens once the loop runs.
+  absl::Status Connect(const std::string& url);
+
+  absl::Status Send(const std::string& text);
+
+  // Closes the connection, if open or opening.
+  void Close();
+
+  // Whether a connection is opening, open or closing.
+  bool IsConnected() const { return connected_; }
+  bool IsOpen() const { return open_; }
+
+ private:
+  typedef websocketpp::client<websocketpp::config::asio_tls_client> Client;
+
+  void OnOpen(websocketpp::connection_hdl hdl);
+  void OnMessage(websocketpp::connection_hdl hdl, Client::message_ptr msg);
+  void OnClose(websocketpp::connection_hdl hdl);
+  void OnFail(websocketpp::connection_hdl hdl);
+  void Closed(const absl::Status& status);
+
+  const std::string name_;
+  Client client_;
+
+  std::function<void()> on_open_;
+  std::function<void(std::string*)> on_message_;
+  std::function<void(const absl::Status&)> on_close_;
+
+  websocketpp::connection_hdl hdl_;
+  bool connected_;
+  bool open_;
+  // Whether Close() was called on the current connection.
+  bool closing_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_WEBSOCKET_CONNECTION_H_
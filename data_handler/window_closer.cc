@@ -0,0 +1,131 @@
+#include "data_handler/window_closer.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/symbol_table.h"
+#include "data_handler/timer_wheel.h"
+#include "glog/logging.h"
+
+#include <memory>
+#include <utility>
+
+namespace pasta {
+
+namespace {
+
+// Timer payloads hold the symbol and the timeframe, which is less than 32.
+constexpr int kTimeframeBits = 5;
+
+}  // namespace
+
+WindowCloser::WindowCloser(CascadingAggregator* agg_data, int num_partitions,
+                           int64_t delay_ms, CloseCallback on_close,
+                           StaleCallback on_stale)
+    : agg_data_(agg_data),
+      num_partitions_(num_partitions),
+      delay_ms_(delay_ms),
+      on_close_(std::move(on_close)),
+      on_stale_(std::move(on_stale)),
+      now_ms_(0) {
+  for (int i = 0; i < agg_data->num_timeframes(); ++i) {
+    window_ms_.push_back(agg_data->window_size(i) * NUM_MILLIS_PER_SECOND);
+  }
+}
+
+WindowCloser::WindowState& WindowCloser::State(SymbolId sym_id,
+                                               int timeframe) {
+  size_t index = sym_id / num_partitions_ * window_ms_.size() + timeframe;
+  if (index >= states_.size()) {
+    states_.resize((sym_id / num_partitions_ + 1) * window_ms_.size(),
+                   WindowState{-1, -1});
+  }
+  return states_[index];
+}
+
+void WindowCloser::OnAggregate(SymbolId sym_id) {
+  const size_t index = sym_id / num_partitions_;
+  if (index >= active_.size()) active_.resize(index + 1);
+  active_[index] = true;
+  for (int i = 0; i < window_ms_.size(); ++i) {
+    const AggregateData& front = agg_data_->GetData(i, sym_id).front();
+    WindowState& state = State(sym_id, i);
+    if (front.start_ != state.open) {
+      // A window opened, so the previous one is closed.
+      if (state.open >= 0) Close(sym_id, i, state.open, &state);
+      state.open = front.start_;
+      if (wheel_ != nullptr && front.end_ - front.start_ != window_ms_[i]) {
+        wheel_->Schedule(front.start_ + window_ms_[i] + delay_ms_,
+                         uint64_t{sym_id} << kTimeframeBits | i);
+      }
+    }
+    if (front.end_ - front.start_ == window_ms_[i]) {
+      Close(sym_id, i, front.start_, &state);
+    }
+  }
+}
+
+void WindowCloser::OnRestored(SymbolId sym_id) {
+  const size_t index = sym_id / num_partitions_;
+  if (index >= active_.size()) active_.resize(index + 1);
+  active_[index] = true;
+  for (int i = 0; i < window_ms_.size(); ++i) {
+    const AggDataStore::AggDataQueue& history = agg_data_->GetData(i, sym_id);
+    if (history.empty()) continue;
+    const AggregateData& front = history.front();
+    WindowState& state = State(sym_id, i);
+    state.open = front.start_;
+    if (front.end_ - front.start_ == window_ms_[i]) {
+      state.closed = front.start_;
+      continue;
+    }
+    state.closed = history.size() > 1 ? history[1].start_ : -1;
+    const int64_t deadline = front.start_ + window_ms_[i] + delay_ms_;
+    const uint64_t payload = uint64_t{sym_id} << kTimeframeBits | i;
+    if (wheel_ != nullptr) {
+      wheel_->Schedule(deadline, payload);
+    } else {
+      unscheduled_.emplace_back(deadline, payload);
+    }
+  }
+}
+
+void WindowCloser::AdvanceTime(int64_t now_ms) {
+  now_ms_ = now_ms;
+  if (wheel_ == nullptr) {
+    wheel_ = std::make_unique<TimerWheel>(kTickMs, now_ms);
+    for (const auto& deadline_payload : unscheduled_) {
+      wheel_->Schedule(deadline_payload.first, deadline_payload.second);
+    }
+    unscheduled_.clear();
+    unscheduled_.shrink_to_fit();
+    return;
+  }
+  wheel_->Advance(now_ms, [this](uint64_t payload) { OnTimer(payload); });
+}
+
+void WindowCloser::OnTimer(uint64_t payload) {
+  const SymbolId sym_id = payload >> kTimeframeBits;
+  const int timeframe = payload & ((1 << kTimeframeBits) - 1);
+  WindowState& state = State(sym_id, timeframe);
+  // Timers of windows that closed by data since are stale.
+  if (state.open > state.closed &&
+      state.open + window_ms_[timeframe] + delay_ms_ <= now_ms_) {
+    Close(sym_id, timeframe, state.open, &state);
+    // Timers are only scheduled after aggregates or restores, so active_ has
+    // the symbol.
+    const size_t index = sym_id / num_partitions_;
+    if (active_[index]) {
+      active_[index] = false;
+      if (on_stale_ != nullptr) on_stale_(sym_id);
+    }
+  }
+}
+
+void WindowCloser::Close(SymbolId sym_id, int timeframe, int64_t window_start,
+                         WindowState* state) {
+  if (window_start <= state->closed) return;
+  state->closed = window_start;
+  on_close_(sym_id, timeframe, window_start);
+}
+
+}  // namespace pasta
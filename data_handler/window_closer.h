@@ -0,0 +1,108 @@
+#ifndef PASTA_DATA_HANDLER_WINDOW_CLOSER_H_
+#define PASTA_DATA_HANDLER_WINDOW_CLOSER_H_
+
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/symbol_table.h"
+#include "data_handler/timer_wheel.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pasta {
+
+// Tells when the aggregate windows of a CascadingAggregator close, once per
+// window. A window closes when an aggregate completes it or opens the next
+// window of its symbol, as AddData() reports, or at the latest `delay` after
+// its end by the clock given to AdvanceTime(). The latter closes the windows
+// of symbols that stopped trading, which AddData() alone would leave open
+// until the symbol trades again.
+//
+// Every window opened once the clock runs, i.e. since the first
+// AdvanceTime(), gets one timer on a TimerWheel, so keeping track of a
+// universe of symbols costs O(1) per window opened, and nothing for symbols
+// that do not trade. Without a clock, e.g. in replays, windows only close
+// by data.
+class WindowCloser {
+ public:
+  // Called with the timeframe index and start of a closed window.
+  typedef std::function<void(SymbolId sym_id, int timeframe,
+                             int64_t window_start)>
+      CloseCallback;
+  // Called with a symbol that went silent, when the first of its windows is
+  // closed by time after an aggregate of it.
+  typedef std::function<void(SymbolId sym_id)> StaleCallback;
+
+  // Closes the windows of `agg_data`, which must outlive the closer, and of
+  // which the closer is one of `num_partitions` partitions like
+  // CascadingAggregator.
+  WindowCloser(CascadingAggregator* agg_data, int num_partitions,
+               int64_t delay_ms, CloseCallback on_close,
+               StaleCallback on_stale = nullptr);
+
+  WindowCloser(const WindowCloser&) = delete;
+  WindowCloser& operator=(const WindowCloser&) = delete;
+
+  // Called after every CascadingAggregator::AddData(), with the symbol of the
+  // aggregate.
+  void OnAggregate(SymbolId sym_id);
+
+  // Called after the windows of `sym_id` were restored, e.g. from a snapshot,
+  // so that its open windows close like any other, by time too once the clock
+  // runs, even if that is only after the restore. Windows complete before are
+  // taken as closed already.
+  void OnRestored(SymbolId sym_id);
+
+  // Closes the windows that ended `delay` before `now_ms` (Unix millis).
+  void AdvanceTime(int64_t now_ms);
+
+  // The number of windows waiting to be closed by time.
+  size_t NumTimers() const { return wheel_ == nullptr ? 0 : wheel_->size(); }
+
+ private:
+  // The resolution of closing by time.
+  static constexpr int64_t kTickMs = 10;
+
+  struct WindowState {
+    // The start of the newest window, or -1.
+    int64_t open;
+    // The start of the newest closed window, or -1.
+    int64_t closed;
+  };
+
+  WindowState& State(SymbolId sym_id, int timeframe);
+
+  void Close(SymbolId sym_id, int timeframe, int64_t window_start,
+             WindowState* state);
+
+  void OnTimer(uint64_t payload);
+
+  CascadingAggregator* agg_data_;
+  int num_partitions_;
+  int64_t delay_ms_;
+  CloseCallback on_close_;
+  StaleCallback on_stale_;
+
+  // Window sizes (milliseconds) indexed by timeframe.
+  std::vector<int64_t> window_ms_;
+
+  // Indexed by SymbolId / num_partitions_ * num_timeframes + timeframe.
+  std::vector<WindowState> states_;
+  // Whether a symbol had an aggregate since its last stale callback, indexed
+  // by SymbolId / num_partitions_.
+  std::vector<bool> active_;
+
+  // Created by the first AdvanceTime().
+  std::unique_ptr<TimerWheel> wheel_;
+  // The deadlines and payloads of the timers of windows restored before the
+  // wheel was created, scheduled when it is.
+  std::vector<std::pair<int64_t, uint64_t>> unscheduled_;
+  // The time of the last AdvanceTime().
+  int64_t now_ms_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_DATA_HANDLER_WINDOW_CLOSER_H_
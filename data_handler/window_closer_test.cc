@@ -0,0 +1,233 @@
+#include "data_handler/window_closer.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kStart = 1610144860000;
+constexpr int64_t kDelayMs = 1000;
+
+typedef std::tuple<SymbolId, int, int64_t> Closed;
+
+class WindowCloserTest : public ::testing::Test {
+ protected:
+  // The per-second aggregate of `sym_id` starting at `start`.
+  void AddSecond(SymbolId sym_id, int64_t start) {
+    AggregateData agg;
+    agg.sym_id_ = sym_id;
+    agg.vol_ = 100;
+    agg.start_ = start;
+    agg.end_ = start + NUM_MILLIS_PER_SECOND;
+    agg_data_.AddData(agg);
+    closer_.OnAggregate(sym_id);
+  }
+
+  // 1 and 10 second timeframes.
+  CascadingAggregator agg_data_ = CascadingAggregator({1, 10});
+  std::vector<Closed> closed_;
+  WindowCloser closer_ = WindowCloser(
+      &agg_data_, 1, kDelayMs,
+      [this](SymbolId sym_id, int timeframe, int64_t window_start) {
+        closed_.emplace_back(sym_id, timeframe, window_start);
+      });
+  SymbolId spce_ = SymbolTable::Get().Intern("SPCE");
+};
+
+TEST_F(WindowCloserTest, ClosesByData) {
+  for (int i = 0; i < 10; ++i) {
+    AddSecond(spce_, kStart + i * 1000);
+  }
+  ASSERT_EQ(closed_.size(), 11);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(closed_[i], Closed(spce_, 0, kStart + i * 1000));
+  }
+  // The aggregate of the last second completes the 10 second window.
+  EXPECT_EQ(closed_[10], Closed(spce_, 1, kStart));
+
+  closed_.clear();
+  AddSecond(spce_, kStart + 12000);
+  AddSecond(spce_, kStart + 25000);
+  // The window starting at 10s closes when the one at 20s opens.
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 0, kStart + 12000),
+                                          Closed(spce_, 0, kStart + 25000),
+                                          Closed(spce_, 1, kStart + 10000)}));
+}
+
+TEST_F(WindowCloserTest, ClosesSilentSymbolByTime) {
+  closer_.AdvanceTime(kStart);
+  AddSecond(spce_, kStart + 2000);
+  AddSecond(spce_, kStart + 3000);
+  EXPECT_EQ(closer_.NumTimers(), 1);
+  closed_.clear();
+
+  closer_.AdvanceTime(kStart + 10000 + kDelayMs - 1);
+  EXPECT_TRUE(closed_.empty());
+  closer_.AdvanceTime(kStart + 10000 + kDelayMs);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 1, kStart)}));
+  EXPECT_EQ(closer_.NumTimers(), 0);
+
+  // Neither late data of the window nor the next window close it again.
+  closed_.clear();
+  AddSecond(spce_, kStart + 9000);
+  AddSecond(spce_, kStart + 31000);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 0, kStart + 9000),
+                                          Closed(spce_, 0, kStart + 31000)}));
+}
+
+TEST_F(WindowCloserTest, StaleTimerDoesNotCloseNextWindow) {
+  closer_.AdvanceTime(kStart);
+  AddSecond(spce_, kStart + 8000);
+  AddSecond(spce_, kStart + 10000);
+  closed_.clear();
+  // The timer of the first window expires, while the second is open.
+  closer_.AdvanceTime(kStart + 10000 + kDelayMs);
+  EXPECT_TRUE(closed_.empty());
+  closer_.AdvanceTime(kStart + 20000 + kDelayMs);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 1, kStart + 10000)}));
+}
+
+TEST_F(WindowCloserTest, NoTimersWithoutClock) {
+  AddSecond(spce_, kStart);
+  EXPECT_EQ(closer_.NumTimers(), 0);
+}
+
+TEST_F(WindowCloserTest, ClosesRestoredWindows) {
+  // A complete 1s window and an open 10s one, as of a snapshot.
+  auto restore = [this](int timeframe, int64_t start, int64_t end) {
+    AggregateData agg;
+    agg.sym_id_ = spce_;
+    agg.start_ = start;
+    agg.end_ = end;
+    agg_data_.Restore(timeframe, agg);
+  };
+  restore(0, kStart + 11000, kStart + 12000);
+  restore(0, kStart + 12000, kStart + 13000);
+  restore(1, kStart + 10000, kStart + 13000);
+  closer_.OnRestored(spce_);
+  EXPECT_TRUE(closed_.empty());
+
+  // Only the open window closes, by the next data.
+  AddSecond(spce_, kStart + 21000);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 0, kStart + 21000),
+                                          Closed(spce_, 1, kStart + 10000)}));
+}
+
+TEST_F(WindowCloserTest, ClosesRestoredWindowsByTime) {
+  closer_.AdvanceTime(kStart);
+  AggregateData agg;
+  agg.sym_id_ = spce_;
+  agg.start_ = kStart + 10000;
+  agg.end_ = kStart + 13000;
+  agg_data_.Restore(1, agg);
+  agg.start_ = kStart + 12000;
+  agg_data_.Restore(0, agg);
+  closer_.OnRestored(spce_);
+  EXPECT_EQ(closer_.NumTimers(), 1);
+  closer_.AdvanceTime(kStart + 20000 + kDelayMs);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 1, kStart + 10000)}));
+}
+
+TEST_F(WindowCloserTest, ClosesWindowsRestoredBeforeTheClockByTime) {
+  AggregateData agg;
+  agg.sym_id_ = spce_;
+  agg.start_ = kStart + 10000;
+  agg.end_ = kStart + 13000;
+  agg_data_.Restore(1, agg);
+  agg.start_ = kStart + 12000;
+  agg_data_.Restore(0, agg);
+  closer_.OnRestored(spce_);
+  EXPECT_EQ(closer_.NumTimers(), 0);
+
+  // The first tick of the clock schedules the open window.
+  closer_.AdvanceTime(kStart + 15000);
+  EXPECT_EQ(closer_.NumTimers(), 1);
+  closer_.AdvanceTime(kStart + 20000 + kDelayMs);
+  EXPECT_EQ(closed_, std::vector<Closed>({Closed(spce_, 1, kStart + 10000)}));
+}
+
+TEST(WindowCloserStaleTest, ReportsEverySilenceOnce) {
+  CascadingAggregator agg_data({1, 10, 60});
+  std::vector<SymbolId> stale;
+  WindowCloser closer(
+      &agg_data, 1, kDelayMs, [](SymbolId, int, int64_t) {},
+      [&stale](SymbolId sym_id) { stale.push_back(sym_id); });
+  SymbolId sym_id = SymbolTable::Get().Intern("STALE");
+  auto add_second = [&](int64_t start) {
+    AggregateData agg;
+    agg.sym_id_ = sym_id;
+    agg.start_ = start;
+    agg.end_ = start + NUM_MILLIS_PER_SECOND;
+    agg_data.AddData(agg);
+    closer.OnAggregate(sym_id);
+  };
+  closer.AdvanceTime(kStart);
+  add_second(kStart + 2000);
+  add_second(kStart + 3000);
+  closer.AdvanceTime(kStart + 10000 + kDelayMs - 1);
+  EXPECT_TRUE(stale.empty());
+  // The 10s window closes by time. The 1m window, which ends at 20s,
+  // closing later does not tell anything new.
+  closer.AdvanceTime(kStart + 10000 + kDelayMs);
+  EXPECT_EQ(stale, std::vector<SymbolId>({sym_id}));
+  closer.AdvanceTime(kStart + 20000 + kDelayMs);
+  EXPECT_EQ(stale.size(), 1);
+
+  // Trading again, until the last second of a 10s window, which completes
+  // it. The 1m window ending at 140s tells the next silence.
+  add_second(kStart + 125000);
+  add_second(kStart + 129000);
+  closer.AdvanceTime(kStart + 140000 + kDelayMs - 1);
+  EXPECT_EQ(stale.size(), 1);
+  closer.AdvanceTime(kStart + 140000 + kDelayMs);
+  EXPECT_EQ(stale, std::vector<SymbolId>({sym_id, sym_id}));
+}
+
+TEST(WindowCloserScaleTest, ClosesEveryWindowOnce) {
+  const int kNumSymbols = 20000;
+  const std::vector<int64_t> window_sizes = {1, 10, 60, 300};
+  CascadingAggregator agg_data(window_sizes);
+  std::vector<int> num_closed(window_sizes.size());
+  WindowCloser closer(&agg_data, 1, kDelayMs,
+                      [&num_closed](SymbolId, int timeframe, int64_t) {
+                        ++num_closed[timeframe];
+                      });
+  std::vector<SymbolId> sym_ids;
+  for (int i = 0; i < kNumSymbols; ++i) {
+    sym_ids.push_back(SymbolTable::Get().Intern("SCALE" + std::to_string(i)));
+  }
+  closer.AdvanceTime(kStart);
+  for (SymbolId sym_id : sym_ids) {
+    AggregateData agg;
+    agg.sym_id_ = sym_id;
+    agg.start_ = kStart + 1000;
+    agg.end_ = kStart + 2000;
+    agg_data.AddData(agg);
+    closer.OnAggregate(sym_id);
+  }
+  EXPECT_EQ(closer.NumTimers(), 3 * kNumSymbols);
+
+  for (int64_t t = kStart; t <= kStart + 301000; t += 100) {
+    closer.AdvanceTime(t);
+  }
+  EXPECT_EQ(num_closed, std::vector<int>(window_sizes.size(), kNumSymbols));
+  EXPECT_EQ(closer.NumTimers(), 0);
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
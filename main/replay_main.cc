@@ -0,0 +1,70 @@
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "alpaca/decimal.h"
+#include "alpaca/order.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/latency_tracker.h"
+#include "data_handler/replay_driver.h"
+#include "glog/logging.h"
+#include "strategy/chase_momentum_strategy.h"
+#include "strategy/simulated_order_client.h"
+
+#include <string>
+#include <vector>
+
+ABSL_FLAG(double, replay_speed, 0,
+          "Replay speed relative to real time. 0 replays as fast as possible.");
+ABSL_FLAG(std::string, replay_cash, "100000",
+          "The cash of the simulated account, in dollars.");
+
+// Replays record files written with --data_client_record_dir, given as
+// arguments, through the chase momentum strategy. Its orders are filled
+// against the replayed data by a SimulatedOrderClient instead of the broker,
+// so positions are entered and cleared as in live trading.
+int main(int argc, char* argv[]) {
+  std::vector<char*> files = absl::ParseCommandLine(argc, argv);
+  if (files.size() < 2) {
+    LOG(ERROR) << "Usage: " << argv[0] << " [flags] record_file...";
+    return 1;
+  }
+  alpaca::Decimal cash;
+  if (!alpaca::Decimal::parse(absl::GetFlag(FLAGS_replay_cash), &cash)) {
+    LOG(ERROR) << "Invalid --replay_cash.";
+    return 1;
+  }
+
+  pasta::DataHandler dh = pasta::DataHandler(nullptr);
+  pasta::SimulatedOrderClient orders(&dh, cash);
+  pasta::ChaseMomentumStrategy c_m_s =
+      pasta::ChaseMomentumStrategy(&dh, &orders);
+  absl::Status s = c_m_s.Init();
+  CHECK(s.ok()) << s;
+
+  pasta::ReplayDriver driver(&dh, absl::GetFlag(FLAGS_replay_speed));
+  for (int i = 1; i < files.size(); ++i) {
+    LOG(INFO) << "Replaying " << files[i] << ".";
+    s = driver.Replay(files[i]);
+    if (!s.ok()) {
+      LOG(ERROR) << "Replay failure: " << s.ToString();
+      return 1;
+    }
+  }
+  // Responses after the last second of data.
+  orders.Deliver();
+
+  int num_filled = 0;
+  for (const alpaca::Order& order : orders.orders()) {
+    if (order.status == "filled") ++num_filled;
+  }
+  pasta::ReplayDriver::Stats stats = driver.stats();
+  LOG(INFO) << "Replayed " << stats.messages << " messages ("
+            << stats.bytes / (1 << 20) << " MiB) in " << stats.elapsed << ", "
+            << stats.messages / absl::ToDoubleSeconds(stats.elapsed)
+            << " messages per second. " << orders.orders().size()
+            << " orders, " << num_filled << " filled. Cash went from " << cash
+            << " to " << orders.cash() << ".";
+  LOG(INFO) << pasta::LatencyTracker::Get().Summary();
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include "strategy/alpaca_bar_source.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "alpaca/alpaca.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+
+namespace pasta {
+
+namespace {
+
+std::string FormatMillis(int64_t ms) {
+  return absl::FormatTime(absl::RFC3339_sec, absl::FromUnixMillis(ms),
+                          absl::UTCTimeZone());
+}
+
+}  // namespace
+
+AlpacaBarSource::AlpacaBarSource(alpaca::Client* client) : client_(client) {}
+
+absl::Status AlpacaBarSource::GetMinuteBars(
+    const std::vector<std::string>& tickers, int64_t start_ms, int64_t end_ms,
+    std::vector<AggregateData>* bars) {
+  if (tickers.empty()) return absl::OkStatus();
+  // The end is inclusive.
+  auto resp = client_->getBars(tickers, FormatMillis(start_ms),
+                               FormatMillis(end_ms - 1), "", "", "1Min",
+                               kMaxBarsPerSymbol);
+  if (!resp.first.ok()) {
+    return absl::UnavailableError(
+        absl::StrCat("Alpaca bars failure (code ", resp.first.getCode(),
+                     "): ", resp.first.getMessage()));
+  }
+  for (const auto& ticker_bars : resp.second.bars) {
+    const SymbolId sym_id = SymbolTable::Get().Intern(ticker_bars.first);
+    for (const alpaca::Bar& bar : ticker_bars.second) {
+      const int64_t start = int64_t{bar.time} * NUM_MILLIS_PER_SECOND;
+      if (start < start_ms || start >= end_ms) continue;
+      AggregateData& agg = bars->emplace_back();
+      agg.sym_id_ = sym_id;
+      agg.vol_ = bar.volume;
+      agg.open_ = bar.open_price;
+      agg.close_ = bar.close_price;
+      agg.high_ = bar.high_price;
+      agg.low_ = bar.low_price;
+      // Bars have no volume weighted average price. The typical price is the
+      // usual stand-in.
+      agg.vwap_ = (bar.high_price + bar.low_price + bar.close_price) / 3;
+      agg.open_ticks_ = PriceFromDouble(bar.open_price);
+      agg.close_ticks_ = PriceFromDouble(bar.close_price);
+      agg.high_ticks_ = PriceFromDouble(bar.high_price);
+      agg.low_ticks_ = PriceFromDouble(bar.low_price);
+      agg.start_ = start;
+      agg.end_ = start + 60 * NUM_MILLIS_PER_SECOND;
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace pasta
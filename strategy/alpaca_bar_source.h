@@ -0,0 +1,35 @@
+#ifndef PASTA_STRATEGY_ALPACA_BAR_SOURCE_H_
+#define PASTA_STRATEGY_ALPACA_BAR_SOURCE_H_
+
+#include "absl/status/status.h"
+#include "alpaca/alpaca.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/bar_source.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+// Backfills from the 1m bars of the Alpaca market data REST API. A request
+// returns at most kMaxBarsPerSymbol bars per symbol, the latest ones, which
+// covers gaps of most of a trading day.
+class AlpacaBarSource : public BarSource {
+ public:
+  // `client` must outlive the source.
+  explicit AlpacaBarSource(alpaca::Client* client);
+
+  absl::Status GetMinuteBars(const std::vector<std::string>& tickers,
+                             int64_t start_ms, int64_t end_ms,
+                             std::vector<AggregateData>* bars) override;
+
+  static constexpr int kMaxBarsPerSymbol = 1000;
+
+ private:
+  alpaca::Client* client_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_ALPACA_BAR_SOURCE_H_
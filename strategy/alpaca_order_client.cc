@@ -0,0 +1,34 @@
+#include "strategy/alpaca_order_client.h"
+
+#include "alpaca/account.h"
+#include "alpaca/client.h"
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+#include "data_handler/price.h"
+
+namespace pasta {
+
+AlpacaOrderClient::AlpacaOrderClient(alpaca::Client* client)
+    : client_(client) {}
+
+std::pair<alpaca::Status, alpaca::Account> AlpacaOrderClient::GetAccount() {
+  return client_->getAccount();
+}
+
+void AlpacaOrderClient::GetAccountAsync(
+    alpaca::Client::Callback<alpaca::Account> callback) {
+  client_->getAccountAsync(callback);
+}
+
+void AlpacaOrderClient::SubmitOrderAsync(
+    alpaca::Client::Callback<alpaca::Order> callback,
+    const std::string& ticker, int64_t qty, alpaca::OrderSide side,
+    Price limit_price, const std::string& client_order_id) {
+  client_->submitOrderAsync(callback, ticker, qty, side,
+                            alpaca::OrderType::Limit,
+                            alpaca::OrderTimeInForce::ImmediateOrCancel,
+                            FormatPrice(limit_price), /*stop_price=*/"",
+                            /*extended_hours=*/false, client_order_id);
+}
+
+}  // namespace pasta
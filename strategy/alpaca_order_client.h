@@ -0,0 +1,39 @@
+#ifndef PASTA_STRATEGY_ALPACA_ORDER_CLIENT_H_
+#define PASTA_STRATEGY_ALPACA_ORDER_CLIENT_H_
+
+#include "alpaca/account.h"
+#include "alpaca/client.h"
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+#include "data_handler/price.h"
+#include "strategy/order_client.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace pasta {
+
+// Trades through the Alpaca trading API.
+class AlpacaOrderClient : public OrderClient {
+ public:
+  // `client` must outlive the order client.
+  explicit AlpacaOrderClient(alpaca::Client* client);
+
+  std::pair<alpaca::Status, alpaca::Account> GetAccount() override;
+
+  void GetAccountAsync(
+      alpaca::Client::Callback<alpaca::Account> callback) override;
+
+  void SubmitOrderAsync(alpaca::Client::Callback<alpaca::Order> callback,
+                        const std::string& ticker, int64_t qty,
+                        alpaca::OrderSide side, Price limit_price,
+                        const std::string& client_order_id) override;
+
+ private:
+  alpaca::Client* client_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_ALPACA_ORDER_CLIENT_H_
@@ -1,31 +1,103 @@
 #include "strategy/chase_momentum_strategy.h"
 
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "alpaca/alpaca.h"
 #include "data_handler/agg_data.h"
+#include "data_handler/cascading_aggregator.h"
+#include "data_handler/columnar_agg_data.h"
 #include "data_handler/data_handler.h"
+#include "data_handler/event_bus.h"
+#include "data_handler/indicator_registry.h"
+#include "data_handler/indicators.h"
+#include "data_handler/latency_tracker.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
 #include "glog/logging.h"
+#include "strategy/alpaca_bar_source.h"
+#include "strategy/momentum_scanner.h"
+#include "strategy/order_table.h"
 #include "strategy/strategy.h"
 
+#include <memory>
+
+ABSL_FLAG(bool, chase_momentum_scanner, false,
+          "Look for entry points across the whole universe once per second "
+          "of data instead of upon every aggregate. Requires "
+          "--columnar_agg_data_store.");
+
 namespace pasta {
 
-ChaseMomentumStrategy::ChaseMomentumStrategy(DataHandler* dh)
-    : Strategy(dh), trading_("") {
+namespace {
+
+constexpr char kOrderSubscriber[] = "ChaseMomentumStrategy";
+
+}  // namespace
+
+ChaseMomentumStrategy::ChaseMomentumStrategy(DataHandler* dh,
+                                             OrderClient* orders)
+    : Strategy(dh),
+      orders_(orders),
+      subscribed_(false),
+      trading_(kInvalidSymbolId),
+      pending_(false) {
   LOG(INFO) << dh << " vs " << dh_;
   absl::LoadTimeZone("America/New_York", &nyc_);
+  five_min_vol_ = dh_->AddIndicator(ONE_MIN, VOLUME_SUM, 6);
+  if (absl::GetFlag(FLAGS_chase_momentum_scanner) &&
+      dh_->GetColumnarData(TEN_SEC) != nullptr) {
+    scanner_ = std::make_unique<MomentumScanner>(dh_->GetColumnarData(TEN_SEC),
+                                                 dh_->GetColumnarData(ONE_MIN));
+  }
+}
+
+ChaseMomentumStrategy::~ChaseMomentumStrategy() {
+  {
+    // Wait for the order in flight, whose callbacks use the members.
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(
+        +[](std::atomic<bool>* pending) { return !pending->load(); },
+        &pending_));
+  }
+  if (client_ != nullptr) {
+    dh_->SetBarSource(nullptr);
+    OrderTable::Get().StopStreaming();
+  }
+  if (subscribed_) {
+    OrderTable::Get().Unsubscribe(kOrderSubscriber).IgnoreError();
+  }
 }
 
 absl::Status ChaseMomentumStrategy::Init() {
+  if (absl::GetFlag(FLAGS_chase_momentum_scanner) && scanner_ == nullptr) {
+    return absl::FailedPreconditionError(
+        "--chase_momentum_scanner requires --columnar_agg_data_store.");
+  }
   auto env = alpaca::Environment();
-  if (auto status = env.parse(); !status.ok()) {
-    return absl::AbortedError(absl::StrCat(
-        "Alpaca environment parsing failure (code ",
-        std::to_string(status.getCode()), "): ", status.getMessage()));
+  if (orders_ == nullptr) {
+    if (auto status = env.parse(); !status.ok()) {
+      return absl::AbortedError(absl::StrCat(
+          "Alpaca environment parsing failure (code ",
+          std::to_string(status.getCode()), "): ", status.getMessage()));
+    }
+    client_ = std::make_unique<alpaca::Client>(env);
+    // Gaps in the market data are backfilled from the bars of the same API.
+    bar_source_ = std::make_unique<AlpacaBarSource>(client_.get());
+    dh_->SetBarSource(bar_source_.get());
+    // Connect now, so that the first orders do not wait for TLS handshakes.
+    if (auto status = client_->warmUp(); !status.ok()) {
+      LOG(WARNING) << "Alpaca connection warm up failure (code "
+                   << status.getCode() << "): " << status.getMessage();
+    }
+    alpaca_orders_ = std::make_unique<AlpacaOrderClient>(client_.get());
+    orders_ = alpaca_orders_.get();
   }
-  client_ = std::make_unique<alpaca::Client>(env);
 
-  auto account_response = client_->getAccount();
+  auto account_response = orders_->GetAccount();
   if (auto status = account_response.first; !status.ok()) {
     return absl::AbortedError(absl::StrCat(
         "Alpaca getting account information", "failure (code ",
@@ -46,32 +118,77 @@ absl::Status ChaseMomentumStrategy::Init() {
   LOG(INFO) << account_.cash << " is available as cash.";
   LOG(INFO) << account_.buying_power << " is available as buying power.";
 
-  dh_->RegisterCallback("ChaseMomentumStrategy process new data",
-                        std::bind(&ChaseMomentumStrategy::ProcessNewData, this,
+  absl::Status s = OrderTable::Get().Subscribe(
+      kOrderSubscriber, std::bind(&ChaseMomentumStrategy::OnOrderEvent, this,
                                   std::placeholders::_1));
+  if (!s.ok()) return s;
+  subscribed_ = true;
+  // Order events then come in sequence with the market data.
+  EventLoop* loop = dh_->GetEventLoop();
+  if (client_ == nullptr) {
+    // Simulated orders have no stream.
+  } else if (loop != nullptr) {
+    OrderTable::Get().StartStreaming(env, loop);
+  } else {
+    LOG(WARNING) << "No event loop for the trade update stream. Order events "
+                 << "only come from REST responses.";
+  }
+
+  dh_->Subscribe("ChaseMomentumStrategy process new data", BAR_UPDATED,
+                 kInvalidSymbolId,
+                 [this](const Event& event) { ProcessNewData(event.sym_id); });
+  if (scanner_ != nullptr) {
+    dh_->RegisterTickCallback("ChaseMomentumStrategy scan universe",
+                              std::bind(&ChaseMomentumStrategy::ScanUniverse,
+                                        this, std::placeholders::_1));
+  }
 
   return absl::OkStatus();
 }
 
-void ChaseMomentumStrategy::ProcessNewData(const std::string& ticker) {
-  if (trading_.empty()) {
-    MaybeEnterTrade(ticker);
-  } else if (ticker == trading_) {
+void ChaseMomentumStrategy::ProcessNewData(SymbolId sym_id) {
+  // Checked without the lock, which only the shard of the traded symbol or
+  // of an entry point takes.
+  if (pending_) {
+    // Wait for the result of the order in flight.
+    return;
+  }
+  const SymbolId trading = trading_;
+  if (trading == kInvalidSymbolId) {
+    if (scanner_ != nullptr || !IsEntryPoint(sym_id)) return;
+    // The data of the own symbol, which this shard updates.
+    const AggregateData& data = dh_->GetData(TEN_SEC, sym_id).front();
+    absl::MutexLock lock(&mu_);
+    // Another shard may have claimed a trade meanwhile.
+    if (pending_ || trading_ != kInvalidSymbolId) return;
+    EnterTrade(sym_id, data.end_, data.close_ticks_);
+  } else if (sym_id == trading) {
+    absl::MutexLock lock(&mu_);
+    if (pending_ || trading_ != sym_id) return;
     PositionManagement();
   } else {
     // Do nothing because currently we only allow trading one stock at a time.
   }
 }
 
-void ChaseMomentumStrategy::MaybeEnterTrade(const std::string& ticker) {
-  if (IsEntryPoint(ticker)) {
-    quantity_ = 0;
-    trading_ = ticker;
-    enter_ts_ = dh_->GetData(TEN_SEC, ticker).front().end_;
-    clear_ = false;
-    EnterTrade();
-    if (quantity_ <= 0) trading_.clear();
+void ChaseMomentumStrategy::ScanUniverse(int64_t second) {
+  absl::MutexLock lock(&mu_);
+  if (pending_ || trading_ != kInvalidSymbolId) return;
+  // As of the end of the second, like the aggregates of the second.
+  const int64_t end = second + NUM_MILLIS_PER_SECOND;
+  if (!IsStrategyTradingHour(
+          absl::ToCivilMinute(absl::FromUnixMillis(end), nyc_))) {
+    return;
   }
+  candidates_.clear();
+  scanner_->Scan(second, &candidates_);
+  if (candidates_.empty()) return;
+  const SymbolId sym_id = candidates_.front();
+  // The data stores of the symbol may belong to a shard thread.
+  const int64_t window_ms = 10 * NUM_MILLIS_PER_SECOND;
+  const ColumnarAggDataStore::WindowView ten_sec =
+      dh_->GetColumnarData(TEN_SEC)->Window(second - second % window_ms);
+  EnterTrade(sym_id, ten_sec.end[sym_id], ten_sec.close_ticks[sym_id]);
 }
 
 // Enter trade when the following holds:
@@ -83,10 +200,14 @@ void ChaseMomentumStrategy::MaybeEnterTrade(const std::string& ticker) {
 //    the volume of the most recent 5-minute candle -- this indicates a sudden
 //    increase of volume.
 bool ChaseMomentumStrategy::IsEntryPoint(const std::string& ticker) {
-  auto ten_sec = dh_->GetData(TEN_SEC, ticker);
-  auto one_min = dh_->GetData(ONE_MIN, ticker);
-  auto five_min = dh_->GetData(FIVE_MIN, ticker);
-  auto data = ten_sec.front();
+  return IsEntryPoint(SymbolTable::Get().Intern(ticker));
+}
+
+bool ChaseMomentumStrategy::IsEntryPoint(SymbolId sym_id) {
+  const CascadingAggregator::SymbolView history = dh_->GetSymbolView(sym_id);
+  const auto& ten_sec = history[TEN_SEC];
+  const auto& one_min = history[ONE_MIN];
+  const AggregateData& data = ten_sec.front();
   int64_t ts = data.end_;
   absl::CivilMinute civil_time =
       absl::ToCivilMinute(absl::FromUnixMillis(ts), nyc_);
@@ -95,91 +216,83 @@ bool ChaseMomentumStrategy::IsEntryPoint(const std::string& ticker) {
     return false;
   }
 
-  double open;
+  Price open;
   if (ten_sec.size() > 1 && ten_sec[1].end_ == data.start_) {
-    open = ten_sec[1].start_;
+    open = ten_sec[1].open_ticks_;
   } else {
-    open = data.open_;
+    open = data.open_ticks_;
   }
 
-  int64_t five_min_from_ts =
-      one_min.front().start_ - 300 * NUM_MILLIS_PER_SECOND;
-  int64_t tot_vol = 0;
-  for (int i = 0; i < one_min.size() && one_min[i].start_ >= five_min_from_ts;
-       ++i) {
-    tot_vol += one_min[i].vol_;
-  }
+  // The volume of the 1-minute windows starting within 5 minutes before the
+  // current one.
+  double tot_vol = dh_->GetIndicator(five_min_vol_, sym_id);
 
-  return (data.close_ > 1.2 * open) && (data.close_ > 2.) &&
-         (data.close_ < 50.) && (one_min.front().vol_ > 3000) &&
+  // close > 1.2 * open, exactly. Keep in sync with MomentumScanner.
+  return (5 * data.close_ticks_ > 6 * open) &&
+         (data.close_ticks_ > Dollars(2)) &&
+         (data.close_ticks_ < Dollars(50)) && (one_min.front().vol_ > 3000) &&
          (data.vol_ < 1.5 * tot_vol);
 }
 
-void ChaseMomentumStrategy::EnterTrade() {
-  double limit_price = dh_->GetData(TEN_SEC, trading_).front().close_ + 0.05;
+void ChaseMomentumStrategy::EnterTrade(SymbolId sym_id, int64_t end,
+                                       Price close) {
+  quantity_ = 0;
+  trading_ = sym_id;
+  enter_ts_ = end;
+  clear_ = false;
+  const std::string& ticker = SymbolTable::Get().Name(trading_);
+  Price limit_price = RoundDownToIncrement(close + Cents(5));
   // Always leave $25,000 cash in the account to comply with the PDT rule.
   // TODO: This resitriction can be lifted when the project is proven effective.
   // TODO: Limit number of shares / amount of capital used.
-  int qty = (std::stod(account_.cash) - 25000.) * 0.9 / limit_price;
+  int qty = (account_.cash_decimal.toDouble() - 25000.) * 0.9 /
+            PriceToDouble(limit_price);
   if (qty <= 0) {
-    LOG(INFO) << "Trying to buy " << trading_ << " at " << limit_price
+    LOG(INFO) << "Trying to buy " << ticker << " at "
+              << FormatPrice(limit_price)
               << ", but the account does not have enough cash for 1 share.";
+    trading_ = kInvalidSymbolId;
     return;
   }
 
-  LOG(INFO) << "Buying " << qty << " shares of " << trading_
-            << " at limit price " << limit_price << "to chase momentum.";
-
-  auto buy_response = client_->submitOrder(
-      trading_, qty, alpaca::OrderSide::Buy, alpaca::OrderType::Limit,
-      alpaca::OrderTimeInForce::Day, std::to_string(limit_price));
-  if (auto status = buy_response.first; !status.ok()) {
-    LOG(ERROR) << "Error submitting buy order: " << status.getMessage();
-    return;
-  }
-
-  auto order = buy_response.second;
-  int64_t filled = std::stoi(order.filled_qty);
-  LOG(INFO) << filled << " (" << order.filled_qty << ") shares of " << trading_
-            << " are filled immediately at" << order.filled_avg_price << ".";
-  if (filled < qty) {
-    // TODO: Error handling is too vulnerable.
-    auto cancel_response = client_->cancelOrder(order.id);
-    order = cancel_response.second;
-    filled = std::stoi(order.filled_qty);
-    LOG(INFO) << filled << " (" << order.filled_qty << ") shares of "
-              << trading_ << " are filled eventually at"
-              << order.filled_avg_price << ".";
-  }
-
-  quantity_ = filled;
-  breakeven_ = std::stod(order.filled_avg_price);
+  LOG(INFO) << "Buying " << qty << " shares of " << ticker
+            << " at limit price " << FormatPrice(limit_price)
+            << " to chase momentum.";
+  SubmitOrder(alpaca::OrderSide::Buy, qty, limit_price);
 }
 
 void ChaseMomentumStrategy::PositionManagement() {
-  if (clear_) ClearPosition();
+  if (clear_) {
+    ClearPosition();
+    return;
+  }
 
-  auto one_min = dh_->GetData(ONE_MIN, trading_);
-  auto one_sec = dh_->GetData(ONE_SEC, trading_);
+  const std::string& ticker = SymbolTable::Get().Name(trading_);
+  const CascadingAggregator::SymbolView history =
+      dh_->GetSymbolView(trading_);
+  const auto& one_min = history[ONE_MIN];
+  const auto& one_sec = history[ONE_SEC];
   if (one_min.front().start_ <= enter_ts_) {
-    if (one_sec.front().low_ < one_min.front().open_) {
-      LOG(INFO) << "Clearing " << trading_ << " position because price has "
+    if (one_sec.front().low_ticks_ < one_min.front().open_ticks_) {
+      LOG(INFO) << "Clearing " << ticker << " position because price has "
                 << "broken below open price of the candle: "
                 << one_min.front().open_ << ".";
       clear_ = true;
       ClearPosition();
       return;
     }
-  } else if (one_min[1].low_ <= enter_ts_) {
-    if (one_sec.front().low_ < breakeven_) {
-      LOG(INFO) << "Clearing " << trading_ << " position because price has "
-                << "broken below breakeven: " << breakeven_ << ".";
+  } else if (one_min.size() <= 1 || one_min[1].start_ <= enter_ts_) {
+    // The candle after the entry, or the entry candle is no longer known.
+    if (one_sec.front().low_ticks_ < breakeven_) {
+      LOG(INFO) << "Clearing " << ticker << " position because price has "
+                << "broken below breakeven: " << FormatPrice(breakeven_)
+                << ".";
       ClearPosition();
       return;
     }
   } else {
-    if (one_sec.front().low_ < one_min[1].low_) {
-      LOG(INFO) << "Clearing " << trading_ << " position because price has "
+    if (one_sec.front().low_ticks_ < one_min[1].low_ticks_) {
+      LOG(INFO) << "Clearing " << ticker << " position because price has "
                 << "broken below previous candle's low.";
       ClearPosition();
       return;
@@ -188,48 +301,95 @@ void ChaseMomentumStrategy::PositionManagement() {
 
   if (one_min.front().end_ - one_min.front().start_ ==
           60 * NUM_MILLIS_PER_SECOND &&
-      (one_min.front().close_ < one_min.front().open_)) {
-    LOG(INFO) << "Clearing " << trading_
+      (one_min.front().close_ticks_ < one_min.front().open_ticks_)) {
+    LOG(INFO) << "Clearing " << ticker
               << " position because the current candle closes red.";
     ClearPosition();
   }
 }
 
 void ChaseMomentumStrategy::ClearPosition() {
-  double limit_price = dh_->GetData(ONE_SEC, trading_).front().low_ - 0.05;
-  auto sell_response = client_->submitOrder(
-      trading_, quantity_, alpaca::OrderSide::Sell, alpaca::OrderType::Limit,
-      alpaca::OrderTimeInForce::Day, std::to_string(limit_price));
-  if (auto status = sell_response.first; !status.ok()) {
-    LOG(ERROR) << "Error submitting sell order: " << status.getMessage();
-  }
-
-  auto order = sell_response.second;
-  int64_t filled = std::stoi(order.filled_qty);
-  LOG(INFO) << filled << " (" << order.filled_qty << ") shares of " << trading_
-            << " are filled immediately at" << order.filled_avg_price << ".";
-  if (filled < quantity_) {
-    // TODO: Error handling is too vulnerable.
-    auto cancel_response = client_->cancelOrder(order.id);
-    order = cancel_response.second;
-    filled = std::stoi(order.filled_qty);
-    LOG(INFO) << filled << " (" << order.filled_qty << ") shares of "
-              << trading_ << " are filled eventually at"
-              << order.filled_avg_price << ".";
-  }
-
-  quantity_ -= filled;
+  Price limit_price = RoundUpToIncrement(
+      dh_->GetData(ONE_SEC, trading_).front().low_ticks_ - Cents(5));
+  SubmitOrder(alpaca::OrderSide::Sell, quantity_, limit_price);
+}
+
+void ChaseMomentumStrategy::SubmitOrder(alpaca::OrderSide side, int64_t qty,
+                                        Price limit_price) {
+  const std::string& ticker = SymbolTable::Get().Name(trading_);
+  // Known before the order reaches the broker, so that the events of the
+  // order can be told apart even if they arrive before the response.
+  order_id_ = absl::StrCat("pasta-", ticker, "-",
+                           absl::ToUnixMicros(absl::Now()));
+  pending_ = true;
+  orders_->SubmitOrderAsync(
+      TimeOrder(MonotonicNanos(),
+                [this](const auto& resp) { OnOrderSubmitted(resp); }),
+      ticker, qty, side, limit_price, order_id_);
+}
+
+void ChaseMomentumStrategy::OnOrderSubmitted(
+    const std::pair<alpaca::Status, alpaca::Order>& resp) {
+  if (auto status = resp.first; !status.ok()) {
+    absl::MutexLock lock(&mu_);
+    // A position is cleared again on the next data.
+    LOG(ERROR) << "Error submitting order " << order_id_ << ": "
+               << status.getMessage();
+    order_id_.clear();
+    pending_ = false;
+    if (quantity_ <= 0) trading_ = kInvalidSymbolId;
+    return;
+  }
+  // The response may already tell the fills, ahead of the stream.
+  OrderTable::Get().Update(resp.second);
+}
+
+void ChaseMomentumStrategy::OnOrderEvent(const OrderEvent& event) {
+  absl::MutexLock lock(&mu_);
+  const OrderState& order = event.order;
+  if (order_id_.empty() || order.client_order_id != order_id_) return;
+
+  const bool buy = order.side == "buy";
+  if (event.fill_qty > 0) {
+    LOG(INFO) << event.fill_qty << " more shares of " << order.symbol
+              << " are filled, " << order.filled_qty << " at "
+              << order.filled_avg_price << " in total.";
+    if (buy) {
+      // The buy order opens the position.
+      quantity_ = order.filled_qty;
+      breakeven_ = PriceFromDouble(order.filled_avg_price);
+    } else {
+      quantity_ -= event.fill_qty;
+    }
+  }
+  if (!order.done) return;
+
+  LOG(INFO) << "Order " << order_id_ << " is " << order.status << " with "
+            << order.filled_qty << " of " << order.qty << " shares filled.";
+  order_id_.clear();
   if (quantity_ <= 0) {
     clear_ = false;
-    trading_.clear();
+    trading_ = kInvalidSymbolId;
+  }
+  if (buy) {
+    pending_ = false;
+    return;
   }
 
-  auto account_response = client_->getAccount();
-  if (auto status = account_response.first; !status.ok()) {
+  // Stay pending until the cash available for the next trade is known.
+  orders_->GetAccountAsync([this](const auto& resp) {
+    absl::MutexLock lock(&mu_);
+    OnAccount(resp);
+  });
+}
+
+void ChaseMomentumStrategy::OnAccount(
+    const std::pair<alpaca::Status, alpaca::Account>& resp) {
+  if (auto status = resp.first; !status.ok()) {
     LOG(FATAL) << "Alpaca getting account information failure (code "
                << status.getCode() << "): " << status.getMessage();
   }
-  account_ = account_response.second;
+  account_ = resp.second;
 
   if (account_.trading_blocked) {
     LOG(FATAL) << "Account is currently resitricted from trading.";
@@ -237,6 +397,21 @@ void ChaseMomentumStrategy::ClearPosition() {
 
   LOG(INFO) << account_.cash << " is available as cash.";
   LOG(INFO) << account_.buying_power << " is available as buying power.";
+  pending_ = false;
+}
+
+alpaca::Client::Callback<alpaca::Order> ChaseMomentumStrategy::TimeOrder(
+    int64_t submit_ns,
+    std::function<void(const std::pair<alpaca::Status, alpaca::Order>&)>
+        callback) {
+  const int64_t receive_ns = CurrentMessageReceiveTime();
+  if (receive_ns > 0) {
+    LatencyTracker::Get().Record(TICK_TO_ORDER, submit_ns - receive_ns);
+  }
+  return [submit_ns, callback](const auto& resp) {
+    LatencyTracker::Get().Record(ORDER, MonotonicNanos() - submit_ns);
+    callback(resp);
+  };
 }
 
 // Returns true if time is in 9:00 am - 9:25 am, 9:45 am - 3:30 pm.
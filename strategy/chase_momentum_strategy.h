@@ -1,46 +1,115 @@
 #ifndef PASTA_STRATEGY_CHASE_MOMENTUM_STRATEGY_H_
 #define PASTA_STRATEGY_CHASE_MOMENTUM_STRATEGY_H_
 
+#include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "alpaca/alpaca.h"
 #include "data_handler/data_handler.h"
+#include "data_handler/indicator_registry.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+#include "strategy/alpaca_bar_source.h"
+#include "strategy/alpaca_order_client.h"
+#include "strategy/momentum_scanner.h"
+#include "strategy/order_client.h"
+#include "strategy/order_table.h"
 #include "strategy/strategy.h"
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace pasta {
 
 class ChaseMomentumStrategy : public Strategy {
  public:
-  ChaseMomentumStrategy(DataHandler* dh);
+  // Trades through `orders`, e.g. a SimulatedOrderClient in replays, which
+  // must outlive the strategy, or through the Alpaca API of the environment
+  // if null.
+  ChaseMomentumStrategy(DataHandler* dh, OrderClient* orders = nullptr);
+  ~ChaseMomentumStrategy();
   absl::Status Init() override;
 
-  // Public for testing only.
+  // Public for testing and replay only.
   bool IsEntryPoint(const std::string& ticker);
+  bool IsEntryPoint(SymbolId sym_id);
 
  private:
-  void ProcessNewData(const std::string& ticker);
+  void ProcessNewData(SymbolId sym_id);
 
-  void MaybeEnterTrade(const std::string& ticker);
+  // Enters the first candidate of the whole universe as of `second`. Used
+  // instead of the entry checks of ProcessNewData() with
+  // FLAGS_chase_momentum_scanner.
+  void ScanUniverse(int64_t second);
 
   void PositionManagement();
 
-  void EnterTrade();
+  // Enters `sym_id`, whose current 10s window ends at `end` with `close`.
+  void EnterTrade(SymbolId sym_id, int64_t end, Price close);
 
+  // Orders are submitted without blocking the data handler, as
+  // immediate-or-cancel limit orders whose fills and end are pushed by the
+  // order table. No trading decisions are made while `pending_` is set.
   void ClearPosition();
+  void SubmitOrder(alpaca::OrderSide side, int64_t qty, Price limit_price);
+  void OnOrderSubmitted(const std::pair<alpaca::Status, alpaca::Order>& resp);
+  void OnOrderEvent(const OrderEvent& event);
+  void OnAccount(const std::pair<alpaca::Status, alpaca::Account>& resp);
+
+  // Records the latency from receiving the current data message to
+  // submitting an order at `submit_ns`. Returns a callback for the order
+  // that records the order latency, then runs `callback`.
+  alpaca::Client::Callback<alpaca::Order> TimeOrder(
+      int64_t submit_ns,
+      std::function<void(const std::pair<alpaca::Status, alpaca::Order>&)>
+          callback);
 
   bool IsStrategyTradingHour(absl::CivilMinute civil_min);
 
   absl::TimeZone nyc_;
 
+  // The volume of the last six 1-minute windows.
+  IndicatorId five_min_vol_;
+
+  // Set with FLAGS_chase_momentum_scanner.
+  std::unique_ptr<MomentumScanner> scanner_;
+  // Scratch space for ScanUniverse().
+  std::vector<SymbolId> candidates_;
+
+  // Set by Init() when trading through the Alpaca API.
   std::unique_ptr<alpaca::Client> client_;
+  std::unique_ptr<AlpacaBarSource> bar_source_;
+  std::unique_ptr<AlpacaOrderClient> alpaca_orders_;
+  OrderClient* orders_;
+  // Whether Init() subscribed to the order table.
+  bool subscribed_;
   alpaca::Account account_;
 
-  std::string trading_;
+  // Serializes the trading decisions of ProcessNewData(), which the data
+  // handler shards may call concurrently. Guards the trading state below.
+  absl::Mutex mu_;
+
+  // The symbol currently traded, or kInvalidSymbolId. Only changed under
+  // `mu_`, but also read without it, so that the shards only take the lock
+  // to act on their symbol.
+  std::atomic<SymbolId> trading_;
+  // Whether an order or account call is in flight. Like `trading_`.
+  std::atomic<bool> pending_;
+  // The client order ID of the order in flight, or empty.
+  std::string order_id_;
   int64_t quantity_;
-  double breakeven_;
+  Price breakeven_;
   int64_t enter_ts_;
   bool clear_;
 };
 
 }  // namespace pasta
 
+extern absl::Flag<bool> FLAGS_chase_momentum_scanner;
+
 #endif  // PASTA_STRATEGY_CHASE_MOMENTUM_STRATEGY_H_
@@ -1,10 +1,21 @@
 #include "strategy/chase_momentum_strategy.h"
 
+#include "absl/flags/flag.h"
+#include "alpaca/decimal.h"
+#include "alpaca/order.h"
 #include "data_handler/data_handler_testutil.h"
+#include "data_handler/symbol_table.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "strategy/momentum_scanner.h"
+#include "strategy/simulated_order_client.h"
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace pasta {
 
@@ -47,6 +58,99 @@ TEST_F(ChaseMomentumStrategyTest, EntryPoint) {
   EXPECT_FALSE(s.IsEntryPoint("C"));
 }
 
+TEST(SimulatedTradingTest, EntersAndClearsThroughTheData) {
+  DataHandler dh = DataHandler(nullptr);
+  alpaca::Decimal cash;
+  ASSERT_TRUE(alpaca::Decimal::parse("50000", &cash));
+  SimulatedOrderClient orders(&dh, cash);
+  ChaseMomentumStrategy s = ChaseMomentumStrategy(&dh, &orders);
+  ASSERT_EQ(s.Init(), absl::OkStatus());
+
+  dh.ProcessMessage(GetMessage({MakeAggProto(
+      "A", "SIM", 200, 8642007, 25.66, 25.3981, 2.39, 2.45, 2.57, 2.35,
+      25.4014, 50, 1610114868000, 1610114869000)}));
+  // An entry point, bought at the close.
+  dh.ProcessMessage(GetMessage({MakeAggProto(
+      "A", "SIM", 7000, 8642007, 25.66, 25.3981, 2.48, 3.45, 3.50, 2.44,
+      25.4014, 50, 1610114871000, 1610114872000)}));
+  ASSERT_EQ(orders.orders().size(), 1);
+  // The price breaks below the open of the 1m candle of the entry.
+  dh.ProcessMessage(GetMessage({MakeAggProto(
+      "A", "SIM", 100, 8642007, 25.66, 25.3981, 3.45, 3.40, 3.46, 2.30,
+      25.4014, 50, 1610114872000, 1610114873000)}));
+
+  std::vector<alpaca::Order> placed = orders.orders();
+  ASSERT_EQ(placed.size(), 2);
+  EXPECT_EQ(placed[0].side, "buy");
+  EXPECT_EQ(placed[0].status, "filled");
+  EXPECT_EQ(placed[0].filled_qty, "6428");
+  EXPECT_EQ(placed[0].filled_avg_price, "3.45");
+  EXPECT_EQ(placed[1].side, "sell");
+  EXPECT_EQ(placed[1].status, "filled");
+  EXPECT_EQ(placed[1].filled_qty, "6428");
+  EXPECT_EQ(placed[1].filled_avg_price, "3.4");
+  EXPECT_EQ(orders.cash().toString(), "49678.6");
+}
+
+TEST(MomentumScannerTest, SameAsEntryPoint) {
+  absl::SetFlag(&FLAGS_columnar_agg_data_store, true);
+  DataHandler dh = DataHandler(nullptr);
+  absl::SetFlag(&FLAGS_columnar_agg_data_store, false);
+  ChaseMomentumStrategy s = ChaseMomentumStrategy(&dh);
+  MomentumScanner scanner(dh.GetColumnarData(TEN_SEC),
+                          dh.GetColumnarData(ONE_MIN));
+
+  const int kNumTickers = 30;
+  const int kNumSeconds = 600;
+  // 9:10 am in New York, within the strategy trading hours.
+  const int64_t kStart = 1610115000000;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  std::uniform_int_distribution<int> vol_dist(0, 2000);
+  std::vector<double> prices(kNumTickers, 10.);
+
+  // The tickers that traded within the current second.
+  std::vector<SymbolId> traded;
+  int num_ticks = 0;
+  int num_entries = 0;
+  ASSERT_TRUE(dh.RegisterTickCallback("scan", [&](int64_t second) {
+                  ++num_ticks;
+                  std::vector<SymbolId> candidates;
+                  scanner.Scan(second, &candidates);
+                  for (SymbolId sym_id : traded) {
+                    bool candidate =
+                        std::find(candidates.begin(), candidates.end(),
+                                  sym_id) != candidates.end();
+                    ASSERT_EQ(candidate, s.IsEntryPoint(sym_id))
+                        << SymbolTable::Get().Name(sym_id) << " " << second;
+                    num_entries += candidate;
+                  }
+                }).ok());
+
+  for (int t = 0; t < kNumSeconds; ++t) {
+    const int64_t start = kStart + t * 1000;
+    std::vector<std::string> aggs;
+    traded.clear();
+    for (int i = 0; i < kNumTickers; ++i) {
+      if (uniform(rng) < .4) continue;
+      const std::string ticker = "SCAN" + std::to_string(i);
+      traded.push_back(SymbolTable::Get().Intern(ticker));
+      double open = prices[i];
+      double move = uniform(rng) < .03 ? 1.3 : .97 + .08 * uniform(rng);
+      double close = std::round(open * move * 100) / 100;
+      if (close < 1. || close > 60.) close = 1.5 + 50 * uniform(rng);
+      prices[i] = close;
+      aggs.push_back(MakeAggProto(
+          "A", ticker, vol_dist(rng), 8642007, 10., 10., open, close,
+          std::max(open, close) + .01, std::min(open, close) - .01, 10., 50,
+          start, start + 1000));
+    }
+    if (!aggs.empty()) dh.ProcessMessage(GetMessage(aggs));
+  }
+  EXPECT_EQ(num_ticks, kNumSeconds);
+  EXPECT_GT(num_entries, 0);
+}
+
 }  // namespace
 
 }  // namespace pasta
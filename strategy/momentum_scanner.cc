@@ -0,0 +1,70 @@
+#include "strategy/momentum_scanner.h"
+
+#include "data_handler/agg_data.h"
+#include "data_handler/columnar_agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+#include "glog/logging.h"
+
+#include <algorithm>
+
+namespace pasta {
+
+namespace {
+
+constexpr int64_t kTenSecMs = 10 * NUM_MILLIS_PER_SECOND;
+constexpr int64_t kOneMinMs = 60 * NUM_MILLIS_PER_SECOND;
+
+}  // namespace
+
+MomentumScanner::MomentumScanner(const ColumnarAggDataStore* ten_sec,
+                                 const ColumnarAggDataStore* one_min)
+    : ten_sec_(ten_sec), one_min_(one_min) {
+  CHECK_EQ(ten_sec->window_size() * NUM_MILLIS_PER_SECOND, kTenSecMs);
+  CHECK_EQ(one_min->window_size() * NUM_MILLIS_PER_SECOND, kOneMinMs);
+}
+
+void MomentumScanner::Scan(int64_t second, std::vector<SymbolId>* sym_ids) {
+  const int64_t cur_start = second - second % kTenSecMs;
+  const int64_t prev_start = cur_start - kTenSecMs;
+  const int64_t min_start = second - second % kOneMinMs;
+  const ColumnarAggDataStore::WindowView cur = ten_sec_->Window(cur_start);
+  const ColumnarAggDataStore::WindowView prev = ten_sec_->Window(prev_start);
+  const ColumnarAggDataStore::WindowView minute = one_min_->Window(min_start);
+  const size_t n = std::min(cur.num_symbols, minute.num_symbols);
+  if (minutes_vol_.size() < n) {
+    minutes_vol_.resize(n);
+    hits_.resize(n);
+  }
+  int64_t* minutes_vol = minutes_vol_.data();
+  uint8_t* hits = hits_.data();
+
+  // The volume of the 1m windows starting within 5 minutes before the
+  // current one, like the VOLUME_SUM indicator of the strategy.
+  std::fill(minutes_vol, minutes_vol + n, 0);
+  for (int k = 0; k < kMinuteWindows; ++k) {
+    const int64_t start = min_start - k * kOneMinMs;
+    const ColumnarAggDataStore::WindowView window = one_min_->Window(start);
+    for (size_t i = 0; i < n; ++i) {
+      minutes_vol[i] += (window.start[i] == start) * window.vol[i];
+    }
+  }
+
+  // Keep in sync with ChaseMomentumStrategy::IsEntryPoint().
+  for (size_t i = 0; i < n; ++i) {
+    // The open of the previous window if it is adjacent to the current one.
+    const bool adjacent =
+        (prev.start[i] == prev_start) & (prev.end[i] == cur_start);
+    const Price open = adjacent ? prev.open_ticks[i] : cur.open_ticks[i];
+    const Price close = cur.close_ticks[i];
+    hits[i] = (cur.start[i] == cur_start) & (minute.start[i] == min_start) &
+              (5 * close > 6 * open) & (close > Dollars(2)) &
+              (close < Dollars(50)) & (minute.vol[i] > 3000) &
+              (2 * cur.vol[i] < 3 * minutes_vol[i]);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (hits[i]) sym_ids->push_back(i);
+  }
+}
+
+}  // namespace pasta
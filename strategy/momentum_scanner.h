@@ -0,0 +1,52 @@
+#ifndef PASTA_STRATEGY_MOMENTUM_SCANNER_H_
+#define PASTA_STRATEGY_MOMENTUM_SCANNER_H_
+
+#include "data_handler/columnar_agg_data.h"
+#include "data_handler/price.h"
+#include "data_handler/symbol_table.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace pasta {
+
+// Evaluates the entry conditions of ChaseMomentumStrategy::IsEntryPoint(),
+// except for the trading hours, for the whole symbol universe at once. The
+// conditions are computed branch-free over the columns of the 10s and 1m
+// columnar data stores, so that the compiler vectorizes them, and a scan of
+// the market costs a few passes over contiguous memory instead of one
+// callback per aggregate.
+//
+// A symbol is a candidate if it traded within the 10s window of the scanned
+// second and that window meets the conditions, i.e. if IsEntryPoint() held
+// after its last aggregate.
+class MomentumScanner {
+ public:
+  // `ten_sec` and `one_min` must outlive the scanner, and keep at least
+  // kMinuteWindows windows.
+  MomentumScanner(const ColumnarAggDataStore* ten_sec,
+                  const ColumnarAggDataStore* one_min);
+
+  MomentumScanner(const MomentumScanner&) = delete;
+  MomentumScanner& operator=(const MomentumScanner&) = delete;
+
+  // Appends the candidates as of the second starting at `second` (Unix
+  // millis) to `sym_ids`, in SymbolId order.
+  void Scan(int64_t second, std::vector<SymbolId>* sym_ids);
+
+  // The number of 1m windows whose volume the current 10s window is compared
+  // to.
+  static constexpr int kMinuteWindows = 6;
+
+ private:
+  const ColumnarAggDataStore* ten_sec_;
+  const ColumnarAggDataStore* one_min_;
+
+  // Scratch space, indexed by SymbolId.
+  std::vector<int64_t> minutes_vol_;
+  std::vector<uint8_t> hits_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_MOMENTUM_SCANNER_H_
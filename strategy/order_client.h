@@ -0,0 +1,39 @@
+#ifndef PASTA_STRATEGY_ORDER_CLIENT_H_
+#define PASTA_STRATEGY_ORDER_CLIENT_H_
+
+#include "alpaca/account.h"
+#include "alpaca/client.h"
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+#include "data_handler/price.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace pasta {
+
+// Where a strategy sends its orders and learns its account from, e.g. the
+// Alpaca API, or a simulation of it in replays. Responses come as from
+// alpaca::Client: the callbacks run later, never within the call, on a
+// thread that may hold no lock of the caller.
+class OrderClient {
+ public:
+  virtual ~OrderClient() = default;
+
+  // Blocks until the account is known.
+  virtual std::pair<alpaca::Status, alpaca::Account> GetAccount() = 0;
+
+  virtual void GetAccountAsync(
+      alpaca::Client::Callback<alpaca::Account> callback) = 0;
+
+  // Submits an immediate-or-cancel limit order of `qty` shares of `ticker`.
+  virtual void SubmitOrderAsync(
+      alpaca::Client::Callback<alpaca::Order> callback,
+      const std::string& ticker, int64_t qty, alpaca::OrderSide side,
+      Price limit_price, const std::string& client_order_id) = 0;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_ORDER_CLIENT_H_
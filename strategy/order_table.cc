@@ -0,0 +1,275 @@
+#include "strategy/order_table.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "alpaca/client.h"
+#include "alpaca/streaming.h"
+#include "alpaca/trade_update.h"
+#include "glog/logging.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+// Returns true and sets `type` if an order in `status` can no longer fill.
+bool IsTerminal(const std::string& status, OrderEventType* type) {
+  if (status == "filled") {
+    *type = ORDER_FILLED;
+  } else if (status == "canceled") {
+    *type = ORDER_CANCELED;
+  } else if (status == "expired" || status == "done_for_day") {
+    *type = ORDER_EXPIRED;
+  } else if (status == "rejected") {
+    *type = ORDER_REJECTED;
+  } else if (status == "replaced") {
+    *type = ORDER_REPLACED;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+OrderState ToOrderState(const alpaca::Order& order) {
+  OrderState state;
+  state.id = order.id;
+  state.client_order_id = order.client_order_id;
+  state.symbol = order.symbol;
+  state.side = order.side;
+  state.status = order.status;
+  state.qty = order.qty_decimal.toInt();
+  state.filled_qty = order.filled_qty_decimal.toInt();
+  // Zero until the first fill.
+  state.filled_avg_price = order.filled_avg_price_decimal.toDouble();
+  return state;
+}
+
+}  // namespace
+
+// static
+OrderTable& OrderTable::Get() {
+  static OrderTable* table = new OrderTable();
+  return *table;
+}
+
+OrderTable::OrderTable()
+    : loop_(nullptr), streaming_(false), listened_(false) {}
+
+absl::Status OrderTable::Subscribe(
+    const std::string& name, std::function<void(const OrderEvent&)> func) {
+  absl::MutexLock lock(&dispatch_mu_);
+  if (subscribers_.count(name) > 0) {
+    return absl::AlreadyExistsError("Subscriber <" + name +
+                                    "> is already subscribed.");
+  }
+  subscribers_[name] = std::move(func);
+  return absl::OkStatus();
+}
+
+absl::Status OrderTable::Unsubscribe(const std::string& name) {
+  absl::MutexLock lock(&dispatch_mu_);
+  auto iter = subscribers_.find(name);
+  if (iter == subscribers_.end()) {
+    return absl::NotFoundError("Subscriber <" + name +
+                               "> is not subscribed.");
+  }
+  subscribers_.erase(iter);
+  return absl::OkStatus();
+}
+
+void OrderTable::Update(const alpaca::Order& order) {
+  OrderState next = ToOrderState(order);
+  const std::string key =
+      next.client_order_id.empty() ? next.id : next.client_order_id;
+  if (key.empty()) {
+    LOG(ERROR) << "Ignoring an update of an order without ID.";
+    return;
+  }
+
+  // Held while the subscribers run, so that they see the events of an order
+  // in order even when the stream and a REST response race.
+  absl::MutexLock dispatch_lock(&dispatch_mu_);
+  OrderEvent event;
+  {
+    absl::MutexLock lock(&mu_);
+    auto [iter, inserted] = orders_.try_emplace(key);
+    OrderState& state = iter->second;
+    if (!inserted && (state.done || next.filled_qty < state.filled_qty)) {
+      // Stale, e.g. a REST response older than a stream update.
+      return;
+    }
+
+    event.fill_qty = next.filled_qty - state.filled_qty;
+    if (IsTerminal(next.status, &event.type)) {
+      next.done = true;
+    } else if (event.fill_qty > 0) {
+      event.type = ORDER_PARTIALLY_FILLED;
+    } else if (inserted) {
+      event.type = ORDER_ACCEPTED;
+    } else {
+      // Nothing the subscribers care about, e.g. pending_new to new.
+      state = std::move(next);
+      return;
+    }
+    state = next;
+    event.order = std::move(next);
+  }
+
+  DLOG(INFO) << "Order " << key << " of " << event.order.symbol << " is "
+             << event.order.status << " with " << event.order.filled_qty
+             << "/" << event.order.qty << " shares filled.";
+  for (const auto& [name, func] : subscribers_) {
+    func(event);
+  }
+}
+
+absl::Status OrderTable::OnTradeUpdate(const std::string& json) {
+  alpaca::TradeUpdate update;
+  if (auto status = update.fromJSON(json); !status.ok()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Trade update parsing failure (code ",
+        std::to_string(status.getCode()), "): ", status.getMessage()));
+  }
+  Update(update.order);
+  return absl::OkStatus();
+}
+
+bool OrderTable::GetOrder(const std::string& client_order_id,
+                          OrderState* state) const {
+  absl::MutexLock lock(&mu_);
+  auto iter = orders_.find(client_order_id);
+  if (iter == orders_.end()) return false;
+  *state = iter->second;
+  return true;
+}
+
+void OrderTable::Reconcile(const OrderFetcher& fetch) {
+  std::vector<std::string> open;
+  {
+    absl::MutexLock lock(&mu_);
+    for (const auto& [key, state] : orders_) {
+      if (!state.done) open.push_back(key);
+    }
+  }
+  if (open.empty()) return;
+  LOG(INFO) << "Reconciling " << open.size() << " orders.";
+  for (const std::string& client_order_id : open) {
+    fetch(client_order_id,
+          [this, client_order_id](
+              const std::pair<alpaca::Status, alpaca::Order>& resp) {
+            if (auto status = resp.first; !status.ok()) {
+              LOG(ERROR) << "Error reconciling order " << client_order_id
+                         << ": " << status.getMessage();
+              return;
+            }
+            Update(resp.second);
+          });
+  }
+}
+
+void OrderTable::StartStreaming(const alpaca::Environment& env,
+                                EventLoop* loop) {
+  alpaca::stream::MessageGenerator generator;
+  std::string url = "wss://" + env.getAPIBaseURL() + "/stream";
+  std::string authentication =
+      generator.authentication(env.getAPIKeyID(), env.getAPISecretKey());
+  std::string listen = generator.listen({alpaca::stream::TradeUpdates});
+  EventLoop* expected = nullptr;
+  if (!loop_.compare_exchange_strong(expected, loop)) {
+    CHECK_EQ(expected, loop) << "The trade update stream runs on one loop.";
+  }
+  loop->Post([this, loop, env = alpaca::Environment(env), url, authentication,
+              listen]() mutable {
+    if (streaming_) return;
+    streaming_ = true;
+    if (client_ == nullptr) client_ = std::make_unique<alpaca::Client>(env);
+    if (stream_ == nullptr) {
+      stream_ = std::make_unique<WebSocketConnection>(loop, "Trade updates");
+      stream_->SetOpenHandler([this]() { OnStreamOpen(); });
+      stream_->SetMessageHandler(
+          [this](std::string* payload) { OnStreamMessage(payload); });
+      stream_->SetCloseHandler(
+          [this](const absl::Status& status) { OnStreamClose(status); });
+    }
+    stream_url_ = url;
+    authentication_ = authentication;
+    listen_ = listen;
+    ConnectStream();
+  });
+}
+
+void OrderTable::StopStreaming() {
+  EventLoop* loop = loop_;
+  if (loop == nullptr) return;
+  loop->Post([this]() {
+    streaming_ = false;
+    stream_->Close();
+  });
+}
+
+void OrderTable::ConnectStream() {
+  if (!streaming_ || stream_->IsConnected()) return;
+  absl::Status s = stream_->Connect(stream_url_);
+  if (!s.ok()) {
+    LOG(ERROR) << "Trade update stream failure: " << s;
+    loop_.load()->RunAfter(kReconnectDelay, [this]() { ConnectStream(); });
+  }
+}
+
+void OrderTable::OnStreamOpen() {
+  absl::Status s = stream_->Send(authentication_);
+  if (!s.ok()) LOG(ERROR) << s;
+}
+
+void OrderTable::OnStreamMessage(std::string* payload) {
+  auto reply = alpaca::stream::parseReply(*payload);
+  if (auto status = reply.first; !status.ok()) {
+    LOG(ERROR) << "Trade update stream reply parsing failure (code "
+               << status.getCode() << "): " << status.getMessage();
+    return;
+  }
+  switch (reply.second.reply_type) {
+    case alpaca::stream::Authorization: {
+      absl::Status s = stream_->Send(listen_);
+      if (!s.ok()) LOG(ERROR) << s;
+      break;
+    }
+    case alpaca::stream::Listening:
+      LOG(INFO) << "Listening to trade updates.";
+      if (listened_) {
+        // Catches up with the updates sent while disconnected, off the loop.
+        const alpaca::Client* client = client_.get();
+        Reconcile([client](const std::string& client_order_id,
+                           alpaca::Client::Callback<alpaca::Order> callback) {
+          client->getOrderByClientOrderIDAsync(client_order_id, callback);
+        });
+      }
+      listened_ = true;
+      break;
+    case alpaca::stream::Update:
+      if (reply.second.stream_type == alpaca::stream::TradeUpdates) {
+        absl::Status s = OnTradeUpdate(reply.second.data);
+        if (!s.ok()) LOG(ERROR) << s;
+      }
+      break;
+    default:
+      LOG(WARNING) << "Unknown trade update stream reply: " << *payload;
+  }
+}
+
+void OrderTable::OnStreamClose(const absl::Status& status) {
+  if (!streaming_) return;
+  // Updates sent while disconnected are lost. The orders are reconciled
+  // once listening again.
+  LOG(WARNING) << "Trade update stream closed: " << status
+               << ". Reconnecting.";
+  loop_.load()->RunAfter(kReconnectDelay, [this]() { ConnectStream(); });
+}
+
+}  // namespace pasta
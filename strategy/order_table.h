@@ -0,0 +1,141 @@
+#ifndef PASTA_STRATEGY_ORDER_TABLE_H_
+#define PASTA_STRATEGY_ORDER_TABLE_H_
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "alpaca/client.h"
+#include "alpaca/config.h"
+#include "alpaca/order.h"
+#include "data_handler/event_loop.h"
+#include "data_handler/websocket_connection.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace pasta {
+
+enum OrderEventType {
+  ORDER_ACCEPTED = 0,
+  ORDER_PARTIALLY_FILLED = 1,
+  ORDER_FILLED = 2,
+  ORDER_CANCELED = 3,
+  ORDER_EXPIRED = 4,
+  ORDER_REJECTED = 5,
+  ORDER_REPLACED = 6,
+  NUM_ORDER_EVENT_TYPE = 7,
+};
+
+// The last known state of an order.
+struct OrderState {
+  std::string id;
+  std::string client_order_id;
+  std::string symbol;
+  std::string side;
+  std::string status;
+  int64_t qty = 0;
+  int64_t filled_qty = 0;
+  double filled_avg_price = 0;
+  // Whether the order can no longer fill.
+  bool done = false;
+};
+
+struct OrderEvent {
+  OrderEventType type;
+  // The shares filled since the previous event of the order.
+  int64_t fill_qty;
+  // The order after the event.
+  OrderState order;
+};
+
+// The orders of the account, kept up to date from the Alpaca trade_updates
+// stream and from REST responses, whichever arrives first. Subscribers are
+// told about acceptance, fills and the end of every order, so they never
+// have to poll or cancel an order to learn its fills.
+//
+// Orders are keyed by client order ID, which the submitter knows before the
+// order reaches the broker, so events that arrive before the response to
+// the submission are not lost. An update that does not move an order forward
+// (e.g. a REST response older than a stream update) is ignored. Thread safe.
+// Subscribers run on the thread that applies the update, one event at a time,
+// and must not call Update() or (un)subscribe.
+class OrderTable {
+ public:
+  static OrderTable& Get();
+
+  OrderTable();
+
+  OrderTable(const OrderTable&) = delete;
+  OrderTable& operator=(const OrderTable&) = delete;
+
+  absl::Status Subscribe(const std::string& name,
+                         std::function<void(const OrderEvent&)> func);
+  absl::Status Unsubscribe(const std::string& name);
+
+  // Applies the state of an order, e.g. from a REST response.
+  void Update(const alpaca::Order& order);
+
+  // Applies the data of a trade_updates stream message.
+  absl::Status OnTradeUpdate(const std::string& json);
+
+  // Returns false if the order is unknown.
+  bool GetOrder(const std::string& client_order_id, OrderState* state) const;
+
+  // Fetches the state of the order with `client_order_id` and passes it to
+  // `callback`, e.g. with alpaca::Client::getOrderByClientOrderIDAsync().
+  typedef std::function<void(const std::string& client_order_id,
+                             alpaca::Client::Callback<alpaca::Order> callback)>
+      OrderFetcher;
+
+  // Fetches every order that is not done with `fetch` and applies it, to
+  // catch up with trade updates that were missed. Thread safe.
+  void Reconcile(const OrderFetcher& fetch);
+
+  // Listens to the trade_updates stream on `loop`, next to the market data,
+  // until StopStreaming() is called, reconnecting when the connection closes.
+  // The orders are reconciled through the REST API after every reconnect.
+  // Does nothing if already streaming. Thread safe.
+  void StartStreaming(const alpaca::Environment& env, EventLoop* loop);
+  void StopStreaming();
+
+ private:
+  // The time to wait before reconnecting to the stream.
+  static constexpr absl::Duration kReconnectDelay = absl::Seconds(1);
+
+  // Serializes updates with the subscribers they notify.
+  absl::Mutex dispatch_mu_ ABSL_ACQUIRED_BEFORE(mu_);
+  absl::flat_hash_map<std::string, std::function<void(const OrderEvent&)>>
+      subscribers_ ABSL_GUARDED_BY(dispatch_mu_);
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, OrderState> orders_ ABSL_GUARDED_BY(mu_);
+
+  // Runs on the loop thread.
+  void ConnectStream();
+  void OnStreamOpen();
+  void OnStreamMessage(std::string* payload);
+  void OnStreamClose(const absl::Status& status);
+
+  // The loop of the trade_updates stream, once StartStreaming() is called.
+  std::atomic<EventLoop*> loop_;
+  // The stream. Only used on the loop thread.
+  std::unique_ptr<WebSocketConnection> stream_;
+  std::string stream_url_;
+  std::string authentication_;
+  std::string listen_;
+  bool streaming_;
+  // Whether the stream was listening before, so that the next listening
+  // follows a reconnect.
+  bool listened_;
+  // Reconciles the orders after a reconnect. Only used on the loop thread.
+  std::unique_ptr<alpaca::Client> client_;
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_ORDER_TABLE_H_
@@ -0,0 +1,139 @@
+#include "strategy/order_table.h"
+
+#include "absl/status/status.h"
+#include "alpaca/client.h"
+#include "alpaca/decimal.h"
+#include "alpaca/order.h"
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace pasta {
+
+namespace {
+
+alpaca::Order MakeOrder(const std::string& status,
+                        const std::string& filled_qty,
+                        const std::string& filled_avg_price = "") {
+  alpaca::Order order;
+  order.id = "904837e3-3b76-47ec-b432-046db621571b";
+  order.client_order_id = "pasta-1";
+  order.symbol = "SPCE";
+  order.side = "buy";
+  order.qty = "100";
+  order.status = status;
+  order.filled_qty = filled_qty;
+  order.filled_avg_price = filled_avg_price;
+  alpaca::Decimal::parse(order.qty, &order.qty_decimal);
+  alpaca::Decimal::parse(order.filled_qty, &order.filled_qty_decimal);
+  alpaca::Decimal::parse(order.filled_avg_price,
+                         &order.filled_avg_price_decimal);
+  return order;
+}
+
+class OrderTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(table_
+                    .Subscribe("test", [this](const OrderEvent& event) {
+                      events_.push_back(event);
+                    })
+                    .ok());
+  }
+
+  OrderTable table_;
+  std::vector<OrderEvent> events_;
+};
+
+TEST_F(OrderTableTest, FillsArePushed) {
+  table_.Update(MakeOrder("new", "0"));
+  table_.Update(MakeOrder("partially_filled", "30", "10.5"));
+  table_.Update(MakeOrder("filled", "100", "10.6"));
+
+  ASSERT_EQ(events_.size(), 3);
+  EXPECT_EQ(events_[0].type, ORDER_ACCEPTED);
+  EXPECT_EQ(events_[0].fill_qty, 0);
+  EXPECT_EQ(events_[1].type, ORDER_PARTIALLY_FILLED);
+  EXPECT_EQ(events_[1].fill_qty, 30);
+  EXPECT_DOUBLE_EQ(events_[1].order.filled_avg_price, 10.5);
+  EXPECT_EQ(events_[2].type, ORDER_FILLED);
+  EXPECT_EQ(events_[2].fill_qty, 70);
+  EXPECT_EQ(events_[2].order.filled_qty, 100);
+  EXPECT_TRUE(events_[2].order.done);
+}
+
+TEST_F(OrderTableTest, StaleUpdatesAreIgnored) {
+  // The stream reports a fill before the REST response to the submission.
+  table_.Update(MakeOrder("partially_filled", "30", "10.5"));
+  table_.Update(MakeOrder("new", "0"));
+  table_.Update(MakeOrder("canceled", "30", "10.5"));
+  // Nothing happens to an order after it is done.
+  table_.Update(MakeOrder("canceled", "30", "10.5"));
+
+  ASSERT_EQ(events_.size(), 2);
+  EXPECT_EQ(events_[0].type, ORDER_PARTIALLY_FILLED);
+  EXPECT_EQ(events_[0].fill_qty, 30);
+  EXPECT_EQ(events_[1].type, ORDER_CANCELED);
+  EXPECT_EQ(events_[1].fill_qty, 0);
+}
+
+TEST_F(OrderTableTest, TerminalEventCarriesLastFill) {
+  // An immediate-or-cancel order whose rest is canceled in the same update.
+  table_.Update(MakeOrder("canceled", "40", "10.5"));
+
+  ASSERT_EQ(events_.size(), 1);
+  EXPECT_EQ(events_[0].type, ORDER_CANCELED);
+  EXPECT_EQ(events_[0].fill_qty, 40);
+
+  OrderState state;
+  ASSERT_TRUE(table_.GetOrder("pasta-1", &state));
+  EXPECT_EQ(state.status, "canceled");
+  EXPECT_EQ(state.filled_qty, 40);
+  EXPECT_EQ(state.qty, 100);
+  EXPECT_FALSE(table_.GetOrder("pasta-2", &state));
+}
+
+TEST_F(OrderTableTest, ReconcilesUpdatesMissedAcrossReconnect) {
+  table_.Update(MakeOrder("new", "0"));
+  table_.Update(MakeOrder("partially_filled", "30", "10.5"));
+  // The stream drops the fill of the rest while reconnecting, and the REST
+  // API tells it.
+  std::vector<std::string> fetched;
+  auto fetch = [&fetched](const std::string& client_order_id,
+                          alpaca::Client::Callback<alpaca::Order> callback) {
+    fetched.push_back(client_order_id);
+    callback({alpaca::Status(), MakeOrder("filled", "100", "10.6")});
+  };
+  table_.Reconcile(fetch);
+
+  EXPECT_EQ(fetched, std::vector<std::string>({"pasta-1"}));
+  ASSERT_EQ(events_.size(), 3);
+  EXPECT_EQ(events_[2].type, ORDER_FILLED);
+  EXPECT_EQ(events_[2].fill_qty, 70);
+  EXPECT_TRUE(events_[2].order.done);
+
+  // Orders that are done are not fetched again.
+  table_.Reconcile(fetch);
+  EXPECT_EQ(fetched.size(), 1);
+}
+
+TEST_F(OrderTableTest, Subscribers) {
+  EXPECT_EQ(table_.Subscribe("test", [](const OrderEvent&) {}).code(),
+            absl::StatusCode::kAlreadyExists);
+  EXPECT_TRUE(table_.Unsubscribe("test").ok());
+  EXPECT_EQ(table_.Unsubscribe("test").code(), absl::StatusCode::kNotFound);
+
+  table_.Update(MakeOrder("new", "0"));
+  EXPECT_TRUE(events_.empty());
+}
+
+}  // namespace
+
+}  // namespace pasta
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include "strategy/simulated_order_client.h"
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "alpaca/account.h"
+#include "alpaca/client.h"
+#include "alpaca/decimal.h"
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+#include "data_handler/agg_data.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/price.h"
+#include "glog/logging.h"
+
+#include <utility>
+
+namespace pasta {
+
+namespace {
+
+constexpr char kTickCallback[] = "SimulatedOrderClient deliver";
+
+constexpr int64_t kUnitsPerTick = alpaca::Decimal::kScale / kTicksPerDollar;
+
+// The amount of `qty` shares at `price`.
+alpaca::Decimal ToDecimal(int64_t qty, Price price) {
+  return alpaca::Decimal::fromUnits(qty * price * kUnitsPerTick);
+}
+
+}  // namespace
+
+SimulatedOrderClient::SimulatedOrderClient(DataHandler* dh,
+                                           alpaca::Decimal cash)
+    : dh_(dh), cash_(cash) {
+  absl::Status s = dh_->RegisterTickCallback(
+      kTickCallback, [this](int64_t) { Deliver(); });
+  CHECK(s.ok()) << s;
+}
+
+SimulatedOrderClient::~SimulatedOrderClient() {
+  dh_->UnregisterTickCallback(kTickCallback).IgnoreError();
+}
+
+std::pair<alpaca::Status, alpaca::Account> SimulatedOrderClient::GetAccount() {
+  absl::MutexLock lock(&mu_);
+  return {alpaca::Status(), MakeAccount()};
+}
+
+void SimulatedOrderClient::GetAccountAsync(
+    alpaca::Client::Callback<alpaca::Account> callback) {
+  absl::MutexLock lock(&mu_);
+  responses_.push_back([this, callback]() { callback(GetAccount()); });
+}
+
+void SimulatedOrderClient::SubmitOrderAsync(
+    alpaca::Client::Callback<alpaca::Order> callback,
+    const std::string& ticker, int64_t qty, alpaca::OrderSide side,
+    Price limit_price, const std::string& client_order_id) {
+  // The data of the symbol, which the strategy trading it may read.
+  const AggDataStore::AggDataQueue& data = dh_->GetData(ONE_SEC, ticker);
+  const bool buy = side == alpaca::OrderSide::Buy;
+  bool fill = false;
+  Price price = 0;
+  if (!data.empty()) {
+    price = data.front().close_ticks_;
+    fill = buy ? price <= limit_price : price >= limit_price;
+  }
+
+  alpaca::Order order;
+  order.client_order_id = client_order_id;
+  order.symbol = ticker;
+  order.side = alpaca::orderSideToString(side);
+  order.status = fill ? "filled" : "canceled";
+  order.qty_decimal = ToDecimal(qty, kTicksPerDollar);
+  order.limit_price_decimal = ToDecimal(1, limit_price);
+  if (fill) {
+    order.filled_qty_decimal = order.qty_decimal;
+    order.filled_avg_price_decimal = ToDecimal(1, price);
+  }
+  order.qty = order.qty_decimal.toString();
+  order.limit_price = order.limit_price_decimal.toString();
+  order.filled_qty = order.filled_qty_decimal.toString();
+  if (fill) order.filled_avg_price = order.filled_avg_price_decimal.toString();
+
+  absl::MutexLock lock(&mu_);
+  order.id = absl::StrCat("simulated-", orders_.size());
+  if (fill) {
+    const alpaca::Decimal amount = ToDecimal(qty, price);
+    cash_ = buy ? cash_ - amount : cash_ + amount;
+  }
+  orders_.push_back(order);
+  responses_.push_back([callback, order]() {
+    callback({alpaca::Status(), order});
+  });
+}
+
+void SimulatedOrderClient::Deliver() {
+  while (true) {
+    std::vector<std::function<void()>> responses;
+    {
+      absl::MutexLock lock(&mu_);
+      responses.swap(responses_);
+    }
+    if (responses.empty()) return;
+    for (const auto& response : responses) {
+      response();
+    }
+  }
+}
+
+std::vector<alpaca::Order> SimulatedOrderClient::orders() const {
+  absl::MutexLock lock(&mu_);
+  return orders_;
+}
+
+alpaca::Decimal SimulatedOrderClient::cash() const {
+  absl::MutexLock lock(&mu_);
+  return cash_;
+}
+
+alpaca::Account SimulatedOrderClient::MakeAccount() const {
+  alpaca::Account account;
+  account.cash_decimal = cash_;
+  account.buying_power_decimal = cash_;
+  account.cash = cash_.toString();
+  account.buying_power = account.cash;
+  account.trading_blocked = false;
+  account.shorting_enabled = false;
+  return account;
+}
+
+}  // namespace pasta
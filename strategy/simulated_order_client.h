@@ -0,0 +1,73 @@
+#ifndef PASTA_STRATEGY_SIMULATED_ORDER_CLIENT_H_
+#define PASTA_STRATEGY_SIMULATED_ORDER_CLIENT_H_
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "alpaca/account.h"
+#include "alpaca/client.h"
+#include "alpaca/decimal.h"
+#include "alpaca/order.h"
+#include "alpaca/status.h"
+#include "data_handler/data_handler.h"
+#include "data_handler/price.h"
+#include "strategy/order_client.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pasta {
+
+// Fills orders against the data of a DataHandler instead of a broker, e.g.
+// in replays of recorded data. An order fills whole at the close of the
+// newest 1s window of its symbol when it is submitted, if that close is
+// within its limit price, and is canceled otherwise, as an
+// immediate-or-cancel order in a market of unlimited depth would. The cash of
+// the account follows the fills.
+//
+// Responses are delivered on the thread calling ProcessMessage(), by a tick
+// callback of the handler, i.e. once per second of data, or by Deliver().
+class SimulatedOrderClient : public OrderClient {
+ public:
+  // `dh` must outlive the client.
+  SimulatedOrderClient(DataHandler* dh, alpaca::Decimal cash);
+  ~SimulatedOrderClient();
+
+  SimulatedOrderClient(const SimulatedOrderClient&) = delete;
+  SimulatedOrderClient& operator=(const SimulatedOrderClient&) = delete;
+
+  std::pair<alpaca::Status, alpaca::Account> GetAccount() override;
+
+  void GetAccountAsync(
+      alpaca::Client::Callback<alpaca::Account> callback) override;
+
+  void SubmitOrderAsync(alpaca::Client::Callback<alpaca::Order> callback,
+                        const std::string& ticker, int64_t qty,
+                        alpaca::OrderSide side, Price limit_price,
+                        const std::string& client_order_id) override;
+
+  // Delivers the pending responses, and those of the calls their callbacks
+  // make, until none is left.
+  void Deliver();
+
+  // The orders submitted so far, filled or canceled.
+  std::vector<alpaca::Order> orders() const;
+
+  alpaca::Decimal cash() const;
+
+ private:
+  alpaca::Account MakeAccount() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  DataHandler* dh_;
+
+  mutable absl::Mutex mu_;
+  alpaca::Decimal cash_ ABSL_GUARDED_BY(mu_);
+  std::vector<alpaca::Order> orders_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::function<void()>> responses_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace pasta
+
+#endif  // PASTA_STRATEGY_SIMULATED_ORDER_CLIENT_H_